@@ -0,0 +1,84 @@
+#pragma once
+
+#include <time.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+namespace logiq::bench {
+
+using Clock = std::chrono::steady_clock;
+
+// Size argument argv[i] in MiB, or def if absent.
+inline std::size_t arg_mib(int argc, char **argv, int i, std::size_t def) {
+  if (argc <= i)
+    return def * 1024 * 1024;
+  return static_cast<std::size_t>(std::strtoull(argv[i], nullptr, 10)) *
+         1024 * 1024;
+}
+
+// About bytes of newline-terminated log lines, the same for every run:
+// line_bytes long each ('\n' included), or of varying length (40 to 300
+// bytes) if 0.
+inline std::string make_log_lines(std::size_t bytes,
+                                  std::size_t line_bytes = 0) {
+  static constexpr char kWords[] =
+      "GET /api/v1/orders status=200 user=alice latency_ms=17 "
+      "trace=5f2c9a1b level=info msg=\"request served\" region=eu-west-1 ";
+  std::string out;
+  out.reserve(bytes + 512);
+  std::uint64_t x = 0x9e3779b97f4a7c15ULL;
+  while (out.size() < bytes) {
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    std::size_t len = line_bytes > 0 ? line_bytes - 1 : 40 + x % 261;
+    while (len > 0) {
+      const std::size_t n = std::min(len, sizeof(kWords) - 1);
+      out.append(kWords, n);
+      len -= n;
+    }
+    out.push_back('\n');
+  }
+  return out;
+}
+
+// Best wall time in seconds of reps calls to fn.
+template <typename Fn> double best_of(int reps, Fn &&fn) {
+  double best = 1e30;
+  for (int i = 0; i < reps; ++i) {
+    const auto t0 = Clock::now();
+    fn();
+    const std::chrono::duration<double> dt = Clock::now() - t0;
+    best = std::min(best, dt.count());
+  }
+  return best;
+}
+
+// Least CPU time in seconds the calling thread spent in one of reps calls
+// to fn.
+template <typename Fn> double best_cpu_of(int reps, Fn &&fn) {
+  auto now = [] {
+    timespec ts{};
+    ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<double>(ts.tv_sec) +
+           static_cast<double>(ts.tv_nsec) / 1e9;
+  };
+  double best = 1e30;
+  for (int i = 0; i < reps; ++i) {
+    const double t0 = now();
+    fn();
+    best = std::min(best, now() - t0);
+  }
+  return best;
+}
+
+inline double gb_per_s(std::size_t bytes, double seconds) {
+  return static_cast<double>(bytes) / seconds / 1e9;
+}
+
+} // namespace logiq::bench
@@ -0,0 +1,125 @@
+// CPU cost and ratio of request body compression per codec and level.
+//
+//   compression_bench [data MiB (64)] [body KiB (4096)]
+//
+// The data is NDJSON log records with varying fields, cut into bodies of
+// the given size (batch.max_bytes) and compressed as HttpNdjsonSink does:
+// with the thread's CompressedWriter, fed 64 KiB at a time. "ms/MiB" is
+// the thread's CPU time per MiB of input, so it is what a sender thread
+// pays; codecs not built in are shown as n/a.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+
+#include "BenchUtil.hpp"
+#include "sinks/Compression.hpp"
+
+using namespace logiq;
+using sinks::Compression;
+
+namespace {
+
+// About bytes of NDJSON records whose ids, latencies and paths vary, so
+// the codecs cannot just repeat one line.
+std::string make_ndjson(std::size_t bytes) {
+  static constexpr const char *kLevels[] = {"info", "info", "warn", "error"};
+  static constexpr const char *kPaths[] = {"/api/v1/orders", "/api/v1/users",
+                                           "/healthz", "/api/v2/search"};
+  std::string out;
+  out.reserve(bytes + 512);
+  std::uint64_t x = 0x9e3779b97f4a7c15ULL;
+  char line[512];
+  for (std::uint64_t seq = 0; out.size() < bytes; ++seq) {
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    const int n = std::snprintf(
+        line, sizeof(line),
+        "{\"ts\":%llu,\"level\":\"%s\",\"msg\":\"GET %s/%u status=%u\","
+        "\"latency_ms\":%u,\"trace\":\"%016llx\",\"host\":\"node-%u\"}\n",
+        static_cast<unsigned long long>(1700000000000ULL + seq * 3 + x % 3),
+        kLevels[x % 4], kPaths[(x >> 8) % 4],
+        static_cast<unsigned>((x >> 16) % 100000),
+        (x >> 40) % 50 == 0 ? 500u : 200u,
+        static_cast<unsigned>((x >> 24) % 900),
+        static_cast<unsigned long long>(x),
+        static_cast<unsigned>((x >> 48) % 16));
+    out.append(line, static_cast<std::size_t>(n));
+  }
+  return out;
+}
+
+constexpr std::size_t kChunkBytes = 64 * 1024;
+
+// Compress data body by body; returns the compressed bytes.
+std::size_t compress_all(Compression c, int level, std::string_view data,
+                         std::size_t body_bytes, std::string &out) {
+  std::size_t total = 0;
+  for (std::size_t at = 0; at < data.size(); at += body_bytes) {
+    const auto body = data.substr(at, body_bytes);
+    out.clear();
+    sinks::CompressedWriter w(c, level, out);
+    for (std::size_t i = 0; i < body.size(); i += kChunkBytes)
+      w.write(body.substr(i, kChunkBytes));
+    w.finish();
+    total += out.size();
+  }
+  return total;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const std::size_t bytes = bench::arg_mib(argc, argv, 1, 64);
+  std::size_t body = 4096 * 1024;
+  if (argc > 2)
+    body = std::strtoull(argv[2], nullptr, 10) * 1024;
+  if (body == 0)
+    body = 1;
+
+  const std::string data = make_ndjson(bytes);
+  const double mib = static_cast<double>(data.size()) / (1024.0 * 1024.0);
+  std::printf("data %.0f MiB, body %zu KiB\n", mib, body / 1024);
+  std::printf("%6s %6s %10s %10s %8s\n", "codec", "level", "ms/MiB",
+              "MiB/s", "ratio");
+
+  struct Case {
+    Compression codec;
+    int level;
+  };
+  const Case cases[] = {
+      {Compression::None, 0},  {Compression::Gzip, 1},
+      {Compression::Gzip, 6},  {Compression::Gzip, 9},
+      {Compression::Zstd, -5}, {Compression::Zstd, -1},
+      {Compression::Zstd, 1},  {Compression::Zstd, 3},
+      {Compression::Zstd, 9},  {Compression::Zstd, 19},
+  };
+
+  std::string out;
+  out.reserve(body + body / 8);
+  for (const auto &[codec, level] : cases) {
+    const auto name = codec == Compression::None
+                          ? std::string_view("none")
+                          : sinks::content_encoding(codec);
+    if (!sinks::compression_available(codec)) {
+      std::printf("%6.*s %6d %10s\n", static_cast<int>(name.size()),
+                  name.data(), level, "n/a");
+      continue;
+    }
+    std::size_t compressed = 0;
+    // The slowest levels run once; the rest take the best of three.
+    const int reps = level >= 9 ? 1 : 3;
+    const double cpu = bench::best_cpu_of(reps, [&] {
+      compressed = compress_all(codec, level, data, body, out);
+    });
+    std::printf("%6.*s %6d %10.2f %10.1f %8.2f\n",
+                static_cast<int>(name.size()), name.data(), level,
+                cpu * 1000.0 / mib, mib / cpu,
+                static_cast<double>(data.size()) /
+                    static_cast<double>(compressed));
+  }
+  return 0;
+}
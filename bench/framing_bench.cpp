@@ -0,0 +1,190 @@
+// Newline scanning and LineFramer throughput per NewlineScanner
+// implementation (avx2, sse2, scalar memchr), next to the loop the framer
+// used before NewlineScanner.
+//
+//   framing_bench [data MiB (256)] [chunk KiB (256)] [line bytes]
+//
+// Lines are 100 and then 4096 bytes long, or only the given length (0 for
+// a 40 to 300 byte mix). "scan" is NewlineScanner::scan over the whole
+// buffer; "framer" feeds LineFramer chunk-sized pieces, as a FileFollower
+// read would, and drains the records after each. The "find" row is the
+// old framer: string_view::find('\n') per line, then substr and push_back
+// of each record.
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "BenchUtil.hpp"
+#include "framing/LineFramer.hpp"
+#include "framing/NewlineScanner.hpp"
+
+using namespace logiq;
+
+namespace {
+
+// The framing loop before NewlineScanner: lines are found one find() at a
+// time, and an unterminated tail is carried into the next chunk.
+class FindFramer {
+public:
+  const std::vector<framing::FramedRecord> &frame(std::string_view data,
+                                                  std::uint64_t offset) {
+    out_.clear();
+    std::size_t pos = 0;
+    if (!carry_.empty()) {
+      const auto newline = data.find('\n');
+      if (newline == std::string_view::npos) {
+        carry_.append(data);
+        return out_;
+      }
+      carry_.append(data.substr(0, newline));
+      joined_.swap(carry_);
+      carry_.clear();
+      framing::FramedRecord rec;
+      rec.payload = joined_;
+      rec.start_offset = carry_offset_;
+      rec.end_offset = offset + newline + 1;
+      out_.push_back(rec);
+      pos = newline + 1;
+    }
+    while (true) {
+      const auto newline = data.find('\n', pos);
+      if (newline == std::string_view::npos)
+        break;
+      framing::FramedRecord rec;
+      rec.payload = data.substr(pos, newline - pos);
+      rec.start_offset = offset + pos;
+      rec.end_offset = offset + newline + 1;
+      out_.push_back(rec);
+      pos = newline + 1;
+    }
+    if (pos < data.size()) {
+      carry_.assign(data.substr(pos));
+      carry_offset_ = offset + pos;
+    }
+    return out_;
+  }
+
+  void reset() {
+    carry_.clear();
+    joined_.clear();
+  }
+
+private:
+  std::string carry_;
+  std::string joined_;
+  std::uint64_t carry_offset_{0};
+  std::vector<framing::FramedRecord> out_;
+};
+
+// Feed data to frame in chunk-sized pieces; returns the records.
+template <typename Frame>
+std::size_t feed(std::string_view data, std::size_t chunk, Frame &&frame) {
+  std::size_t records = 0;
+  std::uint64_t offset = 0;
+  while (!data.empty()) {
+    const auto piece = data.substr(0, chunk);
+    records += frame(piece, offset);
+    offset += piece.size();
+    data.remove_prefix(piece.size());
+  }
+  return records;
+}
+
+// One table for lines of line_bytes; false if an implementation counted
+// other records than the rest.
+bool run(std::size_t bytes, std::size_t chunk, std::size_t line_bytes) {
+  const std::string data = bench::make_log_lines(bytes, line_bytes);
+  if (line_bytes > 0)
+    std::printf("\nlines %zu B\n", line_bytes);
+  else
+    std::printf("\nlines 40-300 B\n");
+  std::printf("%8s %12s %12s %10s\n", "isa", "scan GB/s", "framer GB/s",
+              "records");
+
+  std::vector<std::size_t> newlines;
+  newlines.reserve(data.size() / 40);
+  std::size_t want = 0;
+  const auto report = [&](const char *name, double scan, double frame,
+                          std::size_t records) {
+    if (want == 0)
+      want = records;
+    if (newlines.size() != want || records != want) {
+      std::fprintf(stderr, "%s: %zu newlines, %zu records, want %zu\n", name,
+                   newlines.size(), records, want);
+      return false;
+    }
+    std::printf("%8s %12.2f %12.2f %10zu\n", name,
+                bench::gb_per_s(data.size(), scan),
+                bench::gb_per_s(data.size(), frame), records);
+    return true;
+  };
+
+  for (const char *isa : {"avx2", "sse2", "scalar"}) {
+    if (!framing::NewlineScanner::use(isa)) {
+      std::printf("%8s %12s\n", isa, "n/a");
+      continue;
+    }
+
+    const double scan = bench::best_of(5, [&] {
+      newlines.clear();
+      framing::NewlineScanner::scan(data, newlines);
+    });
+
+    framing::LineFramer framer;
+    std::size_t records = 0;
+    const double frame = bench::best_of(5, [&] {
+      framer.reset();
+      records = feed(data, chunk, [&](std::string_view piece,
+                                      std::uint64_t offset) {
+        framer.ingest(piece, offset);
+        return framer.drain().size();
+      });
+    });
+    if (!report(isa, scan, frame, records))
+      return false;
+  }
+
+  const double scan = bench::best_of(5, [&] {
+    newlines.clear();
+    const std::string_view s = data;
+    for (auto at = s.find('\n'); at != std::string_view::npos;
+         at = s.find('\n', at + 1))
+      newlines.push_back(at);
+  });
+  FindFramer framer;
+  std::size_t records = 0;
+  const double frame = bench::best_of(5, [&] {
+    framer.reset();
+    records = feed(data, chunk,
+                   [&](std::string_view piece, std::uint64_t offset) {
+                     return framer.frame(piece, offset).size();
+                   });
+  });
+  return report("find", scan, frame, records);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const std::size_t bytes = bench::arg_mib(argc, argv, 1, 256);
+  std::size_t chunk = 256 * 1024;
+  if (argc > 2)
+    chunk = std::strtoull(argv[2], nullptr, 10) * 1024;
+  if (chunk == 0)
+    chunk = 1;
+  std::vector<std::size_t> lines = {100, 4096};
+  if (argc > 3)
+    lines = {std::strtoull(argv[3], nullptr, 10)};
+
+  std::printf("data %.0f MiB, chunk %zu KiB, default isa %s\n",
+              static_cast<double>(bytes) / (1024.0 * 1024.0), chunk / 1024,
+              framing::NewlineScanner::isa());
+  for (const std::size_t line_bytes : lines) {
+    if (!run(bytes, chunk, line_bytes))
+      return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,60 @@
+// Catch-up framing throughput of ParallelFramer against thread count.
+//
+//   parallel_framer_bench [backlog MiB (256)] [max threads (all cores)]
+//
+// Frames one in-memory backlog of log lines with 1, 2, 4, ... threads and
+// prints GB/s and the speedup over one thread. Every run must produce the
+// same records as the single-threaded one.
+
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "BenchUtil.hpp"
+#include "framing/ParallelFramer.hpp"
+
+using namespace logiq;
+
+int main(int argc, char **argv) {
+  const std::size_t bytes = bench::arg_mib(argc, argv, 1, 256);
+  std::size_t max_threads = std::thread::hardware_concurrency();
+  if (argc > 2)
+    max_threads = std::strtoull(argv[2], nullptr, 10);
+  if (max_threads == 0)
+    max_threads = 1;
+
+  const std::string data = bench::make_log_lines(bytes);
+  std::printf("backlog %.0f MiB, %zu cores\n",
+              static_cast<double>(data.size()) / (1024.0 * 1024.0),
+              static_cast<std::size_t>(std::thread::hardware_concurrency()));
+  std::printf("%8s %10s %10s %8s\n", "threads", "GB/s", "records", "speedup");
+
+  std::vector<framing::FramedRecord> out;
+  out.reserve(data.size() / 40);
+  std::size_t want_records = 0;
+  std::size_t want_consumed = 0;
+  double base = 0;
+
+  for (std::size_t t = 1;; t = std::min(t * 2, max_threads)) {
+    framing::ParallelFramer pf(t);
+    std::size_t consumed = 0;
+    const double secs = bench::best_of(5, [&] {
+      out.clear();
+      consumed = pf.frame<framing::LfFormat>(data, 0, out);
+    });
+    if (t == 1) {
+      want_records = out.size();
+      want_consumed = consumed;
+      base = secs;
+    } else if (out.size() != want_records || consumed != want_consumed) {
+      std::fprintf(stderr, "mismatch at %zu threads\n", t);
+      return 1;
+    }
+    std::printf("%8zu %10.2f %10zu %7.2fx\n", t,
+                bench::gb_per_s(data.size(), secs), out.size(), base / secs);
+    if (t == max_threads)
+      break;
+  }
+  return 0;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+
+#include "file/FileIdentity.hpp"
+
+namespace logiq::checkpoint {
+
+// Where shipping of one file stands; persisted by GroupCommit (see
+// CheckpointIndex and CheckpointJournal for the on-disk formats).
+struct Checkpoint {
+  // The file identity this checkpoint belongs to.
+  logiq::file::FileIdentity file_id{};
+
+  // Increments when we detect copytruncate/truncate on the same inode.
+  std::uint64_t generation{0};
+
+  // The last ACKed offset (exclusive). Safe restart position.
+  std::uint64_t committed_offset{0};
+
+  // The file's first bytes as of the checkpoint: a file found under
+  // file_id is only resumed if it still starts with them.
+  logiq::file::FileFingerprint fingerprint{};
+};
+
+} // namespace logiq::checkpoint
@@ -0,0 +1,378 @@
+#include "checkpoint/CheckpointIndex.hpp"
+#include "utils/Crc32.hpp"
+#include "utils/Logger.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <stdexcept>
+
+namespace logiq::checkpoint {
+
+namespace {
+
+constexpr std::uint64_t kMagic = 0x3158444950434c4cULL; // "LLCPIDX1"
+constexpr std::uint32_t kVersion = 2; // 2: slots carry a fingerprint
+constexpr std::size_t kMinCapacity = 1024;
+
+enum : std::uint32_t { kEmpty = 0, kLive = 1, kErased = 2 };
+
+std::runtime_error io_error(const std::string &what, const std::string &path) {
+  return std::runtime_error("CheckpointIndex: " + what + ": " + path + ": " +
+                            std::strerror(errno));
+}
+
+} // namespace
+
+struct CheckpointIndex::Header {
+  std::uint64_t magic{0};
+  std::uint32_t version{0};
+  std::uint32_t slot_bytes{0};
+  std::uint64_t capacity{0};
+  std::uint64_t covered{0};
+  std::uint8_t reserved[28]{};
+  std::uint32_t crc{0}; // of the bytes before it
+};
+static_assert(sizeof(CheckpointIndex::Header) == 64);
+
+struct CheckpointIndex::Slot {
+  std::uint32_t crc{0}; // of the bytes after it
+  std::uint32_t state{kEmpty};
+  std::uint64_t seq{0};
+  std::uint64_t dev{0};
+  std::uint64_t ino{0};
+  std::uint64_t generation{0};
+  std::uint64_t offset{0};
+  std::uint64_t fp_hash{0};
+  std::uint32_t fp_bytes{0};
+  std::uint32_t reserved{0};
+};
+static_assert(sizeof(CheckpointIndex::Slot) == 64);
+
+namespace {
+
+template <typename T> T *at(void *base, std::size_t offset) {
+  return reinterpret_cast<T *>(static_cast<char *>(base) + offset);
+}
+
+std::uint32_t header_crc(const CheckpointIndex::Header &h) {
+  return logiq::utils::crc32c(&h, offsetof(CheckpointIndex::Header, crc));
+}
+
+std::uint32_t slot_crc(const CheckpointIndex::Slot &s) {
+  return logiq::utils::crc32c(&s.state, sizeof(s) - sizeof(s.crc));
+}
+
+bool zero(const CheckpointIndex::Slot &s) {
+  static constexpr CheckpointIndex::Slot kZero{};
+  return std::memcmp(&s, &kZero, sizeof(s)) == 0;
+}
+
+bool valid(const CheckpointIndex::Slot &s) {
+  return (s.state == kLive || s.state == kErased) && s.crc == slot_crc(s);
+}
+
+std::size_t file_bytes(std::size_t capacity) {
+  return sizeof(CheckpointIndex::Header) +
+         capacity * sizeof(CheckpointIndex::Slot);
+}
+
+} // namespace
+
+CheckpointIndex::CheckpointIndex(std::string path) : path_(std::move(path)) {}
+
+CheckpointIndex::~CheckpointIndex() { unmap(); }
+
+void CheckpointIndex::open() {
+  const auto dir = std::filesystem::path(path_).parent_path();
+  if (!dir.empty())
+    std::filesystem::create_directories(dir);
+
+  const int fd = ::open(path_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if (fd < 0)
+    throw io_error("failed to open", path_);
+
+  struct stat st{};
+  if (::fstat(fd, &st) != 0) {
+    ::close(fd);
+    throw io_error("failed to stat", path_);
+  }
+
+  Header old;
+  if (st.st_size >= static_cast<off_t>(sizeof(old)) &&
+      ::pread(fd, &old, sizeof(old), 0) == static_cast<ssize_t>(sizeof(old)) &&
+      old.magic == kMagic && old.version != kVersion) {
+    // Another format: start over; that only means shipping data again.
+    logiq::utils::Logger::warn("CheckpointIndex: discarding index of version " +
+                               std::to_string(old.version) + ": " + path_);
+    if (::ftruncate(fd, 0) != 0) {
+      ::close(fd);
+      throw io_error("failed to reset", path_);
+    }
+    st.st_size = 0;
+  }
+
+  if (st.st_size == 0) {
+    // New index: a zero-filled file is a table of empty slots.
+    if (::ftruncate(fd, static_cast<off_t>(file_bytes(kMinCapacity))) != 0) {
+      ::close(fd);
+      throw io_error("failed to size", path_);
+    }
+    Header h;
+    h.magic = kMagic;
+    h.version = kVersion;
+    h.slot_bytes = sizeof(Slot);
+    h.capacity = kMinCapacity;
+    h.crc = header_crc(h);
+    if (::pwrite(fd, &h, sizeof(h), 0) != static_cast<ssize_t>(sizeof(h)) ||
+        ::fsync(fd) != 0) {
+      ::close(fd);
+      throw io_error("failed to initialize", path_);
+    }
+  }
+
+  map(fd);
+}
+
+void CheckpointIndex::map(int fd) {
+  struct stat st{};
+  Header h;
+  const bool ok = ::fstat(fd, &st) == 0 &&
+                  ::pread(fd, &h, sizeof(h), 0) ==
+                      static_cast<ssize_t>(sizeof(h)) &&
+                  h.magic == kMagic && h.version == kVersion &&
+                  h.slot_bytes == sizeof(Slot) && h.crc == header_crc(h) &&
+                  h.capacity >= kMinCapacity &&
+                  (h.capacity & (h.capacity - 1)) == 0 &&
+                  static_cast<std::size_t>(st.st_size) ==
+                      file_bytes(h.capacity);
+  if (!ok) {
+    ::close(fd);
+    throw std::runtime_error("CheckpointIndex: not a valid index: " + path_);
+  }
+
+  const std::size_t length = file_bytes(h.capacity);
+  void *base =
+      ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (base == MAP_FAILED)
+    throw io_error("failed to map", path_);
+
+  {
+    std::lock_guard<std::mutex> lock(map_mutex_);
+    unmap();
+    base_ = base;
+    length_ = length;
+  }
+  capacity_ = h.capacity;
+
+  // Counts for the load factor: a pass over memory, nothing to parse.
+  size_ = 0;
+  used_ = 0;
+  for (std::size_t i = 0; i < capacity_; ++i) {
+    const auto &s = *at<Slot>(base_, sizeof(Header) + i * sizeof(Slot));
+    if (!zero(s))
+      ++used_;
+    if (s.state == kLive && valid(s))
+      ++size_;
+  }
+}
+
+void CheckpointIndex::unmap() noexcept {
+  if (base_)
+    ::munmap(base_, length_);
+  base_ = nullptr;
+  length_ = 0;
+}
+
+std::optional<Checkpoint> CheckpointIndex::entry(std::size_t i) const {
+  const auto &s = *at<Slot>(base_, sizeof(Header) + i * sizeof(Slot));
+  if (s.state != kLive || !valid(s))
+    return std::nullopt;
+  Checkpoint cp;
+  cp.file_id = {s.dev, s.ino};
+  cp.generation = s.generation;
+  cp.committed_offset = s.offset;
+  cp.fingerprint = {s.fp_hash, s.fp_bytes};
+  return cp;
+}
+
+CheckpointIndex::Slot *
+CheckpointIndex::probe(const logiq::file::FileIdentity &id) const {
+  const std::size_t mask = capacity_ - 1;
+  std::size_t i = std::hash<logiq::file::FileIdentity>{}(id) & mask;
+  Slot *free = nullptr;
+  for (std::size_t n = 0; n < capacity_; ++n, i = (i + 1) & mask) {
+    auto &s = *at<Slot>(base_, sizeof(Header) + i * sizeof(Slot));
+    if (zero(s))
+      return free ? free : &s;
+    const bool ok = valid(s);
+    if (ok && s.dev == id.dev && s.ino == id.ino)
+      return &s;
+    // Erased or torn: reusable, but the chain goes on past it.
+    if (!free && (!ok || s.state == kErased))
+      free = &s;
+  }
+  return free;
+}
+
+std::optional<Checkpoint>
+CheckpointIndex::find(const logiq::file::FileIdentity &id) const {
+  const Slot *s = probe(id);
+  if (!s || s->state != kLive || !valid(*s) || s->dev != id.dev ||
+      s->ino != id.ino)
+    return std::nullopt;
+  Checkpoint cp;
+  cp.file_id = id;
+  cp.generation = s->generation;
+  cp.committed_offset = s->offset;
+  cp.fingerprint = {s->fp_hash, s->fp_bytes};
+  return cp;
+}
+
+void CheckpointIndex::write(Slot &slot, std::uint32_t state, std::uint64_t seq,
+                            const Checkpoint &cp) {
+  Slot s;
+  s.state = state;
+  s.seq = seq;
+  s.dev = cp.file_id.dev;
+  s.ino = cp.file_id.ino;
+  s.generation = cp.generation;
+  s.offset = cp.committed_offset;
+  s.fp_hash = cp.fingerprint.hash;
+  s.fp_bytes = cp.fingerprint.bytes;
+  s.crc = slot_crc(s);
+  std::memcpy(&slot, &s, sizeof(s));
+}
+
+void CheckpointIndex::put(const Checkpoint &cp, std::uint64_t seq) {
+  Slot *s = probe(cp.file_id);
+  if (!s) {
+    rehash();
+    s = probe(cp.file_id);
+  }
+
+  const bool same = valid(*s) && s->dev == cp.file_id.dev &&
+                    s->ino == cp.file_id.ino;
+  if (same && s->seq >= seq)
+    return; // replaying an update the index already has
+  if (zero(*s))
+    ++used_;
+  if (!same || s->state != kLive)
+    ++size_;
+  write(*s, kLive, seq, cp);
+
+  // Keep probe chains short: grow, or just drop erased entries.
+  if (used_ * 4 > capacity_ * 3)
+    rehash();
+}
+
+void CheckpointIndex::erase(const logiq::file::FileIdentity &id,
+                            std::uint64_t seq) {
+  Slot *s = probe(id);
+  if (!s || !valid(*s) || s->dev != id.dev || s->ino != id.ino ||
+      s->seq >= seq)
+    return;
+  if (s->state == kLive)
+    --size_;
+  // Erased, not emptied: an older update still in the journal must not
+  // bring it back on replay.
+  Checkpoint gone;
+  gone.file_id = id;
+  write(*s, kErased, seq, gone);
+}
+
+void CheckpointIndex::rehash() {
+  auto keep = [&](const Slot &s) {
+    return valid(s) && (s.state == kLive || s.seq > covered());
+  };
+  std::size_t entries = 1; // the one about to be added
+  for (std::size_t i = 0; i < capacity_; ++i)
+    entries += keep(*at<Slot>(base_, sizeof(Header) + i * sizeof(Slot)));
+  std::size_t capacity = kMinCapacity;
+  while (capacity < entries * 2)
+    capacity *= 2;
+
+  const std::string tmp = path_ + ".tmp";
+  const int fd =
+      ::open(tmp.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0)
+    throw io_error("failed to create", tmp);
+  if (::ftruncate(fd, static_cast<off_t>(file_bytes(capacity))) != 0) {
+    ::close(fd);
+    throw io_error("failed to size", tmp);
+  }
+
+  CheckpointIndex next(tmp);
+  next.map_new(fd, capacity, covered());
+  for (std::size_t i = 0; i < capacity_; ++i) {
+    const auto &s = *at<Slot>(base_, sizeof(Header) + i * sizeof(Slot));
+    if (!keep(s))
+      continue;
+    Slot *d = next.probe({s.dev, s.ino});
+    std::memcpy(d, &s, sizeof(s));
+    ++next.used_;
+    if (s.state == kLive)
+      ++next.size_;
+  }
+  next.sync();
+
+  if (::rename(tmp.c_str(), path_.c_str()) != 0)
+    throw io_error("failed to replace", path_);
+
+  std::lock_guard<std::mutex> lock(map_mutex_);
+  unmap();
+  std::swap(base_, next.base_);
+  std::swap(length_, next.length_);
+  capacity_ = next.capacity_;
+  size_ = next.size_;
+  used_ = next.used_;
+}
+
+void CheckpointIndex::map_new(int fd, std::size_t capacity,
+                              std::uint64_t covered) {
+  const std::size_t length = file_bytes(capacity);
+  void *base =
+      ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (base == MAP_FAILED)
+    throw io_error("failed to map", path_);
+  base_ = base;
+  length_ = length;
+  capacity_ = capacity;
+
+  auto &h = *at<Header>(base_, 0);
+  h.magic = kMagic;
+  h.version = kVersion;
+  h.slot_bytes = sizeof(Slot);
+  h.capacity = capacity;
+  h.covered = covered;
+  h.crc = header_crc(h);
+}
+
+std::uint64_t CheckpointIndex::covered() const noexcept {
+  return at<Header>(base_, 0)->covered;
+}
+
+void CheckpointIndex::sync() const {
+  std::lock_guard<std::mutex> lock(map_mutex_);
+  if (base_ && ::msync(base_, length_, MS_SYNC) != 0)
+    throw io_error("failed to sync", path_);
+}
+
+void CheckpointIndex::set_covered(std::uint64_t seq) {
+  auto &h = *at<Header>(base_, 0);
+  h.covered = seq;
+  h.crc = header_crc(h);
+  std::lock_guard<std::mutex> lock(map_mutex_);
+  if (::msync(base_, sizeof(Header), MS_SYNC) != 0)
+    throw io_error("failed to sync", path_);
+}
+
+} // namespace logiq::checkpoint
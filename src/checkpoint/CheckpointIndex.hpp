@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+
+#include "checkpoint/Checkpoint.hpp"
+#include "file/FileIdentity.hpp"
+
+namespace logiq::checkpoint {
+
+// On-disk hash table of checkpoints keyed by (dev, ino), mapped into memory
+// and updated in place.
+//
+// The file is a header and a power-of-two array of fixed-size slots,
+// open-addressed with linear probing. Each slot carries a CRC-32C and the
+// journal sequence number of its last update, so opening the index is an
+// mmap (nothing is parsed) and a lookup is a probe that checks one slot.
+// Writes go to the mapping and reach the disk whenever the kernel flushes
+// them, or at sync(); a slot torn by a crash fails its CRC and is treated
+// as free, and the journal, which holds every update since the last
+// sync(), puts it back on replay.
+//
+// Not thread-safe, except that sync() may run on another thread while
+// slots are written.
+class CheckpointIndex {
+public:
+  explicit CheckpointIndex(std::string path);
+  ~CheckpointIndex();
+
+  CheckpointIndex(const CheckpointIndex &) = delete;
+  CheckpointIndex &operator=(const CheckpointIndex &) = delete;
+
+  // Map the file, creating it if needed. Throws std::runtime_error on IO
+  // errors or if the file is not an index.
+  void open();
+
+  std::optional<Checkpoint> find(const logiq::file::FileIdentity &id) const;
+
+  // Set cp (or erase id) as of journal sequence number seq. Ignored if the
+  // slot already holds a newer update (journal replay). Grows the table
+  // when it fills up. Throws std::runtime_error if growing fails.
+  void put(const Checkpoint &cp, std::uint64_t seq);
+  void erase(const logiq::file::FileIdentity &id, std::uint64_t seq);
+
+  // Call f(const Checkpoint &) for every entry.
+  template <typename F> void for_each(F &&f) const {
+    for (std::size_t i = 0; i < capacity_; ++i) {
+      if (auto cp = entry(i))
+        f(*cp);
+    }
+  }
+
+  std::size_t size() const noexcept { return size_; }
+
+  // Updates up to this journal sequence number are on disk.
+  std::uint64_t covered() const noexcept;
+
+  // Write all dirty pages back and wait for them.
+  // Throws std::runtime_error on IO errors.
+  void sync() const;
+
+  // Record that sync() made every update up to seq durable.
+  void set_covered(std::uint64_t seq);
+
+  const std::string &path() const noexcept { return path_; }
+
+  // On-disk layout, defined with the code.
+  struct Header;
+  struct Slot;
+
+private:
+  // Slot i if it holds a valid entry.
+  std::optional<Checkpoint> entry(std::size_t i) const;
+  // Slot holding id, or the free (empty, erased or torn) slot to insert
+  // it into; nullptr if the table is full.
+  Slot *probe(const logiq::file::FileIdentity &id) const;
+  void write(Slot &slot, std::uint32_t state, std::uint64_t seq,
+             const Checkpoint &cp);
+  // Rebuild into a new file sized for the entries, dropping erased ones
+  // the journal no longer needs.
+  void rehash();
+  // Map an index file (taking fd), or initialize a new one of capacity
+  // slots.
+  void map(int fd);
+  void map_new(int fd, std::size_t capacity, std::uint64_t covered);
+  void unmap() noexcept;
+
+  std::string path_;
+  // Guards base_/length_ against sync() running on another thread.
+  mutable std::mutex map_mutex_;
+  void *base_{nullptr};
+  std::size_t length_{0};
+  std::size_t capacity_{0};
+  std::size_t size_{0}; // live entries
+  std::size_t used_{0}; // live and erased entries
+};
+
+} // namespace logiq::checkpoint
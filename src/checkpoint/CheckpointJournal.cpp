@@ -0,0 +1,233 @@
+#include "checkpoint/CheckpointJournal.hpp"
+#include "utils/Crc32.hpp"
+#include "utils/Logger.hpp"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+namespace logiq::checkpoint {
+
+namespace {
+
+enum class Kind : std::uint32_t { Put = 1, Erase = 2 };
+
+// On-disk record. crc covers every byte after it.
+struct Record {
+  std::uint32_t crc{0};
+  std::uint32_t kind{0};
+  std::uint64_t seq{0};
+  std::uint64_t dev{0};
+  std::uint64_t ino{0};
+  std::uint64_t generation{0};
+  std::uint64_t offset{0};
+  std::uint64_t fp_hash{0};
+  std::uint32_t fp_bytes{0};
+  std::uint32_t reserved{0};
+};
+static_assert(sizeof(Record) == 64);
+
+constexpr std::size_t kRecordBytes = sizeof(Record);
+
+std::runtime_error io_error(const std::string &what, const std::string &path) {
+  return std::runtime_error("CheckpointJournal: " + what + ": " + path + ": " +
+                            std::strerror(errno));
+}
+
+void put(std::string &out, Kind kind, std::uint64_t seq,
+         const Checkpoint &cp) {
+  Record r;
+  r.kind = static_cast<std::uint32_t>(kind);
+  r.seq = seq;
+  r.dev = cp.file_id.dev;
+  r.ino = cp.file_id.ino;
+  r.generation = cp.generation;
+  r.offset = cp.committed_offset;
+  r.fp_hash = cp.fingerprint.hash;
+  r.fp_bytes = cp.fingerprint.bytes;
+  r.crc = logiq::utils::crc32c(&r.kind, kRecordBytes - sizeof(r.crc));
+  out.append(reinterpret_cast<const char *>(&r), kRecordBytes);
+}
+
+bool decode(const char *p, Record &r) {
+  std::memcpy(&r, p, kRecordBytes);
+  return r.crc == logiq::utils::crc32c(&r.kind, kRecordBytes - sizeof(r.crc));
+}
+
+// Whole file, or empty if it does not exist.
+std::string read_file(const std::string &path) {
+  std::string out;
+  const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    if (errno == ENOENT)
+      return out;
+    throw io_error("failed to open", path);
+  }
+  struct stat st{};
+  if (::fstat(fd, &st) == 0 && st.st_size > 0)
+    out.resize(static_cast<std::size_t>(st.st_size));
+  std::size_t done = 0;
+  while (done < out.size()) {
+    const ssize_t n = ::read(fd, out.data() + done, out.size() - done);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n < 0) {
+      ::close(fd);
+      throw io_error("failed reading", path);
+    }
+    if (n == 0)
+      break;
+    done += static_cast<std::size_t>(n);
+  }
+  ::close(fd);
+  out.resize(done);
+  return out;
+}
+
+void write_all(int fd, const std::string &data, const std::string &path) {
+  std::size_t done = 0;
+  while (done < data.size()) {
+    const ssize_t n = ::write(fd, data.data() + done, data.size() - done);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      throw io_error("failed writing", path);
+    done += static_cast<std::size_t>(n);
+  }
+}
+
+// Make a rename or unlink in path's directory durable.
+void sync_dir(const std::string &path) {
+  const auto dir = fs::path(path).parent_path();
+  const std::string name = dir.empty() ? "." : dir.string();
+  const int fd = ::open(name.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (fd >= 0) {
+    ::fsync(fd);
+    ::close(fd);
+  }
+}
+
+// Pass the records of one journal newer than after to fn. Returns the
+// length of its valid prefix; max_seq is raised to the newest record seen.
+std::size_t replay(const std::string &data, std::uint64_t after,
+                   const CheckpointJournal::Replay &fn,
+                   std::uint64_t &max_seq) {
+  std::size_t pos = 0;
+  Record r;
+  while (pos + kRecordBytes <= data.size() && decode(data.data() + pos, r) &&
+         (r.kind == static_cast<std::uint32_t>(Kind::Put) ||
+          r.kind == static_cast<std::uint32_t>(Kind::Erase))) {
+    if (r.seq > after) {
+      Checkpoint cp;
+      cp.file_id = {r.dev, r.ino};
+      cp.generation = r.generation;
+      cp.committed_offset = r.offset;
+      cp.fingerprint = {r.fp_hash, r.fp_bytes};
+      fn(cp, r.seq, r.kind == static_cast<std::uint32_t>(Kind::Erase));
+    }
+    max_seq = std::max(max_seq, r.seq);
+    pos += kRecordBytes;
+  }
+  return pos;
+}
+
+int open_append(const std::string &path) {
+  const int fd =
+      ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+  if (fd < 0)
+    throw io_error("failed to open", path);
+  return fd;
+}
+
+} // namespace
+
+CheckpointJournal::CheckpointJournal(std::string path)
+    : path_(std::move(path)) {}
+
+CheckpointJournal::~CheckpointJournal() {
+  if (fd_ >= 0)
+    ::close(fd_);
+}
+
+std::uint64_t CheckpointJournal::open(std::uint64_t after, const Replay &fn) {
+  const auto dir = fs::path(path_).parent_path();
+  if (!dir.empty())
+    fs::create_directories(dir);
+
+  std::uint64_t max_seq = after;
+  replay(read_file(old_path()), after, fn, max_seq);
+
+  const auto journal = read_file(journal_path());
+  const std::size_t valid = replay(journal, after, fn, max_seq);
+
+  fd_ = open_append(journal_path());
+  if (valid < journal.size()) {
+    logiq::utils::Logger::warn(
+        "Dropping " + std::to_string(journal.size() - valid) +
+        " byte(s) of torn checkpoint records: " + journal_path());
+    if (::ftruncate(fd_, static_cast<off_t>(valid)) != 0)
+      throw io_error("failed to truncate", journal_path());
+  }
+  records_ = valid / kRecordBytes;
+  next_seq_ = max_seq + 1;
+  return max_seq;
+}
+
+std::uint64_t CheckpointJournal::append(
+    const std::vector<Checkpoint> &puts,
+    const std::vector<logiq::file::FileIdentity> &erases) {
+  const std::uint64_t first = next_seq_;
+  if (puts.empty() && erases.empty())
+    return first;
+
+  std::string buf;
+  buf.reserve((puts.size() + erases.size()) * kRecordBytes);
+  for (const auto &cp : puts)
+    put(buf, Kind::Put, next_seq_++, cp);
+  for (const auto &id : erases) {
+    Checkpoint gone;
+    gone.file_id = id;
+    put(buf, Kind::Erase, next_seq_++, gone);
+  }
+
+  try {
+    write_all(fd_, buf, journal_path());
+    if (::fdatasync(fd_) != 0)
+      throw io_error("failed to sync", journal_path());
+  } catch (...) {
+    // Cut off a partial write: later records must not follow a torn one.
+    (void)::ftruncate(fd_, static_cast<off_t>(records_ * kRecordBytes));
+    next_seq_ = first;
+    throw;
+  }
+  records_ += puts.size() + erases.size();
+  return first;
+}
+
+std::uint64_t CheckpointJournal::rotate() {
+  if (::rename(journal_path().c_str(), old_path().c_str()) != 0)
+    throw io_error("failed to rotate", journal_path());
+  const int fd = open_append(journal_path());
+  ::close(fd_);
+  fd_ = fd;
+  records_ = 0;
+  sync_dir(journal_path());
+  return next_seq_ - 1;
+}
+
+bool CheckpointJournal::rotated() const { return fs::exists(old_path()); }
+
+void CheckpointJournal::drop_rotated() {
+  ::unlink(old_path().c_str());
+  sync_dir(old_path());
+}
+
+} // namespace logiq::checkpoint
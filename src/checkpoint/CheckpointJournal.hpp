@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "checkpoint/Checkpoint.hpp"
+#include "file/FileIdentity.hpp"
+
+namespace logiq::checkpoint {
+
+// Write-ahead log of checkpoint updates: an append-only file of fixed-size,
+// CRC-protected binary records in front of the CheckpointIndex.
+//
+// Files, for base path P:
+//   P.journal      records appended since the last rotate()
+//   P.journal.old  records of the previous one, until drop_rotated()
+//
+// Each record sets (dev, ino) to (generation, committed_offset,
+// fingerprint) or erases it, and carries a sequence number that orders it
+// against the index. A torn or corrupt tail (crash mid-append) ends replay
+// and is cut off.
+// Records are written in host byte order: the files belong to the host
+// that wrote them.
+//
+// Not thread-safe.
+class CheckpointJournal {
+public:
+  // A replayed record: cp (only file_id for an erase) as of seq.
+  using Replay =
+      std::function<void(const Checkpoint &cp, std::uint64_t seq, bool erase)>;
+
+  explicit CheckpointJournal(std::string path);
+  ~CheckpointJournal();
+
+  CheckpointJournal(const CheckpointJournal &) = delete;
+  CheckpointJournal &operator=(const CheckpointJournal &) = delete;
+
+  // Pass every record newer than after to fn, oldest first, then open the
+  // journal for appending. Returns the newest sequence number seen (at
+  // least after). Call once, before anything else.
+  // Throws std::runtime_error on IO errors.
+  std::uint64_t open(std::uint64_t after, const Replay &fn);
+
+  // Append one record per put, then one per erase, numbered consecutively,
+  // and fsync once. Returns the sequence number of the first.
+  // Throws std::runtime_error on IO errors.
+  std::uint64_t append(const std::vector<Checkpoint> &puts,
+                       const std::vector<logiq::file::FileIdentity> &erases);
+
+  // Records in the current journal.
+  std::size_t records() const noexcept { return records_; }
+
+  // Move the journal aside and start a fresh one; returns the newest
+  // sequence number in the rotated one. Only while !rotated().
+  // Throws std::runtime_error on IO errors.
+  std::uint64_t rotate();
+
+  bool rotated() const;
+
+  // Delete the rotated journal once its records are durable elsewhere.
+  void drop_rotated();
+
+  const std::string &path() const noexcept { return path_; }
+
+private:
+  std::string journal_path() const { return path_ + ".journal"; }
+  std::string old_path() const { return path_ + ".journal.old"; }
+
+  std::string path_;
+  int fd_{-1};
+  std::uint64_t next_seq_{1};
+  std::size_t records_{0};
+};
+
+} // namespace logiq::checkpoint
@@ -0,0 +1,211 @@
+#include "checkpoint/GroupCommit.hpp"
+#include "utils/Logger.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+namespace logiq::checkpoint {
+
+namespace {
+
+// Journals shorter than this are never worth compacting.
+constexpr std::size_t kMinCompactRecords = 4096;
+
+bool contains(const std::vector<logiq::file::FileIdentity> &ids,
+              const logiq::file::FileIdentity &id) {
+  return std::find(ids.begin(), ids.end(), id) != ids.end();
+}
+
+} // namespace
+
+GroupCommit::GroupCommit(CheckpointIndex &index, CheckpointJournal &journal,
+                         const Options &opt)
+    : index_(index), journal_(journal), opt_(opt) {}
+
+GroupCommit::~GroupCommit() {
+  if (syncer_.joinable())
+    syncer_.join();
+}
+
+std::size_t GroupCommit::open() {
+  index_.open();
+  const auto newest = journal_.open(
+      index_.covered(),
+      [&](const Checkpoint &cp, std::uint64_t seq, bool erase) {
+        if (erase)
+          index_.erase(cp.file_id, seq);
+        else
+          index_.put(cp, seq);
+      });
+
+  // A compaction was interrupted: finish it now, with everything replayed.
+  if (journal_.rotated()) {
+    index_.sync();
+    index_.set_covered(newest);
+    journal_.drop_rotated();
+  }
+  return index_.size();
+}
+
+std::optional<Checkpoint>
+GroupCommit::find(const logiq::file::FileIdentity &id) const {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (auto it = pending_.find(id); it != pending_.end())
+      return it->second;
+    if (contains(erased_, id))
+      return std::nullopt;
+  }
+  return index_.find(id);
+}
+
+void GroupCommit::update(const logiq::file::FileIdentity &id,
+                         std::uint64_t generation, std::uint64_t offset,
+                         const logiq::file::FileFingerprint &fingerprint) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto &last = seen_[id];
+  if (last.file_id == id && last.generation == generation &&
+      last.committed_offset == offset && last.fingerprint == fingerprint)
+    return;
+
+  // Input bytes this advance covers: all of them for a new generation,
+  // none for the first advance seen (e.g. of a file resumed at startup).
+  if (last.file_id == id) {
+    const bool same =
+        last.generation == generation && offset > last.committed_offset;
+    dirty_bytes_ += same ? offset - last.committed_offset : offset;
+  }
+
+  last.file_id = id;
+  last.generation = generation;
+  last.committed_offset = offset;
+  last.fingerprint = fingerprint;
+  if (!dirty())
+    first_dirty_ = Clock::now();
+  pending_[id] = last;
+  if (!erased_.empty())
+    std::erase(erased_, id); // back after a prune; the put supersedes it
+}
+
+void GroupCommit::prune(
+    const std::unordered_set<logiq::file::FileIdentity> &live) {
+  std::vector<logiq::file::FileIdentity> gone;
+  index_.for_each([&](const Checkpoint &cp) {
+    if (!live.count(cp.file_id))
+      gone.push_back(cp.file_id);
+  });
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::erase_if(pending_,
+                [&](const auto &kv) { return !live.count(kv.first); });
+  std::erase_if(seen_, [&](const auto &kv) { return !live.count(kv.first); });
+  for (const auto &id : gone) {
+    if (contains(erased_, id))
+      continue;
+    if (!dirty())
+      first_dirty_ = Clock::now();
+    erased_.push_back(id);
+  }
+}
+
+bool GroupCommit::due(Clock::time_point now) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!dirty())
+    return false;
+  return now >= first_dirty_ + opt_.interval ||
+         (opt_.max_bytes > 0 && dirty_bytes_ >= opt_.max_bytes);
+}
+
+GroupCommit::Clock::time_point GroupCommit::deadline() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!dirty())
+    return Clock::time_point::max();
+  return first_dirty_ + opt_.interval;
+}
+
+bool GroupCommit::flush() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    puts_.clear();
+    for (const auto &[id, cp] : pending_)
+      puts_.push_back(cp);
+    erases_.swap(erased_);
+    erased_.clear();
+    pending_.clear();
+    dirty_bytes_ = 0;
+  }
+
+  // Write outside the lock: senders keep committing meanwhile.
+  std::uint64_t seq = 0;
+  try {
+    seq = journal_.append(puts_, erases_);
+  } catch (const std::exception &e) {
+    logiq::utils::Logger::warn(std::string("Checkpoint write failed: ") +
+                               e.what());
+    // Retry after another interval; newer changes win.
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!dirty())
+      first_dirty_ = Clock::now();
+    for (const auto &cp : puts_) {
+      if (!contains(erased_, cp.file_id))
+        pending_.try_emplace(cp.file_id, cp);
+    }
+    for (const auto &id : erases_) {
+      if (!pending_.contains(id) && !contains(erased_, id))
+        erased_.push_back(id);
+    }
+    return false;
+  }
+
+  // The journal has them: a failure from here on is repaired by replay.
+  try {
+    for (const auto &cp : puts_)
+      index_.put(cp, seq++);
+    for (const auto &id : erases_)
+      index_.erase(id, seq++);
+    compact();
+  } catch (const std::exception &e) {
+    logiq::utils::Logger::warn(
+        std::string("Checkpoint index update failed: ") + e.what());
+  }
+  return true;
+}
+
+void GroupCommit::compact() {
+  if (syncer_.joinable()) {
+    if (syncing_.load())
+      return;
+    syncer_.join();
+    if (synced_) {
+      // Everything in the rotated journal is in the index, on disk.
+      index_.set_covered(rotated_seq_);
+      journal_.drop_rotated();
+    }
+  }
+
+  // A rotated journal still there means its sync failed: retry that.
+  if (!journal_.rotated()) {
+    if (journal_.records() <
+        std::max(kMinCompactRecords, 4 * index_.size()))
+      return;
+    rotated_seq_ = journal_.rotate();
+  }
+
+  // The index already holds every rotated record; make that durable
+  // without holding up the caller.
+  synced_ = false;
+  syncing_.store(true);
+  syncer_ = std::thread([this] {
+    try {
+      index_.sync();
+      synced_ = true;
+    } catch (const std::exception &e) {
+      logiq::utils::Logger::warn(
+          std::string("Checkpoint index sync failed: ") + e.what());
+    }
+    syncing_.store(false);
+  });
+}
+
+} // namespace logiq::checkpoint
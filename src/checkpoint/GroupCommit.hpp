@@ -0,0 +1,119 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "checkpoint/CheckpointIndex.hpp"
+#include "checkpoint/CheckpointJournal.hpp"
+#include "file/FileIdentity.hpp"
+
+namespace logiq::checkpoint {
+
+// Coalesces checkpoint advances and persists them together.
+//
+// Every ACK only updates an in-memory table of pending changes. They are
+// appended to the journal (one fsynced write covering all of them) once
+// interval has passed since the first unsaved advance, or once the unsaved
+// advances add up to max_bytes of input, whichever comes first, and then
+// applied to the index in place. Checkpoint I/O is then bounded by the
+// interval and the number of active files, not by the batch rate or the
+// number of files followed; a crash replays at most one interval (or
+// max_bytes) of data, which the at-least-once contract allows.
+//
+// Once the journal outgrows the index, it is rotated and the index synced
+// to disk on a background thread; the rotated journal is dropped when that
+// is done, so startup only ever replays a short journal.
+//
+// update() may be called from any thread; everything else belongs to the
+// thread that owns the GroupCommit.
+class GroupCommit {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  struct Options {
+    std::chrono::milliseconds interval{1000};
+    std::uint64_t max_bytes{0}; // 0 = no byte threshold
+  };
+
+  // index and journal must outlive the GroupCommit.
+  GroupCommit(CheckpointIndex &index, CheckpointJournal &journal,
+              const Options &opt);
+  ~GroupCommit();
+
+  GroupCommit(const GroupCommit &) = delete;
+  GroupCommit &operator=(const GroupCommit &) = delete;
+
+  // Map the index and replay the journal into it; call once, first.
+  // Returns the number of files with a checkpoint. Throws
+  // std::runtime_error on IO errors.
+  std::size_t open();
+
+  // The position of file id: pending, or as persisted.
+  std::optional<Checkpoint> find(const logiq::file::FileIdentity &id) const;
+
+  // File id (generation, starting with fingerprint) is committed up to
+  // offset.
+  void update(const logiq::file::FileIdentity &id, std::uint64_t generation,
+              std::uint64_t offset,
+              const logiq::file::FileFingerprint &fingerprint);
+
+  // Stop persisting files not in live (gone from disk).
+  void prune(const std::unordered_set<logiq::file::FileIdentity> &live);
+
+  // Unsaved advances exist and the interval or byte threshold is reached.
+  bool due(Clock::time_point now) const;
+
+  // When the unsaved advances must be written; max() if there are none.
+  Clock::time_point deadline() const;
+
+  // Append what changed since the last write and apply it to the index,
+  // then start or finish a compaction if one is due. On failure logs a
+  // warning and keeps the changes for the next attempt. Returns false on
+  // failure.
+  bool flush();
+
+  // flush() if due().
+  void flush_if_due(Clock::time_point now) {
+    if (due(now))
+      flush();
+  }
+
+private:
+  bool dirty() const noexcept { return !pending_.empty() || !erased_.empty(); }
+  // Rotate the journal and sync the index in the background, or finish
+  // such a compaction once the sync is done.
+  void compact();
+
+  CheckpointIndex &index_;
+  CheckpointJournal &journal_;
+  Options opt_;
+
+  mutable std::mutex mutex_;
+  // Changed since the last write.
+  std::unordered_map<logiq::file::FileIdentity, Checkpoint> pending_;
+  std::vector<logiq::file::FileIdentity> erased_;
+  Clock::time_point first_dirty_{};
+  std::uint64_t dirty_bytes_{0};
+  // Last position seen per file, to count advanced bytes.
+  std::unordered_map<logiq::file::FileIdentity, Checkpoint> seen_;
+
+  // flush()'s copies of the changes.
+  std::vector<Checkpoint> puts_;
+  std::vector<logiq::file::FileIdentity> erases_;
+
+  // Background index sync of a compaction; rotated_seq_ is the newest
+  // record of the rotated journal it makes durable.
+  std::thread syncer_;
+  std::atomic<bool> syncing_{false};
+  bool synced_{false};
+  std::uint64_t rotated_seq_{0};
+};
+
+} // namespace logiq::checkpoint
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <vector>
 
 namespace logiq::config {
 
@@ -8,11 +11,159 @@ struct LoggingConfig {
   std::string level{"info"};
 };
 
+struct InputConfig {
+  // Paths or glob patterns to follow (e.g. /var/log/pods/*/*/*.log).
+  // When empty, Config::input_path is followed.
+  std::vector<std::string> paths;
+
+  // How often glob patterns are re-expanded. New files in directories that
+  // are already watched are also picked up via inotify.
+  int discovery_interval_ms{10000};
+
+  // Open-fd cap across all followers. Least recently active followers are
+  // suspended (fd closed, offset kept) above it. 0 disables the cap.
+  std::size_t max_open_files{1024};
+
+  // Suspend followers with no activity for this long. 0 disables.
+  int idle_close_ms{60000};
+
+  // "auto" | "inotify" | "poll". Auto uses inotify except on filesystems
+  // where it is unreliable (NFS, overlay, FUSE, SMB).
+  std::string watch_mode{"auto"};
+
+  // Wakeup interval while polling (poll mode, unreliable filesystems, or a
+  // rotation waiting to settle).
+  int poll_interval_ms{200};
+
+  // Safety-net wakeup while idle in inotify mode.
+  int idle_timeout_ms{5000};
+
+  // Adaptive read size: starts at read_bytes and grows up to read_bytes_max
+  // while the file is lagging.
+  std::size_t read_bytes{64 * 1024};
+  std::size_t read_bytes_max{4 * 1024 * 1024};
+
+  // Per-pass drain budget: keep reading/framing/sending until EOF or until
+  // either budget is spent, then yield. 0 disables that budget.
+  std::size_t drain_budget_bytes{64 * 1024 * 1024};
+  int drain_budget_ms{100};
+
+  // mmap catch-up: serve an unread backlog of at least this many bytes from
+  // a file mapping, in windows of mmap_window_bytes. 0 disables.
+  std::uint64_t mmap_threshold_bytes{0};
+  std::size_t mmap_window_bytes{4 * 1024 * 1024};
+
+  // Threads that observe, read and (without runtime workers) frame and
+  // ship ready inputs, one input per thread at a time, with work stealing.
+  // 1 keeps everything on the main loop; 0 uses all hardware threads.
+  std::size_t reader_threads{1};
+
+  // "posix" | "io_uring". io_uring batches the stat and read calls of all
+  // ready inputs into a few io_uring_enter() calls per pass; it falls back
+  // to posix if the kernel does not support it.
+  std::string io_backend{"posix"};
+};
+
+struct FramingConfig {
+  // Record format of the inputs: "lf" | "crlf" | "nul" | "length_prefixed"
+  // (4-byte big-endian length, then payload) | "cri" (container runtime
+  // logs; partial lines are joined).
+  std::string format{"lf"};
+
+  // Threads used to frame large backlog chunks (catch-up). 1 disables
+  // parallel framing; 0 uses all hardware threads.
+  std::size_t parallel_threads{1};
+
+  // Minimum bytes per thread; smaller chunks are framed sequentially.
+  std::size_t parallel_min_bytes{1024 * 1024};
+
+  // Longest record; bounds framer memory when a writer never emits '\n'.
+  // 0 disables the bound.
+  std::size_t max_line_bytes{1024 * 1024};
+
+  // "split" | "truncate": longer lines become several records, or one
+  // record with the first max_line_bytes (the rest is dropped).
+  std::string line_overflow{"split"};
+
+  // Multiline records: a line matching multiline_start (a regular
+  // expression anchored at the line start, e.g. "^\d{4}-\d{2}-\d{2}")
+  // begins a record and other lines are appended to it. A record is shipped
+  // when the next one starts or after multiline_flush_ms without new lines.
+  // Empty disables grouping.
+  std::string multiline_start;
+  int multiline_flush_ms{1000};
+};
+
+struct BatchConfig {
+  // A batch is shipped once it holds max_records records or max_bytes
+  // payload bytes, or linger_ms after its first record, whichever comes
+  // first (0 disables a limit). linger_ms 0 ships what each read produced
+  // right away; raising it trades latency for fewer, larger requests.
+  std::size_t max_records{10000};
+  std::size_t max_bytes{4 * 1024 * 1024};
+  int linger_ms{0};
+};
+
+struct RuntimeConfig {
+  // Framing/serialization worker threads. 0 runs every stage inline on the
+  // main thread; otherwise reading, framing, sending and committing run on
+  // separate threads connected by bounded queues.
+  std::size_t workers{0};
+  // Threads calling the sink (with workers > 0).
+  std::size_t senders{1};
+  // Capacity of each queue between stages, in messages.
+  std::size_t queue_depth{1024};
+  // Batches per file sent but not yet ACKed (or failed); reading the file
+  // pauses while the window is full. 0 = unlimited.
+  std::size_t max_in_flight{8};
+};
+
+struct MemoryConfig {
+  // Log data the agent may buffer (partial lines, open batches, chunks and
+  // batches queued or in flight) before it stops reading; 0 = no limit.
+  std::size_t limit_bytes{256 * 1024 * 1024};
+  // Reading resumes once buffered data falls to this; 0 = 3/4 of the limit.
+  std::size_t resume_bytes{0};
+};
+
+struct CheckpointConfig {
+  // Base name of the checkpoint files (<path>.index, <path>.journal).
+  std::string path{"checkpoint"};
+  // ACKed positions are written together (one fsynced write for all
+  // files) at most flush_interval_ms after the first unsaved one, or once
+  // they cover flush_bytes of input (0 disables). A crash reships at most
+  // that much.
+  int flush_interval_ms{1000};
+  std::size_t flush_bytes{64 * 1024 * 1024};
+};
+
+struct OutputConfig {
+  // Where batches are POSTed (http:// only).
+  std::string url{"http://localhost:8080"};
+  // Per request, connecting included; a batch without a response by then
+  // fails and is sent again.
+  int timeout_ms{2000};
+  // Keep-alive connections kept open between requests; at least
+  // runtime.senders avoids new handshakes.
+  std::size_t max_idle_connections{8};
+  // Request body encoding: none | gzip | zstd, at compression_level
+  // (0 = the codec's default; gzip 1-9, zstd 1-22 or negative for its
+  // faster modes).
+  std::string compression{"none"};
+  int compression_level{0};
+};
+
 struct Config {
   LoggingConfig logging;
+  InputConfig input;
+  FramingConfig framing;
+  BatchConfig batch;
+  RuntimeConfig runtime;
+  MemoryConfig memory;
+  CheckpointConfig checkpoint;
+  OutputConfig output;
 
   std::string input_path{"logs.log"};
-  std::string checkpoint_path{"checkpoint.json"};
 };
 
 } // namespace logiq::config
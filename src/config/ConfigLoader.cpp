@@ -46,6 +46,77 @@ inline std::string strip_quotes(std::string v) {
   return v;
 }
 
+// Parse an integer value, negative ones included; throws with the
+// offending key.
+inline int parse_signed_int(const std::string &key, const std::string &value) {
+  std::size_t used = 0;
+  long v = 0;
+  try {
+    v = std::stol(value, &used);
+  } catch (const std::exception &) {
+    used = 0;
+  }
+  if (used == 0 || used != value.size() || v < -1'000'000'000L ||
+      v > 1'000'000'000L) {
+    throw std::runtime_error("ConfigLoader: invalid integer for " + key +
+                             ": " + value);
+  }
+  return static_cast<int>(v);
+}
+
+// Parse a non-negative integer value; throws with the offending key.
+inline int parse_int(const std::string &key, const std::string &value) {
+  const int v = parse_signed_int(key, value);
+  if (v < 0) {
+    throw std::runtime_error("ConfigLoader: invalid integer for " + key +
+                             ": " + value);
+  }
+  return v;
+}
+
+// Parse a byte size; throws with the offending key.
+inline std::size_t parse_size(const std::string &key,
+                              const std::string &value) {
+  std::size_t used = 0;
+  unsigned long long v = 0;
+  try {
+    v = std::stoull(value, &used);
+  } catch (const std::exception &) {
+    used = 0;
+  }
+  if (used == 0 || used != value.size() || value.front() == '-') {
+    throw std::runtime_error("ConfigLoader: invalid size for " + key + ": " +
+                             value);
+  }
+  return static_cast<std::size_t>(v);
+}
+
+// Parse a byte size that must be at least 1.
+inline std::size_t parse_nonzero_size(const std::string &key,
+                                      const std::string &value) {
+  const std::size_t v = parse_size(key, value);
+  if (v == 0) {
+    throw std::runtime_error("ConfigLoader: " + key + " must be > 0");
+  }
+  return v;
+}
+
+// Split a comma-separated list, trimming and unquoting each item.
+inline std::vector<std::string> split_list(const std::string &value) {
+  std::vector<std::string> out;
+  std::size_t pos = 0;
+  while (pos <= value.size()) {
+    auto comma = value.find(',', pos);
+    if (comma == std::string::npos)
+      comma = value.size();
+    auto item = strip_quotes(value.substr(pos, comma - pos));
+    if (!item.empty())
+      out.push_back(std::move(item));
+    pos = comma + 1;
+  }
+  return out;
+}
+
 } // namespace
 
 Config ConfigLoader::load(const std::string &path) {
@@ -91,6 +162,15 @@ Config ConfigLoader::load(const std::string &path) {
     apply_kv(cfg, key, value);
   }
 
+  // Checked once every key is in, since they may come in either order.
+  if (cfg.input.read_bytes > cfg.input.read_bytes_max) {
+    throw std::runtime_error(
+        "ConfigLoader: input.read_bytes (" +
+        std::to_string(cfg.input.read_bytes) +
+        ") exceeds input.read_bytes_max (" +
+        std::to_string(cfg.input.read_bytes_max) + ")");
+  }
+
   return cfg;
 }
 
@@ -107,11 +187,176 @@ void ConfigLoader::apply_kv(Config &cfg, const std::string &key,
     cfg.input_path = value;
     return;
   }
+  if (key == "input.paths" || key == "input.include") {
+    for (auto &p : split_list(value))
+      cfg.input.paths.push_back(std::move(p));
+    return;
+  }
+  if (key == "input.discovery_interval_ms") {
+    cfg.input.discovery_interval_ms = parse_int(key, value);
+    return;
+  }
+  if (key == "input.max_open_files") {
+    cfg.input.max_open_files = parse_size(key, value);
+    return;
+  }
+  if (key == "input.idle_close_ms") {
+    cfg.input.idle_close_ms = parse_int(key, value);
+    return;
+  }
+  if (key == "input.watch" || key == "input.watch_mode") {
+    cfg.input.watch_mode = value;
+    return;
+  }
+  if (key == "input.poll_interval_ms") {
+    cfg.input.poll_interval_ms = parse_int(key, value);
+    return;
+  }
+  if (key == "input.idle_timeout_ms") {
+    cfg.input.idle_timeout_ms = parse_int(key, value);
+    return;
+  }
+  if (key == "input.read_bytes") {
+    cfg.input.read_bytes = parse_nonzero_size(key, value);
+    return;
+  }
+  if (key == "input.read_bytes_max") {
+    cfg.input.read_bytes_max = parse_nonzero_size(key, value);
+    return;
+  }
+  if (key == "input.drain_budget_bytes") {
+    cfg.input.drain_budget_bytes = parse_size(key, value);
+    return;
+  }
+  if (key == "input.mmap_threshold_bytes") {
+    cfg.input.mmap_threshold_bytes = parse_size(key, value);
+    return;
+  }
+  if (key == "input.mmap_window_bytes") {
+    cfg.input.mmap_window_bytes = parse_size(key, value);
+    return;
+  }
+  if (key == "input.reader_threads") {
+    cfg.input.reader_threads = parse_size(key, value);
+    return;
+  }
+  if (key == "input.io_backend") {
+    cfg.input.io_backend = value;
+    return;
+  }
+  if (key == "input.drain_budget_ms") {
+    cfg.input.drain_budget_ms = parse_int(key, value);
+    return;
+  }
+
+  // Framing
+  if (key == "framing.format") {
+    cfg.framing.format = value;
+    return;
+  }
+  if (key == "framing.parallel_threads") {
+    cfg.framing.parallel_threads = parse_size(key, value);
+    return;
+  }
+  if (key == "framing.parallel_min_bytes") {
+    cfg.framing.parallel_min_bytes = parse_size(key, value);
+    return;
+  }
+  if (key == "framing.max_line_bytes") {
+    cfg.framing.max_line_bytes = parse_size(key, value);
+    return;
+  }
+  if (key == "framing.line_overflow") {
+    cfg.framing.line_overflow = value;
+    return;
+  }
+  if (key == "framing.multiline.start" ||
+      key == "framing.multiline_start") {
+    cfg.framing.multiline_start = value;
+    return;
+  }
+  if (key == "framing.multiline.flush_ms" ||
+      key == "framing.multiline_flush_ms") {
+    cfg.framing.multiline_flush_ms = parse_int(key, value);
+    return;
+  }
+
+  // Batching
+  if (key == "batch.max_records") {
+    cfg.batch.max_records = parse_size(key, value);
+    return;
+  }
+  if (key == "batch.max_bytes") {
+    cfg.batch.max_bytes = parse_size(key, value);
+    return;
+  }
+  if (key == "batch.linger_ms") {
+    cfg.batch.linger_ms = parse_int(key, value);
+    return;
+  }
+
+  // Runtime
+  if (key == "runtime.workers") {
+    cfg.runtime.workers = parse_size(key, value);
+    return;
+  }
+  if (key == "runtime.senders") {
+    cfg.runtime.senders = parse_size(key, value);
+    return;
+  }
+  if (key == "runtime.queue_depth") {
+    cfg.runtime.queue_depth = parse_size(key, value);
+    return;
+  }
+  if (key == "runtime.max_in_flight") {
+    cfg.runtime.max_in_flight = parse_size(key, value);
+    return;
+  }
+
+  // Memory
+  if (key == "memory.limit_bytes") {
+    cfg.memory.limit_bytes = parse_size(key, value);
+    return;
+  }
+  if (key == "memory.resume_bytes") {
+    cfg.memory.resume_bytes = parse_size(key, value);
+    return;
+  }
 
   // Checkpoint
   if (key == "checkpoint.path" || key == "state.checkpoint" ||
       key == "checkpoint") {
-    cfg.checkpoint_path = value;
+    cfg.checkpoint.path = value;
+    return;
+  }
+  if (key == "checkpoint.flush_interval_ms") {
+    cfg.checkpoint.flush_interval_ms = parse_int(key, value);
+    return;
+  }
+  if (key == "checkpoint.flush_bytes") {
+    cfg.checkpoint.flush_bytes = parse_size(key, value);
+    return;
+  }
+
+  // Output
+  if (key == "output.url") {
+    cfg.output.url = value;
+    return;
+  }
+  if (key == "output.timeout_ms") {
+    cfg.output.timeout_ms = parse_int(key, value);
+    return;
+  }
+  if (key == "output.max_idle_connections") {
+    cfg.output.max_idle_connections = parse_size(key, value);
+    return;
+  }
+  if (key == "output.compression") {
+    cfg.output.compression = value;
+    return;
+  }
+  if (key == "output.compression_level") {
+    cfg.output.compression_level = parse_signed_int(key, value);
     return;
   }
 
@@ -10,7 +10,10 @@ namespace logiq::config {
 //
 // logging.level: debug
 // input.path: logs.log
-// checkpoint.path: checkpoint.json
+// input.paths: /var/log/pods/*/*/*.log, /var/log/app.log
+// input.watch: auto            # auto | inotify | poll
+// input.poll_interval_ms: 200
+// checkpoint.path: checkpoint
 //
 class ConfigLoader {
 public:
@@ -1,71 +1,857 @@
 #include "core/Agent.hpp"
 #include "utils/Logger.hpp"
+#include "utils/MemoryBudget.hpp"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <thread>
+#include <unordered_map>
 
 namespace logiq::core {
 
+namespace {
+
+std::vector<std::string> input_patterns(const logiq::config::Config &cfg) {
+  if (!cfg.input.paths.empty())
+    return cfg.input.paths;
+  return {cfg.input_path};
+}
+
+logiq::sinks::Compression output_compression(
+    const logiq::config::Config &cfg) {
+  if (auto c = logiq::sinks::parse_compression(cfg.output.compression))
+    return *c;
+  logiq::utils::Logger::warn("Unknown output.compression '" +
+                             cfg.output.compression + "'; using none");
+  return logiq::sinks::Compression::None;
+}
+
+} // namespace
+
 Agent::Agent(const logiq::config::Config &config)
-    : config_(config), follower_(config.input_path),
-      sink_({.name = "primary", .url = "http://localhost:8080"}) {}
+    : config_(config),
+      follower_opt_{.max_read_bytes = config.input.read_bytes,
+                    .max_read_bytes_limit = config.input.read_bytes_max,
+                    .mmap_threshold_bytes = config.input.mmap_threshold_bytes,
+                    .mmap_window_bytes = config.input.mmap_window_bytes},
+      watcher_(logiq::file::parse_watch_mode(config.input.watch_mode)),
+      discovery_(input_patterns(config)),
+      line_limit_{.max_bytes = config.framing.max_line_bytes,
+                  .overflow = logiq::framing::parse_line_overflow(
+                      config.framing.line_overflow)},
+      sink_({.name = "primary",
+             .url = config.output.url,
+             .timeout_ms = config.output.timeout_ms,
+             .max_idle_connections = config.output.max_idle_connections,
+             .compression = output_compression(config),
+             .compression_level = config.output.compression_level}),
+      checkpoint_index_(config.checkpoint.path + ".index"),
+      checkpoint_journal_(config.checkpoint.path),
+      checkpoints_(checkpoint_index_, checkpoint_journal_,
+                   {.interval = std::chrono::milliseconds(
+                        config.checkpoint.flush_interval_ms),
+                    .max_bytes = config.checkpoint.flush_bytes}) {
+  std::size_t readers = config.input.reader_threads;
+  if (readers == 0)
+    readers = std::max(1u, std::thread::hardware_concurrency());
+  if (readers > 1)
+    scheduler_ = std::make_unique<Scheduler>(readers);
+
+  // The ParallelFramer runs one job at a time; with a reader pool, files
+  // are framed in parallel already.
+  std::size_t threads = config.framing.parallel_threads;
+  if (threads == 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  if (threads > 1 && !scheduler_) {
+    parallel_ = std::make_unique<logiq::framing::ParallelFramer>(
+        threads, config.framing.parallel_min_bytes);
+  }
+
+  if (auto format =
+          logiq::framing::parse_framing_format(config.framing.format)) {
+    format_ = *format;
+  } else {
+    logiq::utils::Logger::warn("Unknown framing.format '" +
+                               config.framing.format + "'; using lf");
+  }
+
+  if (!config.framing.multiline_start.empty()) {
+    multiline_start_ = std::make_unique<logiq::framing::LinePattern>(
+        config.framing.multiline_start);
+  }
+
+  const auto &memory = config.memory;
+  logiq::utils::MemoryBudget::instance().configure(
+      memory.limit_bytes, memory.resume_bytes > 0 ? memory.resume_bytes
+                                                  : memory.limit_bytes / 4 * 3);
+
+  batch_limits_ =
+      BatchLimits{.max_records = config.batch.max_records,
+                  .max_bytes = config.batch.max_bytes,
+                  .linger = std::chrono::milliseconds(config.batch.linger_ms)}
+          .capped_by(sink_.max_batch_records(), sink_.max_batch_bytes());
+
+  if (config.runtime.workers > 0) {
+    runtime_ = std::make_unique<Runtime>(
+        Runtime::Options{
+            .workers = config.runtime.workers,
+            .senders = config.runtime.senders,
+            .queue_depth = config.runtime.queue_depth,
+            .max_in_flight = config.runtime.max_in_flight,
+            .tick = std::chrono::milliseconds(config.input.poll_interval_ms)},
+        sink_, [this](logiq::framing::AnyFramer &framer, BatchBuilder &b) {
+          // Workers frame in parallel already; no ParallelFramer here.
+          framer = logiq::framing::AnyFramer(format_);
+          framer.set_limit(line_limit_);
+          framer.set_multiline(
+              multiline_start_.get(),
+              std::chrono::milliseconds(config_.framing.multiline_flush_ms));
+          b.set_limits(batch_limits_);
+        });
+  }
+
+  if (config.input.io_backend == "io_uring" && scheduler_) {
+    logiq::utils::Logger::warn(
+        "io_uring needs input.reader_threads 1; using POSIX reads");
+  } else if (config.input.io_backend == "io_uring") {
+    uring_ = std::make_unique<logiq::file::IoUring>();
+    if (!uring_->ready()) {
+      logiq::utils::Logger::warn("io_uring unavailable; using POSIX reads");
+      uring_.reset();
+    }
+  }
+}
 
 bool Agent::initialize() {
-  follower_.open_if_exists();
+  const auto started = Clock::now();
+  const std::size_t restored = checkpoints_.open();
+  logiq::utils::Logger::info(
+      "Loaded " + std::to_string(restored) + " checkpoint(s) from " +
+      checkpoint_journal_.path() + " in " +
+      std::to_string(std::chrono::duration_cast<std::chrono::microseconds>(
+                         Clock::now() - started)
+                         .count()) +
+      " us");
+
+  const auto now = Clock::now();
+  discover(now, true);
+  next_poll_ = now;
+
+  std::size_t resumed = 0;
+  inputs_.for_each([&](FileInput &in) { resumed += in.committed_offset > 0; });
+  logiq::utils::Logger::info("Resumed " + std::to_string(resumed) +
+                             " file(s) from checkpoints");
+
+  logiq::utils::Logger::info(
+      "Following " + std::to_string(inputs_.size()) + " file(s) from " +
+      std::to_string(discovery_.patterns().size()) + " pattern(s)" +
+      (watcher_.active() ? " with inotify" : " by polling") +
+      (uring_ ? " (io_uring)" : "") +
+      (scheduler_ ? ", " + std::to_string(scheduler_->threads()) +
+                        " reader(s)"
+                  : "") +
+      (runtime_ ? ", " + std::to_string(config_.runtime.workers) +
+                      " worker(s)"
+                : ""));
+
   logiq::utils::Logger::info("Agent initialized.");
   return true;
 }
 
-void Agent::run_once() {
+void Agent::discover(Clock::time_point now, bool startup) {
+  next_discovery_ =
+      now + std::chrono::milliseconds(config_.input.discovery_interval_ms);
+
+  inputs_.for_each([](FileInput &in) { in.seen = false; });
+
+  std::unordered_set<logiq::file::FileIdentity> live;
+  for (auto &found : discovery_.scan()) {
+    if (found.id)
+      live.insert(*found.id);
+
+    if (auto *in = inputs_.find_path(found.path)) {
+      in->seen = true;
+      continue;
+    }
+
+    // Same inode already followed under another name, e.g. app.log was
+    // rotated to app.log.1 and its follower is still draining it.
+    if (found.id && inputs_.find_id(*found.id))
+      continue;
+
+    follow(found.path, found.literal, now).seen = true;
+  }
+
+  // Before the prune below, which would drop their checkpoints.
+  if (startup)
+    recover_rotated(now);
+
+  // Drop glob matches that vanished and have nothing left to drain.
+  std::vector<std::uint64_t> gone;
+  inputs_.for_each([&](FileInput &in) {
+    if (!in.seen && !in.literal && !in.follower.has_fd())
+      gone.push_back(in.slot);
+  });
+  for (auto slot : gone) {
+    auto *in = inputs_.get(slot);
+    logiq::utils::Logger::debug("No longer following " + in->follower.path());
+    watcher_.unwatch(in->follower.path());
+    timed_.erase(slot);
+    stalled_.erase(slot);
+    flush_batch(*in, now, true);
+    if (runtime_)
+      runtime_->close(slot);
+    inputs_.remove(slot);
+  }
+
+  // Files still drained under an old name are live too.
+  inputs_.for_each([&](FileInput &in) {
+    if (in.follower.has_fd())
+      live.insert(in.follower.active_id());
+  });
+  inputs_.prune_retired(live);
+  checkpoints_.prune(live);
+}
+
+FileInput &Agent::follow(const std::string &path, bool literal,
+                         Clock::time_point now) {
+  auto &in = inputs_.add(path, follower_opt_, literal);
+  in.framer = logiq::framing::AnyFramer(format_);
+  in.framer.set_parallel(parallel_.get());
+  in.framer.set_limit(line_limit_);
+  in.framer.set_multiline(
+      multiline_start_.get(),
+      std::chrono::milliseconds(config_.framing.multiline_flush_ms));
+  in.batcher.set_limits(batch_limits_);
+
+  if (in.follower.open_if_exists()) {
+    // A rotated file we already shipped under its old name: resume.
+    if (auto r = inputs_.take_retired(in.follower.active_id())) {
+      in.follower.set_position(r->committed_offset, r->generation);
+      in.committed_offset = r->committed_offset;
+    } else {
+      restore_position(in);
+    }
+    inputs_.rekey(in);
+    inputs_.touch(in, now);
+  }
+
+  watcher_.watch(in.follower.path(), in.slot);
+  in.polled = watcher_.is_polled(in.follower.path());
+  if (in.polled)
+    timed_.insert(in.slot);
+
+  logiq::utils::Logger::debug("Following " + in.follower.path());
+  enqueue(in.slot);
+  return in;
+}
+
+void Agent::restore_position(FileInput &in) {
+  auto &f = in.follower;
+  const auto cp = checkpoints_.find(f.active_id());
+  if (!cp)
+    return; // a file we have never shipped from
+
+  struct stat st{};
+  if (::fstat(f.fd(), &st) != 0)
+    return;
+  const auto size = static_cast<std::uint64_t>(st.st_size);
+  if (cp->committed_offset > size || !cp->fingerprint.matches(f.fd())) {
+    // Truncated, rewritten or the inode reused by another file while we
+    // were down: all of it is new.
+    logiq::utils::Logger::info("Checkpoint of " + f.path() +
+                               " does not match the file any more; "
+                               "reading from the start");
+    f.set_position(0, cp->generation + 1);
+    return;
+  }
+
+  f.set_position(cp->committed_offset, cp->generation);
+  in.committed_offset = cp->committed_offset;
+  logiq::utils::Logger::debug("Resuming " + f.path() + " at offset " +
+                              std::to_string(cp->committed_offset));
+}
+
+void Agent::recover_rotated(Clock::time_point now) {
+  namespace fs = std::filesystem;
+
+  // Directories of followed files, with the names followed in each.
+  std::unordered_map<std::string, std::vector<std::string>> dirs;
+  inputs_.for_each([&](FileInput &in) {
+    const fs::path p(in.follower.path());
+    dirs[p.parent_path().string()].push_back(p.filename().string());
+  });
+
+  std::vector<std::string> found;
+  for (const auto &[dir, names] : dirs) {
+    std::error_code ec;
+    for (const auto &entry : fs::directory_iterator(
+             dir.empty() ? fs::path(".") : fs::path(dir), ec)) {
+      const auto name = entry.path().filename().string();
+      // Rotated siblings: app.log.1, app.log-20240101, ...
+      const bool sibling = std::any_of(
+          names.begin(), names.end(), [&](const std::string &base) {
+            return name.size() > base.size() + 1 && name.starts_with(base) &&
+                   (name[base.size()] == '.' || name[base.size()] == '-');
+          });
+      if (!sibling || inputs_.find_path(entry.path().string()))
+        continue;
+
+      struct stat st{};
+      if (::stat(entry.path().c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+        continue;
+      const logiq::file::FileIdentity id{static_cast<std::uint64_t>(st.st_dev),
+                                         static_cast<std::uint64_t>(st.st_ino)};
+      if (inputs_.find_id(id))
+        continue;
+      const auto cp = checkpoints_.find(id);
+      if (!cp || cp->committed_offset >= static_cast<std::uint64_t>(st.st_size))
+        continue;
+      // Same inode, but is it still the same file?
+      const int fd = ::open(entry.path().c_str(), O_RDONLY | O_CLOEXEC);
+      if (fd < 0)
+        continue;
+      if (cp->fingerprint.matches(fd))
+        found.push_back(entry.path().string());
+      ::close(fd);
+    }
+  }
+
+  // Rotated while we were down with a tail never shipped: drain it. Not
+  // matched by discovery, so the input goes away once drained and idle.
+  for (const auto &path : found) {
+    logiq::utils::Logger::info("Draining rotated file " + path);
+    follow(path, false, now).seen = true;
+  }
+}
+
+void Agent::enqueue(std::uint64_t slot) {
+  auto *in = inputs_.get(slot);
+  if (!in || in->queued)
+    return;
+  in->queued = true;
+  ready_.push_back(slot);
+}
+
+bool Agent::run_once() {
+  auto now = Clock::now();
+
+  apply_commits();
+
+  // Lost inotify events or a new file in a watched directory: rescan, and
+  // (on overflow) look at everything once.
+  if (watcher_.take_rescan()) {
+    discover(now);
+    inputs_.for_each([&](FileInput &in) { enqueue(in.slot); });
+  } else if (now >= next_discovery_) {
+    discover(now);
+  }
+
+  // Held-back inputs get another try every pass.
+  for (auto slot : stalled_)
+    enqueue(slot);
+
+  if (!timed_.empty() && now >= next_poll_) {
+    for (auto slot : timed_)
+      enqueue(slot);
+    next_poll_ =
+        now + std::chrono::milliseconds(config_.input.poll_interval_ms);
+  }
+
+  // Visit each input with work once; inputs that exhaust their budget go
+  // to the back of the queue so one hot file cannot starve the others.
+  std::vector<std::uint64_t> batch;
+  batch.swap(ready_);
+
+  work_.clear();
+  for (auto slot : batch) {
+    auto *in = inputs_.get(slot);
+    if (!in)
+      continue;
+    in->queued = false;
+    if (stalled_.contains(slot) && !resume(*in))
+      continue; // still backpressured: read nothing more for now
+    work_.push_back(in);
+  }
+
+  if (scheduler_) {
+    // Each input is one task, run by one thread; busy threads get their
+    // tasks stolen by idle ones.
+    requeue_.assign(work_.size(), 0);
+    scheduler_->run(work_.size(), [&](std::size_t i) {
+      requeue_[i] = process(*work_[i], now);
+    });
+    for (std::size_t i = 0; i < work_.size(); ++i) {
+      if (requeue_[i])
+        enqueue(work_[i]->slot);
+    }
+  } else if (uring_) {
+    process_batch(work_, now);
+  } else {
+    for (auto *in : work_) {
+      if (process(*in, now))
+        enqueue(in->slot);
+    }
+  }
+
+  for (auto *in : work_) {
+    in->framer_memory.set(in->framer.buffered_bytes());
+    if (in->throttled)
+      stalled_.insert(in->slot);
+    if (in->polled || in->follower.settling() || in->framer.pending() ||
+        !in->batcher.empty()) {
+      timed_.insert(in->slot);
+    } else {
+      timed_.erase(in->slot);
+    }
+    // Wake up in time to ship a lingering batch.
+    if (!in->batcher.empty())
+      next_poll_ = std::min(next_poll_, in->batcher.deadline());
+  }
+
+  inputs_.enforce_limits(config_.input.max_open_files,
+                         std::chrono::milliseconds(config_.input.idle_close_ms),
+                         Clock::now());
+
+  checkpoints_.flush_if_due(Clock::now());
+
+  return !ready_.empty();
+}
+
+bool Agent::process(FileInput &in, Clock::time_point now) {
   // 1️⃣ Observe filesystem changes
-  auto poll = follower_.poll(committed_offset_);
+  observe(in, now, nullptr);
 
-  if (poll.truncated || poll.switched) {
-    framer_.reset();
+  // 2️⃣-6️⃣ Drain: read, frame and ship until EOF or until this pass's
+  // byte/time budget is spent.
+  const auto started = Clock::now();
+  const auto budget_time =
+      std::chrono::milliseconds(config_.input.drain_budget_ms);
+  const std::size_t budget_bytes = config_.input.drain_budget_bytes;
+  std::size_t bytes_read = 0;
+
+  while (true) {
+    if (logiq::utils::MemoryBudget::instance().paused()) {
+      shed(in);
+      return false;
+    }
+    // A batch that failed to send goes out before anything more is read.
+    if (in.batcher.held() && !send_batch(in))
+      return false;
+
+    // 2️⃣ Read new data
+    auto chunk = in.follower.read_some();
+    const std::size_t n = chunk ? chunk->data.size() : 0;
+    if (!consume(in, chunk)) {
+      const auto idle = Clock::now();
+      flush_framer(in, idle, false, in.follower.active_id(),
+                   in.follower.generation());
+      flush_batch(in, idle, false);
+      return false;
+    }
+
+    bytes_read += n;
+    if (budget_bytes > 0 && bytes_read >= budget_bytes)
+      return true;
+    if (budget_time.count() > 0 && Clock::now() - started >= budget_time)
+      return true;
+  }
+}
+
+void Agent::process_batch(const std::vector<FileInput *> &inputs,
+                          Clock::time_point now) {
+  using logiq::file::FileFollower;
+
+  // Staged entries are the targets of in-flight statx/read operations:
+  // size the vector up front so they do not move while the ring runs.
+  staged_.clear();
+  staged_.resize(inputs.size());
+
+  // 1️⃣ Observe: statx the path and the open fd of every input in one go,
+  // instead of one stat() and one fstat() per input.
+  for (std::size_t i = 0; i < inputs.size(); ++i) {
+    auto &st = staged_[i];
+    st.in = inputs[i];
+    const auto &f = st.in->follower;
+    if (!f.has_fd())
+      continue;
+    uring_->statx(AT_FDCWD, f.path().c_str(), 0, STATX_INO, &st.path_stx,
+                  2 * i);
+    uring_->statx(f.fd(), "", AT_EMPTY_PATH, STATX_SIZE, &st.fd_stx,
+                  2 * i + 1);
   }
 
-  // 2️⃣ Read new data
-  auto chunk = follower_.read_some();
-  if (!chunk)
+  const bool stated = uring_->run([&](std::uint64_t tag, int res) {
+    auto &st = staged_[tag / 2];
+    (tag % 2 ? st.fd_res : st.path_res) = res;
+  });
+  if (!stated) {
+    // The ring is gone; finish this pass (and all later ones) with POSIX.
+    uring_.reset();
+    for (auto *in : inputs) {
+      if (process(*in, now))
+        enqueue(in->slot);
+    }
     return;
+  }
 
-  if (!chunk->data.empty()) {
-    framer_.ingest(chunk->data, chunk->start_offset);
+  for (auto &st : staged_) {
+    if (!st.in->follower.has_fd()) {
+      observe(*st.in, now, nullptr); // opens the file; nothing prefetched
+      continue;
+    }
+    FileFollower::Stats stats;
+    if (st.fd_res == 0)
+      stats.fd_size = st.fd_stx.stx_size;
+    if (st.path_res == 0) {
+      stats.path_id = logiq::file::FileIdentity{
+          makedev(st.path_stx.stx_dev_major, st.path_stx.stx_dev_minor),
+          st.path_stx.stx_ino};
+    }
+    observe(*st.in, now, &stats);
   }
 
-  // 3️⃣ Frame into records
-  auto records = framer_.drain();
-  if (records.empty())
+  // 2️⃣-6️⃣ Drain in rounds: one batched read for every input still
+  // active, then frame and ship each chunk. Inputs leave at EOF, on a
+  // failed send or when their share of the budget is spent.
+  const auto started = Clock::now();
+  const auto budget_time =
+      std::chrono::milliseconds(config_.input.drain_budget_ms);
+  const std::size_t budget_bytes = config_.input.drain_budget_bytes;
+
+  // A batch that failed to send goes out before anything more is read.
+  std::erase_if(staged_, [&](const Staged &st) {
+    return st.in->batcher.held() && !send_batch(*st.in);
+  });
+
+  while (!staged_.empty()) {
+    if (logiq::utils::MemoryBudget::instance().paused()) {
+      for (auto &st : staged_)
+        shed(*st.in);
+      staged_.clear();
+      return;
+    }
+
+    // 2️⃣ Read new data. Followers serving a mapping (or without an fd)
+    // are read synchronously below.
+    for (std::size_t i = 0; i < staged_.size(); ++i) {
+      auto &st = staged_[i];
+      st.req = st.in->follower.prepare_read();
+      if (st.req) {
+        uring_->read(st.req->fd, st.req->dst, st.req->length, st.req->offset,
+                     i);
+      }
+    }
+
+    const bool ok = uring_->run(
+        [&](std::uint64_t tag, int res) { staged_[tag].read_res = res; });
+    if (!ok) {
+      // Nothing was consumed; the POSIX path picks these up next pass.
+      uring_.reset();
+      for (auto &st : staged_)
+        enqueue(st.in->slot);
+      staged_.clear();
+      return;
+    }
+
+    const bool out_of_time = budget_time.count() > 0 &&
+                             Clock::now() - started >= budget_time;
+
+    for (auto &st : staged_) {
+      auto &f = st.in->follower;
+      auto chunk = st.req ? f.complete_read(*st.req, st.read_res)
+                          : f.read_some();
+      const std::size_t n = chunk ? chunk->data.size() : 0;
+      if (!consume(*st.in, chunk)) {
+        const auto idle = Clock::now();
+        flush_framer(*st.in, idle, false, f.active_id(), f.generation());
+        flush_batch(*st.in, idle, false);
+        st.in = nullptr;
+        continue;
+      }
+
+      st.bytes_read += n;
+      if ((budget_bytes > 0 && st.bytes_read >= budget_bytes) ||
+          out_of_time) {
+        enqueue(st.in->slot);
+        st.in = nullptr;
+      }
+    }
+
+    std::erase_if(staged_, [](const Staged &st) { return !st.in; });
+  }
+}
+
+void Agent::observe(FileInput &in, Clock::time_point now,
+                    const logiq::file::FileFollower::Stats *stats) {
+  auto &follower = in.follower;
+
+  const auto prev_id = follower.active_id();
+  const auto prev_generation = follower.generation();
+
+  auto poll = stats ? follower.poll(in.committed_offset, *stats)
+                    : follower.poll(in.committed_offset);
+
+  // Lines already framed belong to the old file (or generation): ship a
+  // held-back multiline record and the open batch before the framer state
+  // and the commit position go away.
+  if (runtime_) {
+    if (poll.truncated || poll.switched)
+      runtime_->reset(in.slot, prev_id, prev_generation);
+    else if (poll.closed)
+      runtime_->flush(in.slot, prev_id, prev_generation);
+  } else {
+    if (poll.truncated || poll.switched || poll.closed) {
+      flush_framer(in, now, true, prev_id, prev_generation);
+      flush_batch(in, now, true);
+    }
+    if (poll.truncated || poll.switched)
+      in.framer.reset();
+  }
+
+  std::lock_guard<std::mutex> lock(table_mutex_);
+
+  if (poll.switched) {
+    // Leave the old inode's position behind in case discovery finds it
+    // again under its rotated name.
+    inputs_.retire(prev_id, {in.committed_offset, prev_generation});
+  }
+
+  if (poll.truncated || poll.switched) {
+    in.committed_offset = 0;
+    if (follower.active_id() != logiq::file::FileIdentity{})
+      checkpoints_.update(follower.active_id(), follower.generation(), 0,
+                          follower.fingerprint());
+  }
+
+  // A new inode is at the path: move the file watch and the index onto it.
+  if (poll.file_opened || poll.switched || poll.resumed) {
+    watcher_.watch(follower.path(), in.slot);
+    inputs_.rekey(in);
+  }
+
+  inputs_.touch(in, now);
+}
+
+bool Agent::consume(FileInput &in,
+                    std::optional<logiq::file::ReadChunk> &chunk) {
+  if (!chunk || chunk->data.empty())
+    return false; // EOF (or no file): wait for the next event
+
+  // 3️⃣-6️⃣ run on the runtime's threads. If its queue is full, hold the
+  // chunk and stop reading this file until the queue has room.
+  if (runtime_) {
+    if (!runtime_->try_submit(in.slot, in.follower.path(), *chunk)) {
+      in.stalled = std::move(chunk);
+      in.throttled = true;
+      return false;
+    }
+    if (runtime_->window_full(in.slot)) {
+      in.throttled = true;
+      return false;
+    }
+    return true;
+  }
+
+  // 3️⃣-6️⃣ Frame, batch, send, commit. Without an ACK, stop pulling more
+  // data until the next pass.
+  return in.framer.visit([&](auto &framer) {
+    framer.ingest(chunk->data, chunk->start_offset);
+    return ship(in, framer.drain(), *chunk);
+  });
+}
+
+bool Agent::resume(FileInput &in) {
+  // A held batch is retried even while memory is short: sending it is what
+  // frees its memory.
+  if (in.batcher.held() && !send_batch(in))
+    return false;
+  if (logiq::utils::MemoryBudget::instance().paused())
+    return false;
+  if (runtime_) {
+    if (in.stalled) {
+      if (!runtime_->try_submit(in.slot, in.follower.path(), *in.stalled))
+        return false;
+      in.stalled.reset();
+    }
+    if (runtime_->window_full(in.slot))
+      return false;
+  }
+  in.throttled = false;
+  stalled_.erase(in.slot);
+  return true;
+}
+
+void Agent::shed(FileInput &in) {
+  in.throttled = true;
+  const auto now = Clock::now();
+  flush_framer(in, now, false, in.follower.active_id(),
+               in.follower.generation());
+  flush_batch(in, now, true);
+}
+
+void Agent::apply_commits() {
+  if (!runtime_)
     return;
+  commits_.clear();
+  runtime_->take_commits(commits_);
+  for (const auto &c : commits_) {
+    // Ignore advances for a file generation the input has moved past.
+    auto *in = inputs_.get(c.slot);
+    if (!in || in->follower.active_id() != c.id ||
+        in->follower.generation() != c.generation)
+      continue;
+    in->committed_offset = c.commit_end;
+    in->follower.release_committed(in->committed_offset);
+    checkpoints_.update(c.id, c.generation, c.commit_end,
+                        in->follower.fingerprint());
+    logiq::utils::Logger::debug("Committed offset: " + in->follower.path() +
+                                " " + std::to_string(in->committed_offset));
+  }
+}
 
-  // 4️⃣ Build batch
-  logiq::Batch batch;
-  batch.batch_id = "batch1"; // TODO: real ID
-  batch.file_dev = chunk->id.dev;
-  batch.file_ino = chunk->id.ino;
-  batch.file_generation = chunk->generation;
+void Agent::flush_framer(FileInput &in, Clock::time_point now, bool force,
+                         logiq::file::FileIdentity id,
+                         std::uint64_t generation) {
+  if (!in.framer.pending())
+    return;
+  const auto &records = in.framer.flush_expired(now, force);
+  if (records.empty())
+    return;
+  // Held-back records are copies: nothing here can be a mapped view.
+  logiq::file::ReadChunk origin;
+  origin.id = id;
+  origin.generation = generation;
+  ship(in, records, origin);
+}
 
-  for (auto &r : records) {
-    logiq::Record rec;
-    rec.payload = r.payload;
-    rec.start_offset = r.start_offset;
-    rec.end_offset = r.end_offset;
-    rec.file_dev = chunk->id.dev;
-    rec.file_ino = chunk->id.ino;
-    rec.file_generation = chunk->generation;
-    batch.records.push_back(std::move(rec));
+bool Agent::ship(FileInput &in,
+                 const std::vector<logiq::framing::FramedRecord> &records,
+                 const logiq::file::ReadChunk &chunk) {
+  // 4️⃣ Build batch, 5️⃣-6️⃣ send and commit each one that fills up or
+  // is due.
+  const auto outcome = in.batcher.append(records, chunk, Clock::now(),
+                                         [&] { return send_batch(in); });
+  if (outcome == BatchBuilder::Append::Discarded) {
+    logiq::utils::Logger::warn(
+        "Discarding data read from truncated mapping: " + in.follower.path());
+    in.framer.reset();
+  } else if (outcome == BatchBuilder::Append::SendFailed &&
+             chunk.id == in.follower.active_id() &&
+             chunk.generation == in.follower.generation()) {
+    // The batch is held for a retry and what was framed after it dropped:
+    // read that again once the batch is out.
+    const auto from = in.batcher.resend_from(records, chunk);
+    in.framer.reset();
+    in.follower.set_position(from, chunk.generation);
   }
+  return outcome == BatchBuilder::Append::Ok;
+}
+
+void Agent::flush_batch(FileInput &in, Clock::time_point now, bool force) {
+  if (!in.batcher.empty() && (force || in.batcher.due(now)))
+    send_batch(in);
+}
 
-  batch.commit_end_offset = batch.records.back().end_offset;
+bool Agent::send_batch(FileInput &in) {
+  auto &batch = in.batcher.batch();
+  if (batch.records.empty())
+    return true;
+  const auto now = Clock::now();
+  if (in.batcher.waiting(now))
+    return false;
+  batch.set_id(in.slot, in.next_batch);
 
-  // 5️⃣ Send
+  // 5️⃣ Send. A failed batch is kept, with its id, and retried after a
+  // backoff; its input reads nothing more until it is out.
   auto result = sink_.send(batch);
+  if (!result.ok) {
+    in.batcher.hold(now);
+    logiq::utils::Logger::warn(
+        "Send failed for " + in.follower.path() + ": " + result.message +
+        "; retrying in " +
+        std::to_string((in.batcher.deadline() - now) /
+                       std::chrono::milliseconds(1)) +
+        " ms");
+    return false;
+  }
+  const logiq::file::FileIdentity id{batch.file_dev, batch.file_ino};
+  const std::uint64_t generation = batch.file_generation;
+  const std::uint64_t commit_end = batch.commit_end_offset;
+  in.batcher.clear(); // one arena reset frees every payload of the batch
 
-  // 6️⃣ Commit only if ACK
-  if (result.ok) {
-    committed_offset_ = batch.commit_end_offset;
-    logiq::utils::Logger::debug("Committed offset: " +
-                                std::to_string(committed_offset_));
+  // 6️⃣ Commit in batch order
+  std::vector<CommitTracker::Advance> advances;
+  in.commits.resolve(in.next_batch++, id, generation, commit_end, true,
+                     advances);
+  for (const auto &a : advances) {
+    // A retried batch may belong to a file (generation) already left
+    // behind: it keeps no fingerprint (the follower has none for it any
+    // more) and does not move the current commit position.
+    const bool current = a.id == in.follower.active_id() &&
+                         a.generation == in.follower.generation();
+    if (current) {
+      in.committed_offset = a.offset;
+      in.follower.release_committed(in.committed_offset);
+    }
+    checkpoints_.update(a.id, a.generation, a.offset,
+                        current ? in.follower.fingerprint()
+                                : logiq::file::FileFingerprint{});
+    logiq::utils::Logger::debug("Committed offset: " + in.follower.path() +
+                                " " + std::to_string(a.offset));
   }
+  return true;
 }
 
-void Agent::shutdown() { logiq::utils::Logger::info("Agent shutdown."); }
+void Agent::wait_for_work() {
+  if (!ready_.empty())
+    return;
+
+  // Sleep until the next timer: discovery, timed polls (unreliable
+  // filesystems, rotation settle) or the idle safety net.
+  const auto now = Clock::now();
+  auto deadline =
+      std::min(next_discovery_,
+               now + std::chrono::milliseconds(config_.input.idle_timeout_ms));
+  if (!timed_.empty())
+    deadline = std::min(deadline, next_poll_);
+  deadline = std::min(deadline, checkpoints_.deadline());
+  // Backpressure: retry stalled inputs soon; queues drain in the background.
+  if (!stalled_.empty())
+    deadline = std::min(deadline, now + std::chrono::milliseconds(1));
+
+  auto timeout =
+      std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now);
+  if (timeout.count() < 0)
+    timeout = std::chrono::milliseconds(0);
+
+  events_.clear();
+  watcher_.wait(timeout, events_);
+  for (auto slot : events_)
+    enqueue(slot);
+}
+
+void Agent::shutdown() {
+  // Ship what is still lingering; the commit positions then cover it.
+  const auto now = Clock::now();
+  inputs_.for_each([&](FileInput &in) { flush_batch(in, now, true); });
+  if (runtime_) {
+    // Hand over chunks still held back, then drain every stage.
+    inputs_.for_each([&](FileInput &in) {
+      while (in.stalled &&
+             !runtime_->try_submit(in.slot, in.follower.path(), *in.stalled))
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    });
+    runtime_->stop();
+    apply_commits();
+  }
+  checkpoints_.flush();
+  logiq::utils::Logger::info("Agent shutdown.");
+}
 
 } // namespace logiq::core
@@ -1,8 +1,28 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_set>
+#include <vector>
+
+#include "checkpoint/CheckpointIndex.hpp"
+#include "checkpoint/CheckpointJournal.hpp"
+#include "checkpoint/GroupCommit.hpp"
 #include "config/Config.hpp"
+#include "core/InputTable.hpp"
+#include "core/Runtime.hpp"
+#include "core/Scheduler.hpp"
+#include "file/FileDiscovery.hpp"
 #include "file/FileFollower.hpp"
+#include "file/FileWatcher.hpp"
+#include "file/IoUring.hpp"
+#include "framing/AnyFramer.hpp"
 #include "framing/LineFramer.hpp"
+#include "framing/LinePattern.hpp"
+#include "framing/ParallelFramer.hpp"
 #include "sinks/HttpNdjsonSink.hpp"
 
 namespace logiq::core {
@@ -12,17 +32,160 @@ public:
   explicit Agent(const logiq::config::Config &config);
 
   bool initialize();
-  void run_once();
+
+  // One scheduling pass: discover inputs if due, then run
+  // OBSERVE -> READ -> FRAME -> BATCH -> SEND -> COMMIT for every input with
+  // pending work, draining each until EOF or until the per-pass budget is
+  // spent. Returns true if some input still has work and the caller should
+  // run again without waiting.
+  bool run_once();
+
+  // Block until some input may have work (inotify event), a timer is due
+  // (poll interval, discovery), or the idle timeout expires.
+  void wait_for_work();
+
   void shutdown();
 
 private:
+  using Clock = std::chrono::steady_clock;
+
   logiq::config::Config config_;
+  logiq::file::FileFollower::Options follower_opt_;
+
+  logiq::file::FileWatcher watcher_;
+  logiq::file::FileDiscovery discovery_;
+  InputTable inputs_;
 
-  logiq::file::FileFollower follower_;
-  logiq::framing::LineFramer framer_;
+  // Record format (framing.format); selects each input's framer.
+  logiq::framing::FramingFormat format_{logiq::framing::FramingFormat::Lf};
+  // Shared by all framers for large catch-up chunks; null when disabled.
+  std::unique_ptr<logiq::framing::ParallelFramer> parallel_;
+  logiq::framing::LineLimit line_limit_;
+  // Start-of-record pattern shared by all framers; null when disabled.
+  std::unique_ptr<logiq::framing::LinePattern> multiline_start_;
   logiq::sinks::HttpNdjsonSink sink_;
+  // batch.* config, capped by the sink's own limits.
+  BatchLimits batch_limits_;
+
+  // Committed positions, persisted in groups (see GroupCommit).
+  logiq::checkpoint::CheckpointIndex checkpoint_index_;
+  logiq::checkpoint::CheckpointJournal checkpoint_journal_;
+  logiq::checkpoint::GroupCommit checkpoints_;
+
+  // Staged multi-threaded pipeline (runtime.workers > 0); null runs every
+  // stage inline in run_once().
+  std::unique_ptr<Runtime> runtime_;
+  std::vector<CommitNotice> commits_; // scratch for Runtime::take_commits
+  // Inputs held back: by the runtime (holding a chunk it has not accepted
+  // yet, or with a full in-flight window) or by the memory budget.
+  std::unordered_set<std::uint64_t> stalled_;
+
+  // Reader pool (input.reader_threads > 1); null processes inputs on the
+  // calling thread. While it runs, table_mutex_ guards inputs_ indexes and
+  // watcher_, the only state inputs share.
+  std::unique_ptr<Scheduler> scheduler_;
+  std::mutex table_mutex_;
+  std::vector<char> requeue_; // per work_ entry: budget ran out
+
+  // Batched stat/read backend (input.io_backend: io_uring); null for POSIX.
+  std::unique_ptr<logiq::file::IoUring> uring_;
+
+  // Per-input scratch for a batched pass (see process_batch).
+  struct Staged {
+    FileInput *in{nullptr};
+    struct ::statx path_stx{};
+    struct ::statx fd_stx{};
+    int path_res{0};
+    int fd_res{0};
+    std::optional<logiq::file::FileFollower::ReadRequest> req;
+    std::int64_t read_res{0};
+    std::size_t bytes_read{0};
+  };
+  std::vector<Staged> staged_;
+  std::vector<FileInput *> work_;
+
+  // Slots with pending work, in arrival order (deduplicated via queued).
+  std::vector<std::uint64_t> ready_;
+  std::vector<std::uint64_t> events_; // scratch for FileWatcher::wait
+
+  // Slots that need timed polls: unreliable filesystems and followers
+  // waiting on a timer (rotation settle, deleted-file close).
+  std::unordered_set<std::uint64_t> timed_;
+
+  Clock::time_point next_poll_{};
+  Clock::time_point next_discovery_{};
+
+private:
+  // Expand patterns, add new inputs, drop vanished ones. At startup, also
+  // pick up files rotated while the agent was down.
+  void discover(Clock::time_point now, bool startup = false);
+
+  // Add an input for path, open it if it exists and resume it from its
+  // checkpoint, if any.
+  FileInput &follow(const std::string &path, bool literal,
+                    Clock::time_point now);
+
+  // Seek in's just opened file to its persisted checkpoint, if the file
+  // still is what the checkpoint was taken from.
+  void restore_position(FileInput &in);
+
+  // Startup: follow files next to the followed ones (app.log.1, ...) that
+  // hold a checkpoint and data past it, i.e. were rotated while the agent
+  // was down.
+  void recover_rotated(Clock::time_point now);
+
+  void enqueue(std::uint64_t slot);
+
+  // Observe and drain one input. Returns true if its budget ran out.
+  bool process(FileInput &in, Clock::time_point now);
+
+  // process() for many inputs at once over io_uring: one batch of statx
+  // calls to observe all of them, then rounds of batched reads until every
+  // input hit EOF or its budget. Inputs whose budget ran out are re-queued.
+  void process_batch(const std::vector<FileInput *> &inputs,
+                     Clock::time_point now);
+
+  // Poll one input (with prefetched stats, if any) and apply the result:
+  // reset framing on truncate/switch, retire rotated files, rewatch.
+  void observe(FileInput &in, Clock::time_point now,
+               const logiq::file::FileFollower::Stats *stats);
+
+  // Frame and ship one chunk from read_some()/complete_read(), or hand it
+  // to the runtime. Returns true if the input may have more to read right
+  // away. With a runtime, a chunk it does not accept is moved to
+  // in.stalled and in.throttled is set.
+  bool consume(FileInput &in, std::optional<logiq::file::ReadChunk> &chunk);
+
+  // Check the memory budget, offer in.stalled to the runtime again and
+  // check the in-flight window. Returns true once the input may be read
+  // again.
+  bool resume(FileInput &in);
+
+  // Stop reading in for this pass because the memory budget is spent; its
+  // open batch ships early to give memory back.
+  void shed(FileInput &in);
+
+  // Apply checkpoint advances made by the runtime's committer.
+  void apply_commits();
+
+  // Ship the multiline record the framer holds back, once it timed out (or
+  // right away, with force). id/generation name the file it came from.
+  void flush_framer(FileInput &in, Clock::time_point now, bool force,
+                    logiq::file::FileIdentity id, std::uint64_t generation);
+
+  // Add framed records from one chunk to the input's batch and send every
+  // batch that fills up or is due. Returns false if the sink did not ACK.
+  bool ship(FileInput &in,
+            const std::vector<logiq::framing::FramedRecord> &records,
+            const logiq::file::ReadChunk &chunk);
+
+  // Send the input's open batch if it is due (or always, with force).
+  void flush_batch(FileInput &in, Clock::time_point now, bool force);
 
-  std::uint64_t committed_offset_{0};
+  // Send the input's open batch and commit on ACK. A batch the sink did
+  // not ACK is kept, with its id, and sent again once its backoff ends.
+  // Returns false if the batch was not ACKed (or is still backing off).
+  bool send_batch(FileInput &in);
 };
 
 } // namespace logiq::core
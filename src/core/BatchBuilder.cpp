@@ -0,0 +1,119 @@
+#include "core/BatchBuilder.hpp"
+
+#include <algorithm>
+
+namespace logiq::core {
+
+namespace {
+
+// Tighter of two limits where 0 means unlimited.
+template <typename T> T tighter(T a, T b) {
+  if (a == T{0})
+    return b;
+  if (b == T{0})
+    return a;
+  return std::min(a, b);
+}
+
+} // namespace
+
+std::chrono::milliseconds retry_delay(unsigned failures) noexcept {
+  constexpr std::chrono::milliseconds kFirst{100};
+  constexpr std::chrono::milliseconds kMax{5000};
+  if (failures <= 1)
+    return kFirst;
+  if (failures > 7)
+    return kMax;
+  return std::min(kFirst * (1 << (failures - 1)), kMax);
+}
+
+BatchLimits BatchLimits::capped_by(std::size_t sink_max_records,
+                                   std::size_t sink_max_bytes) const noexcept {
+  BatchLimits out = *this;
+  out.max_records = tighter(max_records, sink_max_records);
+  out.max_bytes = tighter(max_bytes, sink_max_bytes);
+  return out;
+}
+
+bool BatchBuilder::accepts(const logiq::file::FileIdentity &id,
+                           std::uint64_t generation) const noexcept {
+  return empty() || (batch_.file_dev == id.dev && batch_.file_ino == id.ino &&
+                     batch_.file_generation == generation);
+}
+
+bool BatchBuilder::fits(std::size_t payload_bytes) const noexcept {
+  if (empty())
+    return true;
+  if (held())
+    return false;
+  if (limits_.max_records > 0 && size() >= limits_.max_records)
+    return false;
+  if (limits_.max_bytes > 0 &&
+      batch_.bytes + payload_bytes > limits_.max_bytes)
+    return false;
+  return true;
+}
+
+void BatchBuilder::add(const logiq::framing::FramedRecord &rec,
+                       const logiq::file::FileIdentity &id,
+                       std::uint64_t generation, Clock::time_point now) {
+  if (empty()) {
+    batch_.file_dev = id.dev;
+    batch_.file_ino = id.ino;
+    batch_.file_generation = generation;
+    opened_ = now;
+  }
+
+  logiq::Record &r = batch_.add(rec.payload);
+  r.start_offset = rec.start_offset;
+  r.end_offset = rec.end_offset;
+  r.file_dev = id.dev;
+  r.file_ino = id.ino;
+  r.file_generation = generation;
+  batch_.commit_end_offset = rec.end_offset;
+  memory_.set(batch_.bytes);
+}
+
+bool BatchBuilder::due(Clock::time_point now) const noexcept {
+  if (empty() || waiting(now))
+    return false;
+  if (held())
+    return true;
+  if (limits_.linger.count() <= 0 || now >= deadline())
+    return true;
+  // Full: the next record would not fit whatever its size.
+  return (limits_.max_records > 0 && size() >= limits_.max_records) ||
+         (limits_.max_bytes > 0 && batch_.bytes >= limits_.max_bytes);
+}
+
+void BatchBuilder::hold(Clock::time_point now) noexcept {
+  ++failures_;
+  retry_at_ = now + retry_delay(failures_);
+}
+
+std::uint64_t BatchBuilder::resend_from(
+    const std::vector<logiq::framing::FramedRecord> &records,
+    const logiq::file::ReadChunk &chunk) const noexcept {
+  // The batch holds a prefix of chunk's records (and maybe earlier ones)
+  // if it is of chunk's file generation; otherwise none of them.
+  if (!empty() && accepts(chunk.id, chunk.generation))
+    return batch_.commit_end_offset;
+  return records.empty() ? 0 : records.front().start_offset;
+}
+
+void BatchBuilder::truncate(std::size_t keep) {
+  if (keep >= size())
+    return;
+  if (keep == 0) {
+    clear();
+    return;
+  }
+  // Dropped payloads stay in the arena until the batch is cleared.
+  for (std::size_t i = keep; i < size(); ++i)
+    batch_.bytes -= batch_.records[i].payload.size();
+  batch_.records.resize(keep);
+  batch_.commit_end_offset = batch_.records.back().end_offset;
+  memory_.set(batch_.bytes);
+}
+
+} // namespace logiq::core
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "file/FileFollower.hpp"
+#include "file/FileIdentity.hpp"
+#include "framing/Framer.hpp"
+#include "sinks/Sink.hpp"
+#include "utils/MemoryBudget.hpp"
+
+namespace logiq::core {
+
+// When a batch is shipped. 0 disables a limit.
+struct BatchLimits {
+  std::size_t max_records{0};
+  std::size_t max_bytes{0}; // payload bytes
+  // How long an open batch may wait for more records; 0 ships each read's
+  // records right away.
+  std::chrono::milliseconds linger{0};
+
+  // These limits, further capped by a sink's own batch size limits
+  // (0 = none).
+  BatchLimits capped_by(std::size_t sink_max_records,
+                        std::size_t sink_max_bytes) const noexcept;
+};
+
+// Delay before another attempt at a batch that failed to send failures
+// times in a row: 100 ms, doubling up to 5 s.
+std::chrono::milliseconds retry_delay(unsigned failures) noexcept;
+
+// Accumulates the framed records of one input across reads into one Batch,
+// until it is full or has lingered long enough.
+//
+// A batch only ever holds records of one file generation, in offset order,
+// so commit_end_offset (the end of the last record) stays a safe checkpoint
+// exactly as for a single read. Payloads are copied into the batch arena
+// and count against the memory budget until the batch is sent. A batch
+// that failed to send is kept whole, under the same id, for a retry.
+class BatchBuilder {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  // Result of append().
+  enum class Append {
+    Ok,
+    SendFailed, // send() returned false; stop reading this input for now
+    Discarded   // the chunk's mapping was truncated; its records were dropped
+  };
+
+  void set_limits(const BatchLimits &limits) noexcept { limits_ = limits; }
+
+  // True if records of (id, generation) may join the open batch: it is
+  // empty or holds the same file generation.
+  bool accepts(const logiq::file::FileIdentity &id,
+               std::uint64_t generation) const noexcept;
+
+  // True if a record with payload_bytes still fits (an empty batch takes
+  // any record, so oversized records go out alone). A held batch takes no
+  // more, so a retry resends exactly what failed.
+  bool fits(std::size_t payload_bytes) const noexcept;
+
+  // Append a copy of rec. The first record opens the batch and starts the
+  // linger clock.
+  void add(const logiq::framing::FramedRecord &rec,
+           const logiq::file::FileIdentity &id, std::uint64_t generation,
+           Clock::time_point now);
+
+  // Open and either full or past its linger time, or held and past its
+  // retry time: ship it now.
+  bool due(Clock::time_point now) const noexcept;
+
+  // When an open batch becomes due through lingering, or its retry.
+  Clock::time_point deadline() const noexcept {
+    return std::max(opened_ + limits_.linger, retry_at_);
+  }
+
+  // Sending the batch failed: keep it and hold it back for retry_delay().
+  void hold(Clock::time_point now) noexcept;
+
+  // A send of the batch failed (whether or not its retry is due yet).
+  bool held() const noexcept { return failures_ > 0; }
+
+  // Held and its retry not yet due.
+  bool waiting(Clock::time_point now) const noexcept {
+    return held() && now < retry_at_;
+  }
+
+  bool empty() const noexcept { return batch_.records.empty(); }
+  std::size_t size() const noexcept { return batch_.records.size(); }
+
+  // Drop all records after the first keep (e.g. those read from a mapping
+  // that turned out to be truncated).
+  void truncate(std::size_t keep);
+
+  // Add the records framed from chunk, calling send() whenever the batch
+  // cannot take the next record and once more if it is due afterwards.
+  // send() must ship and clear the batch, or hold() it and return false.
+  // On SendFailed the records of chunk not added to the batch are
+  // dropped, and the caller must read them again (see resend_from()).
+  //
+  // A mapped chunk whose file was truncated underneath reads as zeros: it
+  // is checked before anything copied from it is sent, and on Discarded its
+  // records are gone and the caller must reset its framer (the next poll()
+  // sees the truncate and starts a new generation).
+  template <typename Send>
+  Append append(const std::vector<logiq::framing::FramedRecord> &records,
+                const logiq::file::ReadChunk &chunk, Clock::time_point now,
+                Send &&send) {
+    if (records.empty())
+      return Append::Ok;
+
+    // A batch holds one file generation only; ship the old one first.
+    if (!accepts(chunk.id, chunk.generation) && !send())
+      return Append::SendFailed;
+
+    std::size_t first = size(); // first record of this chunk
+    auto intact = [&] {
+      if (logiq::file::FileFollower::chunk_intact(chunk))
+        return true;
+      truncate(first);
+      return false;
+    };
+
+    // Payloads are copied into the batch arena, records land in the reused
+    // vector, so steady state allocates nothing.
+    for (const auto &r : records) {
+      if (!fits(r.payload.size())) {
+        if (!intact())
+          return Append::Discarded;
+        if (!send())
+          return Append::SendFailed;
+        first = 0;
+      }
+      add(r, chunk.id, chunk.generation, now);
+    }
+
+    if (!intact())
+      return Append::Discarded;
+    if (due(now) && !send())
+      return Append::SendFailed;
+    return Append::Ok;
+  }
+
+  // File offset (in chunk's file generation) where the records of chunk
+  // that a failed append() dropped begin.
+  std::uint64_t resend_from(
+      const std::vector<logiq::framing::FramedRecord> &records,
+      const logiq::file::ReadChunk &chunk) const noexcept;
+
+  logiq::Batch &batch() noexcept { return batch_; }
+
+  // Hand the batch over (e.g. to another thread) and start an empty one.
+  logiq::Batch take() {
+    logiq::Batch out = std::move(batch_);
+    clear();
+    return out;
+  }
+
+  // Forget the batch (after it was sent); keeps its memory.
+  void clear() noexcept {
+    batch_.clear();
+    memory_.set(0);
+    failures_ = 0;
+    retry_at_ = {};
+  }
+
+private:
+  BatchLimits limits_;
+  logiq::Batch batch_;
+  Clock::time_point opened_{};
+  unsigned failures_{0}; // failed sends of batch_ in a row
+  Clock::time_point retry_at_{};
+  logiq::utils::MemoryCharge memory_{logiq::utils::MemoryStage::Batch};
+};
+
+} // namespace logiq::core
@@ -0,0 +1,47 @@
+#include "core/CommitTracker.hpp"
+#include "utils/Logger.hpp"
+
+#include <string>
+
+namespace logiq::core {
+
+void CommitTracker::resolve(std::uint64_t seq,
+                            const logiq::file::FileIdentity &id,
+                            std::uint64_t generation, std::uint64_t end,
+                            bool ok, std::vector<Advance> &out) {
+  if (seq < next_)
+    return; // resolved already
+  const Result r{id, generation, end, ok};
+  if (seq != next_) {
+    early_.emplace(seq, r);
+    return;
+  }
+
+  apply(r, out);
+  ++next_;
+  for (auto it = early_.begin(); it != early_.end() && it->first == next_;
+       it = early_.erase(it)) {
+    apply(it->second, out);
+    ++next_;
+  }
+}
+
+void CommitTracker::apply(const Result &r, std::vector<Advance> &out) {
+  if (failed_) {
+    if (failed_->id == r.id && failed_->generation == r.generation)
+      return; // past the gap
+    failed_.reset(); // that generation is retired
+  }
+  if (!r.ok) {
+    failed_ = Key{r.id, r.generation};
+    logiq::utils::Logger::warn(
+        "Batch " + std::to_string(next_) + " of file " +
+        std::to_string(r.id.dev) + ":" + std::to_string(r.id.ino) +
+        " generation " + std::to_string(r.generation) +
+        " failed; not committing that generation any further");
+    return;
+  }
+  out.push_back({r.id, r.generation, r.end});
+}
+
+} // namespace logiq::core
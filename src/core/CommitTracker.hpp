@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <vector>
+
+#include "file/FileIdentity.hpp"
+
+namespace logiq::core {
+
+// Turns out-of-order batch results into checkpoint advances.
+//
+// The batches of one input are numbered n, n+1, ... in the order they were
+// cut, which is file offset order within each file generation. A result is
+// applied only once every earlier batch has been resolved, so the commit
+// point of a file generation (dev, ino, generation) only ever moves to the
+// end of a contiguous run of ACKed batches.
+//
+// Senders retry a batch until it is ACKed, so a failed result only comes
+// from a send given up on at shutdown. It leaves a gap: its file generation
+// stops committing (later ACKs for it are ignored rather than committing
+// past unsent data, which is reshipped after a restart). The gap is dropped
+// once a result of another file generation arrives: an input never goes
+// back to one it has left.
+class CommitTracker {
+public:
+  struct Advance {
+    logiq::file::FileIdentity id{};
+    std::uint64_t generation{0};
+    std::uint64_t offset{0}; // new committed offset
+  };
+
+  // Batches are numbered from first.
+  explicit CommitTracker(std::uint64_t first = 0) : next_(first) {}
+
+  // Resolve batch seq, which covers file bytes up to end of (id,
+  // generation). Appends the advances this makes possible, in order.
+  void resolve(std::uint64_t seq, const logiq::file::FileIdentity &id,
+               std::uint64_t generation, std::uint64_t end, bool ok,
+               std::vector<Advance> &out);
+
+  // Results waiting for an earlier batch.
+  std::size_t pending() const noexcept { return early_.size(); }
+
+private:
+  struct Result {
+    logiq::file::FileIdentity id{};
+    std::uint64_t generation{0};
+    std::uint64_t end{0};
+    bool ok{false};
+  };
+
+  void apply(const Result &r, std::vector<Advance> &out);
+
+  std::uint64_t next_{0}; // first unresolved batch
+  std::map<std::uint64_t, Result> early_;
+
+  // The file generation with a failed batch, if any.
+  struct Key {
+    logiq::file::FileIdentity id{};
+    std::uint64_t generation{0};
+  };
+  std::optional<Key> failed_;
+};
+
+} // namespace logiq::core
@@ -0,0 +1,158 @@
+#include "core/InputTable.hpp"
+
+namespace logiq::core {
+
+FileInput::FileInput(std::uint64_t id, std::string path,
+                     logiq::file::FileFollower::Options opt, bool is_literal,
+                     std::uint64_t first_batch)
+    : slot(id), literal(is_literal), follower(std::move(path), opt),
+      commits(first_batch), next_batch(first_batch) {}
+
+FileInput &InputTable::add(std::string path,
+                           logiq::file::FileFollower::Options opt,
+                           bool literal) {
+  std::uint64_t slot;
+  if (!free_slots_.empty()) {
+    slot = free_slots_.back();
+    free_slots_.pop_back();
+  } else {
+    slot = slots_.size();
+    slots_.emplace_back();
+    next_batch_.push_back(0);
+  }
+
+  by_path_[path] = slot;
+  slots_[slot] = std::make_unique<FileInput>(slot, std::move(path), opt,
+                                             literal, next_batch_[slot]);
+  return *slots_[slot];
+}
+
+void InputTable::remove(std::uint64_t slot) {
+  FileInput *in = get(slot);
+  if (!in)
+    return;
+
+  lru_remove(*in);
+  by_path_.erase(in->follower.path());
+
+  auto it = by_id_.find(in->key);
+  if (it != by_id_.end() && it->second == slot)
+    by_id_.erase(it);
+
+  next_batch_[slot] = in->next_batch;
+  slots_[slot].reset();
+  free_slots_.push_back(slot);
+}
+
+FileInput *InputTable::get(std::uint64_t slot) noexcept {
+  if (slot >= slots_.size())
+    return nullptr;
+  return slots_[slot].get();
+}
+
+FileInput *InputTable::find_path(const std::string &path) noexcept {
+  auto it = by_path_.find(path);
+  return it == by_path_.end() ? nullptr : get(it->second);
+}
+
+FileInput *InputTable::find_id(const logiq::file::FileIdentity &id) noexcept {
+  auto it = by_id_.find(id);
+  return it == by_id_.end() ? nullptr : get(it->second);
+}
+
+void InputTable::rekey(FileInput &in) {
+  const auto id = in.follower.active_id();
+  if (id == in.key)
+    return;
+
+  auto it = by_id_.find(in.key);
+  if (it != by_id_.end() && it->second == in.slot)
+    by_id_.erase(it);
+
+  in.key = id;
+  by_id_[id] = in.slot;
+}
+
+void InputTable::touch(FileInput &in, Clock::time_point now) {
+  in.last_active = now;
+
+  if (!in.follower.has_fd()) {
+    lru_remove(in);
+    return;
+  }
+
+  if (in.in_lru) {
+    lru_.splice(lru_.begin(), lru_, in.lru_pos);
+  } else {
+    lru_.push_front(in.slot);
+    in.in_lru = true;
+  }
+  in.lru_pos = lru_.begin();
+}
+
+void InputTable::lru_remove(FileInput &in) {
+  if (!in.in_lru)
+    return;
+  lru_.erase(in.lru_pos);
+  in.in_lru = false;
+}
+
+std::size_t InputTable::enforce_limits(std::size_t max_open,
+                                       std::chrono::milliseconds idle,
+                                       Clock::time_point now) {
+  std::size_t suspended = 0;
+
+  // Walk from least to most recently active; stop at the first follower
+  // that is neither over the cap nor idle.
+  auto it = lru_.end();
+  while (it != lru_.begin()) {
+    --it;
+    FileInput *in = get(*it);
+    if (!in)
+      continue;
+
+    const bool over_cap = max_open > 0 && lru_.size() > max_open;
+    const bool is_idle = idle.count() > 0 && now - in->last_active >= idle;
+    if (!over_cap && !is_idle)
+      break;
+
+    if (in->follower.settling())
+      continue;
+
+    // Erasing invalidates only the erased node; step past it first.
+    auto victim = it++;
+    in->follower.suspend();
+    lru_.erase(victim);
+    in->in_lru = false;
+    suspended++;
+  }
+
+  return suspended;
+}
+
+void InputTable::retire(const logiq::file::FileIdentity &id, Retired r) {
+  retired_[id] = r;
+}
+
+std::optional<InputTable::Retired>
+InputTable::take_retired(const logiq::file::FileIdentity &id) {
+  auto it = retired_.find(id);
+  if (it == retired_.end())
+    return std::nullopt;
+  Retired r = it->second;
+  retired_.erase(it);
+  return r;
+}
+
+void InputTable::prune_retired(
+    const std::unordered_set<logiq::file::FileIdentity> &live) {
+  for (auto it = retired_.begin(); it != retired_.end();) {
+    if (live.count(it->first)) {
+      ++it;
+    } else {
+      it = retired_.erase(it);
+    }
+  }
+}
+
+} // namespace logiq::core
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "core/BatchBuilder.hpp"
+#include "core/CommitTracker.hpp"
+#include "file/FileFollower.hpp"
+#include "file/FileIdentity.hpp"
+#include "framing/AnyFramer.hpp"
+#include "utils/MemoryBudget.hpp"
+
+namespace logiq::core {
+
+// Per-file pipeline state: follower, framer, open batch and commit position.
+struct FileInput {
+  FileInput(std::uint64_t id, std::string path,
+            logiq::file::FileFollower::Options opt, bool is_literal,
+            std::uint64_t first_batch);
+
+  // Stable handle; also used as the FileWatcher token.
+  std::uint64_t slot;
+
+  // Configured literal path (kept in the table even while missing), as
+  // opposed to a path found by a glob pattern.
+  bool literal;
+
+  logiq::file::FileFollower follower;
+  logiq::framing::AnyFramer framer;
+  // framer's buffers, as of the end of the last pass.
+  logiq::utils::MemoryCharge framer_memory;
+  BatchBuilder batcher; // framed records not yet shipped
+  // Chunk read but not yet accepted by the staged runtime (backpressure).
+  std::optional<logiq::file::ReadChunk> stalled;
+  // Reading stopped during the last pass: the runtime pushed back (queue
+  // or in-flight window full) or the memory budget was exhausted.
+  bool throttled{false};
+  std::uint64_t committed_offset{0};
+  // Inline sends: numbers batches and holds commits back past a failure.
+  // Numbering continues from the slot's previous input (see Batch::set_id).
+  CommitTracker commits;
+  std::uint64_t next_batch{0};
+
+  // Identity under which the table indexes this input ({0,0} while the file
+  // has never been opened).
+  logiq::file::FileIdentity key{};
+
+  // Scheduling state owned by Agent.
+  bool queued{false}; // in the ready queue
+  bool polled{false}; // inotify not trusted for this path
+  bool seen{false};   // matched by the current discovery scan
+
+  // Open-fd LRU bookkeeping owned by InputTable.
+  std::chrono::steady_clock::time_point last_active{};
+  std::list<std::uint64_t>::iterator lru_pos{};
+  bool in_lru{false};
+};
+
+// Table of followed files, keyed by slot, path and FileIdentity.
+//
+// All lookups are O(1) and the table never scans itself on the hot path, so
+// per-event cost does not depend on how many files are followed. It also
+// enforces an open-fd cap: open followers are kept in LRU order and the
+// least recently active ones are suspended (fd closed, offset kept) when the
+// cap is exceeded or they have been idle too long.
+class InputTable {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  // Position left behind by a follower that moved on to a rotated file.
+  struct Retired {
+    std::uint64_t committed_offset{0};
+    std::uint64_t generation{0};
+  };
+
+  FileInput &add(std::string path, logiq::file::FileFollower::Options opt,
+                 bool literal);
+  void remove(std::uint64_t slot);
+
+  FileInput *get(std::uint64_t slot) noexcept;
+  FileInput *find_path(const std::string &path) noexcept;
+  FileInput *find_id(const logiq::file::FileIdentity &id) noexcept;
+
+  // Re-index in after its follower opened or switched to another inode.
+  void rekey(FileInput &in);
+
+  // Record activity; keeps the open-fd LRU in sync with the follower.
+  void touch(FileInput &in, Clock::time_point now);
+
+  // Suspend followers idle for longer than idle (0 disables) and the least
+  // recently active ones while more than max_open fds are open. Followers
+  // waiting for a rotation to settle are never suspended.
+  // Returns the number of suspended followers.
+  std::size_t enforce_limits(std::size_t max_open,
+                             std::chrono::milliseconds idle,
+                             Clock::time_point now);
+
+  // Remember where a rotated-away inode was committed, so that discovering
+  // it under a new name (app.log -> app.log.1) resumes instead of reshipping.
+  void retire(const logiq::file::FileIdentity &id, Retired r);
+  std::optional<Retired> take_retired(const logiq::file::FileIdentity &id);
+
+  // Forget retired identities that no longer exist on disk.
+  void
+  prune_retired(const std::unordered_set<logiq::file::FileIdentity> &live);
+
+  template <typename F> void for_each(F &&f) {
+    for (auto &in : slots_) {
+      if (in)
+        f(*in);
+    }
+  }
+
+  std::size_t size() const noexcept { return by_path_.size(); }
+  std::size_t open_fds() const noexcept { return lru_.size(); }
+
+private:
+  std::vector<std::unique_ptr<FileInput>> slots_;
+  std::vector<std::uint64_t> free_slots_;
+  // Per slot: the batch number its next input starts from, so batch ids
+  // (<slot>-<number>) are not reused when the slot is.
+  std::vector<std::uint64_t> next_batch_;
+
+  std::unordered_map<std::string, std::uint64_t> by_path_;
+  std::unordered_map<logiq::file::FileIdentity, std::uint64_t> by_id_;
+  std::unordered_map<logiq::file::FileIdentity, Retired> retired_;
+
+  // Slots with an open fd, most recently active first.
+  std::list<std::uint64_t> lru_;
+
+private:
+  void lru_remove(FileInput &in);
+};
+
+} // namespace logiq::core
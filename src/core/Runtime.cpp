@@ -0,0 +1,409 @@
+#include "core/Runtime.hpp"
+#include "utils/Logger.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace logiq::core {
+
+namespace {
+
+// Upper bound on any sleep, as a safety net; doorbells normally wake
+// threads as soon as there is something to do.
+constexpr std::chrono::milliseconds kMaxSleep{100};
+
+} // namespace
+
+template <typename Queue, typename T>
+void Runtime::push_wait(Channel<Queue> &ch, T &value) {
+  while (!ch.queue.try_push(value)) {
+    // Backpressure: sleep until the consumer pops something.
+    const auto seen = ch.space.epoch();
+    if (ch.queue.try_push(value))
+      break;
+    ch.space.wait(seen, Clock::now() + kMaxSleep);
+  }
+  ch.ready.ring();
+}
+
+Runtime::Runtime(const Options &opt, Sink &sink, Configure configure)
+    : opt_(opt), sink_(sink), configure_(std::move(configure)),
+      results_(opt.queue_depth) {
+  opt_.workers = std::max<std::size_t>(opt_.workers, 1);
+  opt_.senders = std::max<std::size_t>(opt_.senders, 1);
+
+  committer_ = std::thread([this] { run_committer(); });
+  for (std::size_t i = 0; i < opt_.senders; ++i) {
+    auto &s = *senders_.emplace_back(
+        std::make_unique<Sender>(opt_.queue_depth));
+    s.thread = std::thread([this, &s] { run_sender(s); });
+  }
+  for (std::size_t i = 0; i < opt_.workers; ++i) {
+    auto &w = *workers_.emplace_back(
+        std::make_unique<Worker>(opt_.queue_depth));
+    w.next_sender = i % opt_.senders;
+    w.thread = std::thread([this, &w] { run_worker(w); });
+  }
+}
+
+Runtime::~Runtime() { stop(); }
+
+bool Runtime::try_submit(std::uint64_t slot, const std::string &path,
+                         logiq::file::ReadChunk &chunk) {
+  auto &w = *workers_[slot % workers_.size()];
+
+  FrameTask task;
+  task.kind = FrameTask::Kind::Chunk;
+  task.slot = slot;
+  bool first;
+  {
+    std::lock_guard<std::mutex> lock(streams_mutex_);
+    first = !streams_.contains(slot);
+  }
+  if (first)
+    task.stream = std::make_shared<Stream>(path);
+  task.chunk = std::move(chunk);
+  task.memory.set(task.chunk.data.size());
+
+  std::shared_ptr<Stream> stream = task.stream; // try_push moves it
+  if (!w.inbox.queue.try_push(task)) {
+    chunk = std::move(task.chunk); // the charge goes with task
+    return false;
+  }
+  w.inbox.ready.ring();
+  if (first) {
+    std::lock_guard<std::mutex> lock(streams_mutex_);
+    streams_.emplace(slot, std::move(stream));
+  }
+  return true;
+}
+
+bool Runtime::window_full(std::uint64_t slot) const {
+  if (opt_.max_in_flight == 0)
+    return false;
+  std::lock_guard<std::mutex> lock(streams_mutex_);
+  auto it = streams_.find(slot);
+  return it != streams_.end() &&
+         it->second->in_flight.load(std::memory_order_relaxed) >=
+             opt_.max_in_flight;
+}
+
+void Runtime::push_control(FrameTask &task) {
+  push_wait(workers_[task.slot % workers_.size()]->inbox, task);
+}
+
+void Runtime::flush(std::uint64_t slot, logiq::file::FileIdentity id,
+                    std::uint64_t generation) {
+  FrameTask task;
+  task.kind = FrameTask::Kind::Flush;
+  task.slot = slot;
+  task.chunk.id = id;
+  task.chunk.generation = generation;
+  push_control(task);
+}
+
+void Runtime::reset(std::uint64_t slot, logiq::file::FileIdentity id,
+                    std::uint64_t generation) {
+  FrameTask task;
+  task.kind = FrameTask::Kind::Reset;
+  task.slot = slot;
+  task.chunk.id = id;
+  task.chunk.generation = generation;
+  push_control(task);
+}
+
+void Runtime::close(std::uint64_t slot) {
+  {
+    std::lock_guard<std::mutex> lock(streams_mutex_);
+    if (!streams_.erase(slot))
+      return; // its worker never heard of it
+  }
+  FrameTask task;
+  task.kind = FrameTask::Kind::Close;
+  task.slot = slot;
+  push_control(task);
+}
+
+void Runtime::take_commits(std::vector<CommitNotice> &out) {
+  std::lock_guard<std::mutex> lock(commits_mutex_);
+  out.insert(out.end(), commits_.begin(), commits_.end());
+  commits_.clear();
+}
+
+void Runtime::stop() {
+  if (stopped_)
+    return;
+  stopped_ = true;
+
+  // Stop stage by stage, so each one drains what the previous one left.
+  stop_workers_ = true;
+  for (auto &w : workers_)
+    w->inbox.ready.ring();
+  // Senders waiting to retry a batch give up on it now.
+  for (auto &s : senders_)
+    s->inbox.ready.ring();
+  for (auto &w : workers_)
+    w->thread.join();
+
+  stop_senders_ = true;
+  for (auto &s : senders_)
+    s->inbox.ready.ring();
+  for (auto &s : senders_)
+    s->thread.join();
+
+  stop_committer_ = true;
+  results_.ready.ring();
+  committer_.join();
+}
+
+void Runtime::run_worker(Worker &w) {
+  FrameTask task;
+  while (true) {
+    const auto seen = w.inbox.ready.epoch();
+    const bool stopping = stop_workers_.load();
+
+    bool busy = false;
+    while (w.inbox.queue.try_pop(task)) {
+      w.inbox.space.ring();
+      handle(w, task);
+      task = FrameTask(); // let go of the chunk's buffer
+      busy = true;
+    }
+
+    if (stopping) {
+      const auto now = Clock::now();
+      for (auto &[slot, pipe] : w.pipes)
+        flush_pipe(w, slot, pipe, now, true);
+      return;
+    }
+
+    const auto next = service(w, Clock::now());
+    if (!busy)
+      w.inbox.ready.wait(seen, std::min(next, Clock::now() + kMaxSleep));
+  }
+}
+
+void Runtime::handle(Worker &w, FrameTask &task) {
+  const auto slot = task.slot;
+  auto it = w.pipes.find(slot);
+
+  if (task.kind == FrameTask::Kind::Chunk) {
+    if (it == w.pipes.end()) {
+      it = w.pipes.try_emplace(slot).first;
+      configure_(it->second.framer, it->second.batcher);
+      it->second.stream = std::move(task.stream);
+    }
+    auto &pipe = it->second;
+    const auto &chunk = task.chunk;
+    pipe.id = chunk.id;
+    pipe.generation = chunk.generation;
+    pipe.framer.visit([&](auto &framer) {
+      framer.ingest(chunk.data, chunk.start_offset);
+      ship(w, slot, pipe, framer.drain(), chunk);
+    });
+    pipe.framer_memory.set(pipe.framer.buffered_bytes());
+    if (pipe.framer.pending() || !pipe.batcher.empty())
+      w.timed.insert(slot);
+    return;
+  }
+
+  if (it == w.pipes.end())
+    return; // nothing was ever read for it
+  auto &pipe = it->second;
+
+  // Held-back records belong to the file the reader names, not to whatever
+  // the last chunk came from.
+  if (task.kind != FrameTask::Kind::Close) {
+    pipe.id = task.chunk.id;
+    pipe.generation = task.chunk.generation;
+  }
+  flush_pipe(w, slot, pipe, Clock::now(), true);
+
+  switch (task.kind) {
+  case FrameTask::Kind::Reset:
+    pipe.framer.reset();
+    pipe.framer_memory.set(0);
+    break;
+  case FrameTask::Kind::Close:
+    w.timed.erase(slot);
+    w.pipes.erase(it);
+    break;
+  default:
+    break;
+  }
+}
+
+void Runtime::ship(Worker &w, std::uint64_t slot, Pipe &pipe,
+                   const std::vector<logiq::framing::FramedRecord> &records,
+                   const logiq::file::ReadChunk &chunk) {
+  const auto outcome =
+      pipe.batcher.append(records, chunk, Clock::now(), [&] {
+        emit(w, slot, pipe);
+        return true;
+      });
+  if (outcome == BatchBuilder::Append::Discarded) {
+    logiq::utils::Logger::warn(
+        "Discarding data read from truncated mapping: " +
+        pipe.stream->path);
+    pipe.framer.reset();
+  }
+}
+
+void Runtime::flush_pipe(Worker &w, std::uint64_t slot, Pipe &pipe,
+                         Clock::time_point now, bool force) {
+  if (pipe.framer.pending()) {
+    const auto &records = pipe.framer.flush_expired(now, force);
+    // Held-back records are copies: nothing here can be a mapped view.
+    logiq::file::ReadChunk origin;
+    origin.id = pipe.id;
+    origin.generation = pipe.generation;
+    ship(w, slot, pipe, records, origin);
+  }
+  if (!pipe.batcher.empty() && (force || pipe.batcher.due(now)))
+    emit(w, slot, pipe);
+}
+
+void Runtime::emit(Worker &w, std::uint64_t slot, Pipe &pipe) {
+  if (pipe.batcher.empty())
+    return;
+
+  SendTask task;
+  task.slot = slot;
+  task.seq = w.next_seq[slot]++;
+  task.stream = pipe.stream;
+  task.stream->in_flight.fetch_add(1, std::memory_order_relaxed);
+  task.body = sink_.serialize(pipe.batcher.batch());
+  task.batch = pipe.batcher.take();
+  task.batch.set_id(slot, task.seq);
+  task.memory.set(task.batch.bytes + task.body.size());
+  dispatch(w, task);
+}
+
+void Runtime::dispatch(Worker &w, SendTask &task) {
+  // Round-robin, skipping senders whose queue is full; wait only if all
+  // of them are.
+  const std::size_t n = senders_.size();
+  for (std::size_t i = 0; i < n; ++i) {
+    auto &s = *senders_[(w.next_sender + i) % n];
+    if (s.inbox.queue.try_push(task)) {
+      s.inbox.ready.ring();
+      w.next_sender = (w.next_sender + i + 1) % n;
+      return;
+    }
+  }
+  push_wait(senders_[w.next_sender]->inbox, task);
+  w.next_sender = (w.next_sender + 1) % n;
+}
+
+Runtime::Clock::time_point Runtime::service(Worker &w,
+                                            Clock::time_point now) {
+  const bool shed = logiq::utils::MemoryBudget::instance().paused();
+  auto next = Clock::time_point::max();
+  for (auto it = w.timed.begin(); it != w.timed.end();) {
+    auto &pipe = w.pipes.at(*it);
+    flush_pipe(w, *it, pipe, now, false);
+    if (shed)
+      emit(w, *it, pipe);
+    pipe.framer_memory.set(pipe.framer.buffered_bytes());
+
+    if (!pipe.framer.pending() && pipe.batcher.empty()) {
+      it = w.timed.erase(it);
+      continue;
+    }
+    if (pipe.framer.pending())
+      next = std::min(next, now + opt_.tick);
+    if (!pipe.batcher.empty())
+      next = std::min(next, pipe.batcher.deadline());
+    ++it;
+  }
+  return next;
+}
+
+void Runtime::run_sender(Sender &s) {
+  SendTask task;
+  while (true) {
+    const auto seen = s.inbox.ready.epoch();
+    const bool stopping = stop_senders_.load();
+
+    if (!s.inbox.queue.try_pop(task)) {
+      if (stopping)
+        return;
+      s.inbox.ready.wait(seen, Clock::now() + kMaxSleep);
+      continue;
+    }
+    s.inbox.space.ring();
+
+    SendOutcome out;
+    out.slot = task.slot;
+    out.seq = task.seq;
+    out.stream = std::move(task.stream);
+    const auto &batch = task.batch;
+    out.id = {batch.file_dev, batch.file_ino};
+    out.generation = batch.file_generation;
+    out.commit_end = batch.commit_end_offset;
+    out.result = sink_.send_serialized(batch, task.body);
+    // Retry within the input's in-flight window, which keeps it from
+    // reading further ahead meanwhile. Only a stop gives up on a batch.
+    for (unsigned failures = 1; !out.result.ok && !stop_workers_.load();
+         ++failures) {
+      const auto delay = retry_delay(failures);
+      logiq::utils::Logger::warn(
+          "Send failed for " + out.stream->path + ": " +
+          out.result.message + "; retrying in " +
+          std::to_string(delay.count()) + " ms");
+      const auto until = Clock::now() + delay;
+      while (true) {
+        const auto seen = s.inbox.ready.epoch();
+        if (stop_workers_.load() || Clock::now() >= until)
+          break;
+        s.inbox.ready.wait(seen, until);
+      }
+      if (stop_workers_.load())
+        break;
+      out.result = sink_.send_serialized(batch, task.body);
+    }
+    task = SendTask(); // the batch arena goes back to the pool
+
+    push_wait(results_, out);
+  }
+}
+
+void Runtime::run_committer() {
+  // Per slot; batch numbers continue across reuse of a slot.
+  std::unordered_map<std::uint64_t, CommitTracker> trackers;
+  std::vector<CommitTracker::Advance> advances;
+
+  SendOutcome out;
+  while (true) {
+    const auto seen = results_.ready.epoch();
+    const bool stopping = stop_committer_.load();
+
+    if (!results_.queue.try_pop(out)) {
+      if (stopping)
+        return;
+      results_.ready.wait(seen, Clock::now() + kMaxSleep);
+      continue;
+    }
+    results_.space.ring();
+
+    if (!out.result.ok) {
+      logiq::utils::Logger::warn("Send failed for " + out.stream->path +
+                                 ": " + out.result.message);
+    }
+
+    advances.clear();
+    trackers[out.slot].resolve(out.seq, out.id, out.generation,
+                               out.commit_end, out.result.ok, advances);
+    if (!advances.empty()) {
+      std::lock_guard<std::mutex> lock(commits_mutex_);
+      for (const auto &a : advances)
+        commits_.push_back({out.slot, a.id, a.generation, a.offset});
+    }
+
+    // Resolved: the reader may read more of this input.
+    out.stream->in_flight.fetch_sub(1, std::memory_order_relaxed);
+    out = SendOutcome();
+  }
+}
+
+} // namespace logiq::core
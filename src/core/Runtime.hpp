@@ -0,0 +1,245 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "core/BatchBuilder.hpp"
+#include "core/CommitTracker.hpp"
+#include "file/FileFollower.hpp"
+#include "file/FileIdentity.hpp"
+#include "framing/AnyFramer.hpp"
+#include "sinks/HttpNdjsonSink.hpp"
+#include "utils/Doorbell.hpp"
+#include "utils/MemoryBudget.hpp"
+#include "utils/MpscQueue.hpp"
+
+namespace logiq::core {
+
+// A checkpoint advance reported by the committer.
+struct CommitNotice {
+  std::uint64_t slot{0};
+  logiq::file::FileIdentity id{};
+  std::uint64_t generation{0};
+  std::uint64_t commit_end{0};
+};
+
+// Staged pipeline behind Agent when runtime.workers > 0:
+//
+//   readers --MPSC--> framing workers --MPSC--> senders --MPSC--> committer
+//      ^                                                              |
+//      +------------------------ commit notices ----------------------+
+//
+// Readers (Agent's loop and its scheduler threads) keep polling and reading
+// files. Each input is pinned to one worker, which
+// frames its chunks, fills its batch, serializes it and hands it to the
+// senders; senders call the sink concurrently. The single committer puts
+// the results back in per-input order (CommitTracker) and advances an
+// input's checkpoint only across a contiguous run of ACKed batches. Up to
+// max_in_flight batches per input may be out at once, hiding sink latency.
+//
+// Every queue is bounded. A full queue blocks the stage pushing into it,
+// except the reader: try_submit() fails and the reader keeps the chunk and
+// stops reading that file, as it does while the file's in-flight window is
+// full, so a slow sink throttles reading instead of stopping the agent or
+// growing memory. Commit notices go back through an
+// unbounded list the reader drains, so the committer never waits and the
+// cycle cannot deadlock.
+class Runtime {
+public:
+  using Clock = std::chrono::steady_clock;
+  using Sink = logiq::sinks::HttpNdjsonSink;
+
+  struct Options {
+    std::size_t workers{1};
+    std::size_t senders{1};
+    std::size_t queue_depth{1024}; // messages per queue
+    // Batches per input sent but not resolved before reading pauses; 0 =
+    // unlimited.
+    std::size_t max_in_flight{0};
+    // How often workers check held-back multiline records for timeouts.
+    std::chrono::milliseconds tick{200};
+  };
+
+  // Sets up the framer and batcher of a new input; runs on a worker.
+  using Configure =
+      std::function<void(logiq::framing::AnyFramer &, BatchBuilder &)>;
+
+  // sink must outlive the Runtime.
+  Runtime(const Options &opt, Sink &sink, Configure configure);
+  ~Runtime();
+
+  Runtime(const Runtime &) = delete;
+  Runtime &operator=(const Runtime &) = delete;
+
+  // Reader side: any thread, but calls for one slot must not overlap (the
+  // worker sees them in the order they returned). close() and
+  // take_commits() belong to the thread that created the Runtime.
+
+  // Hand a chunk read from input slot (at path) to its worker. Returns
+  // false, leaving chunk untouched, if the worker's queue is full.
+  bool try_submit(std::uint64_t slot, const std::string &path,
+                  logiq::file::ReadChunk &chunk);
+
+  // True if slot has max_in_flight batches out; read nothing more from it
+  // until this turns false.
+  bool window_full(std::uint64_t slot) const;
+
+  // Ship what the worker holds for slot from file (id, generation): a
+  // held-back multiline record and the open batch. Waits for queue space.
+  void flush(std::uint64_t slot, logiq::file::FileIdentity id,
+             std::uint64_t generation);
+
+  // flush(), then drop the input's framing state (truncate, rotation).
+  void reset(std::uint64_t slot, logiq::file::FileIdentity id,
+             std::uint64_t generation);
+
+  // Ship what is held for slot and forget the input.
+  void close(std::uint64_t slot);
+
+  // Append the checkpoint advances made since the last call, in order.
+  void take_commits(std::vector<CommitNotice> &out);
+
+  // Ship everything still held, drain every stage and join the threads.
+  // Called by the destructor; later calls do nothing.
+  void stop();
+
+private:
+  // Shared by every stage handling one input, until the input is closed
+  // and its last batch resolved.
+  struct Stream {
+    explicit Stream(std::string p) : path(std::move(p)) {}
+    const std::string path;
+    // Batches cut by the worker and not yet resolved by the committer.
+    std::atomic<std::uint32_t> in_flight{0};
+  };
+
+  // Reader -> worker.
+  struct FrameTask {
+    enum class Kind : std::uint8_t { Chunk, Flush, Reset, Close };
+    Kind kind{Kind::Chunk};
+    std::uint64_t slot{0};
+    std::shared_ptr<Stream> stream; // set on the first task for a slot
+    // Flush/Reset: only id and generation are set.
+    logiq::file::ReadChunk chunk;
+    logiq::utils::MemoryCharge memory{logiq::utils::MemoryStage::Queued};
+  };
+
+  // Worker -> sender.
+  struct SendTask {
+    std::uint64_t slot{0};
+    std::uint64_t seq{0}; // per slot
+    std::shared_ptr<Stream> stream;
+    logiq::Batch batch;
+    std::string body; // serialized batch
+    // Until the send completes.
+    logiq::utils::MemoryCharge memory{logiq::utils::MemoryStage::Queued};
+  };
+
+  // Sender -> committer.
+  struct SendOutcome {
+    std::uint64_t slot{0};
+    std::uint64_t seq{0};
+    std::shared_ptr<Stream> stream;
+    logiq::file::FileIdentity id{};
+    std::uint64_t generation{0};
+    std::uint64_t commit_end{0};
+    logiq::SendResult result;
+  };
+
+  template <typename Queue> struct Channel {
+    explicit Channel(std::size_t depth) : queue(depth) {}
+    Queue queue;
+    logiq::utils::Doorbell ready; // rung after a push
+    logiq::utils::Doorbell space; // rung after a pop
+  };
+
+  // Framing state of one input, owned by its worker.
+  struct Pipe {
+    logiq::framing::AnyFramer framer;
+    logiq::utils::MemoryCharge framer_memory;
+    BatchBuilder batcher;
+    std::shared_ptr<Stream> stream;
+    // File of the last chunk, i.e. of any record held back.
+    logiq::file::FileIdentity id{};
+    std::uint64_t generation{0};
+  };
+
+  struct Worker {
+    explicit Worker(std::size_t depth) : inbox(depth) {}
+    Channel<logiq::utils::MpscQueue<FrameTask>> inbox;
+    std::unordered_map<std::uint64_t, Pipe> pipes;
+    // Next batch number per slot. Kept when an input is closed: InputTable
+    // reuses slots, and the committer orders results by (slot, number).
+    std::unordered_map<std::uint64_t, std::uint64_t> next_seq;
+    // Pipes holding a multiline record or an open batch.
+    std::unordered_set<std::uint64_t> timed;
+    std::size_t next_sender{0};
+    std::thread thread;
+  };
+
+  struct Sender {
+    explicit Sender(std::size_t depth) : inbox(depth) {}
+    Channel<logiq::utils::MpscQueue<SendTask>> inbox;
+    std::thread thread;
+  };
+
+  void run_worker(Worker &w);
+  void run_sender(Sender &s);
+  void run_committer();
+
+  // Worker side.
+  void handle(Worker &w, FrameTask &task);
+  void ship(Worker &w, std::uint64_t slot, Pipe &pipe,
+            const std::vector<logiq::framing::FramedRecord> &records,
+            const logiq::file::ReadChunk &chunk);
+  // Ship the held-back record (if timed out, or with force) and the open
+  // batch (if due, or with force).
+  void flush_pipe(Worker &w, std::uint64_t slot, Pipe &pipe,
+                  Clock::time_point now, bool force);
+  // Serialize the open batch and pass it to a sender.
+  void emit(Worker &w, std::uint64_t slot, Pipe &pipe);
+  void dispatch(Worker &w, SendTask &task);
+  // Run timers of w's pipes; returns when they next need a look. While the
+  // memory budget is spent, open batches ship without waiting.
+  Clock::time_point service(Worker &w, Clock::time_point now);
+
+  // Reader side: queue task for its worker, waiting for space.
+  void push_control(FrameTask &task);
+
+  template <typename Queue, typename T>
+  static void push_wait(Channel<Queue> &ch, T &value);
+
+  Options opt_;
+  Sink &sink_;
+  Configure configure_;
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::vector<std::unique_ptr<Sender>> senders_;
+  Channel<logiq::utils::MpscQueue<SendOutcome>> results_;
+  std::thread committer_;
+
+  // Inputs whose worker has been sent their Stream.
+  mutable std::mutex streams_mutex_;
+  std::unordered_map<std::uint64_t, std::shared_ptr<Stream>> streams_;
+
+  std::mutex commits_mutex_;
+  std::vector<CommitNotice> commits_;
+
+  // Each stage stops once its producers are joined and its queue is empty.
+  std::atomic<bool> stop_workers_{false};
+  std::atomic<bool> stop_senders_{false};
+  std::atomic<bool> stop_committer_{false};
+  bool stopped_{false};
+};
+
+} // namespace logiq::core
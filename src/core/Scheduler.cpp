@@ -0,0 +1,161 @@
+#include "core/Scheduler.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+namespace logiq::core {
+
+namespace {
+
+constexpr std::uint64_t pack(std::uint32_t begin, std::uint32_t end) {
+  return (std::uint64_t{begin} << 32) | end;
+}
+constexpr std::uint32_t begin_of(std::uint64_t b) {
+  return static_cast<std::uint32_t>(b >> 32);
+}
+constexpr std::uint32_t end_of(std::uint64_t b) {
+  return static_cast<std::uint32_t>(b);
+}
+
+// Threads sleep on doorbells; this only bounds a sleep in case of a bug.
+constexpr std::chrono::seconds kMaxSleep{1};
+
+} // namespace
+
+Scheduler::Scheduler(std::size_t threads)
+    : ranges_(std::max<std::size_t>(threads, 1)) {
+  for (std::size_t i = 1; i < ranges_.size(); ++i)
+    workers_.emplace_back([this, i] { worker_loop(i); });
+}
+
+Scheduler::~Scheduler() {
+  stop_ = true;
+  start_.ring();
+  for (auto &t : workers_)
+    t.join();
+}
+
+void Scheduler::run(std::size_t n,
+                    const std::function<void(std::size_t)> &task) {
+  if (n == 0)
+    return;
+  if (ranges_.size() == 1 || n == 1) {
+    for (std::size_t i = 0; i < n; ++i)
+      task(i);
+    return;
+  }
+
+  // No thread is inside work() now (see below), so nobody touches a range
+  // while it is dealt; workers join once remaining_ is set.
+  task_ = &task;
+
+  // Deal out even shares; thread k gets [k*n/t, (k+1)*n/t).
+  const std::size_t t = ranges_.size();
+  for (std::size_t k = 0; k < t; ++k) {
+    ranges_[k].bounds.store(
+        pack(static_cast<std::uint32_t>(k * n / t),
+             static_cast<std::uint32_t>((k + 1) * n / t)));
+  }
+  remaining_.store(n);
+  job_.fetch_add(1);
+  start_.ring();
+
+  work(0);
+
+  // Also wait for every worker to leave work(): one still stealing when
+  // the next job is dealt would overwrite a freshly dealt range with its
+  // own, and the tasks in it would never run.
+  while (true) {
+    const auto seen = done_.epoch();
+    if (remaining_.load() == 0 && active_.load() == 0)
+      break;
+    done_.wait(seen, std::chrono::steady_clock::now() + kMaxSleep);
+  }
+  task_ = nullptr;
+}
+
+void Scheduler::worker_loop(std::size_t self) {
+  std::uint64_t last_job = 0;
+  while (true) {
+    const auto seen = start_.epoch();
+    if (stop_.load())
+      return;
+    const auto job = job_.load();
+    if (job != last_job) {
+      last_job = job;
+      // Join before looking at the ranges. run() does not deal a job while
+      // a worker is active, so with tasks still outstanding the ranges
+      // read here are dealt in full; with none, the job is over (or the
+      // next one is being dealt) and there is nothing to do.
+      active_.fetch_add(1);
+      if (remaining_.load() != 0)
+        work(self);
+      if (active_.fetch_sub(1) == 1)
+        done_.ring();
+      continue;
+    }
+    start_.wait(seen, std::chrono::steady_clock::now() + kMaxSleep);
+  }
+}
+
+void Scheduler::work(std::size_t self) {
+  std::uint32_t index;
+  while (take(self, index) || steal(self, index)) {
+    (*task_)(index);
+    if (remaining_.fetch_sub(1) == 1)
+      done_.ring();
+  }
+}
+
+bool Scheduler::take(std::size_t self, std::uint32_t &index) {
+  auto &r = ranges_[self].bounds;
+  auto b = r.load();
+  while (begin_of(b) < end_of(b)) {
+    if (r.compare_exchange_weak(b, pack(begin_of(b) + 1, end_of(b)))) {
+      index = begin_of(b);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool Scheduler::steal(std::size_t self, std::uint32_t &index) {
+  const std::size_t t = ranges_.size();
+  while (true) {
+    // Pick the victim with the most tasks left.
+    std::size_t victim = t;
+    std::uint32_t most = 0;
+    for (std::size_t k = 0; k < t; ++k) {
+      if (k == self)
+        continue;
+      const auto b = ranges_[k].bounds.load();
+      const std::uint32_t left =
+          begin_of(b) < end_of(b) ? end_of(b) - begin_of(b) : 0;
+      if (left > most) {
+        most = left;
+        victim = k;
+      }
+    }
+    if (victim == t)
+      return false; // nothing left anywhere
+
+    // Take the back half (at least one task); run its first task and keep
+    // the rest as our own range. Ours is empty, so only thieves of this
+    // job look at it, and they never write an empty range (threads of an
+    // earlier job are all gone before run() deals the next).
+    auto &r = ranges_[victim].bounds;
+    auto b = r.load();
+    while (begin_of(b) < end_of(b)) {
+      const std::uint32_t left = end_of(b) - begin_of(b);
+      const std::uint32_t mid = end_of(b) - (left + 1) / 2;
+      if (r.compare_exchange_weak(b, pack(begin_of(b), mid))) {
+        index = mid;
+        ranges_[self].bounds.store(pack(mid + 1, end_of(b)));
+        return true;
+      }
+    }
+    // Someone else emptied it first; look again.
+  }
+}
+
+} // namespace logiq::core
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "utils/Doorbell.hpp"
+
+namespace logiq::core {
+
+// A fixed pool of threads that runs batches of independent tasks with work
+// stealing, e.g. the inputs that became ready in one scheduling pass.
+//
+// run() deals the tasks out as one contiguous range per thread. A thread
+// takes tasks from the front of its own range and, once that is empty,
+// steals the back half of the fullest-looking other range, so a few hot
+// inputs cannot leave the other threads idle. Ranges are single atomic
+// words: taking and stealing are one CAS each, and only runnable tasks are
+// ever touched, so cost follows the number of ready inputs rather than the
+// number of followed files.
+class Scheduler {
+public:
+  // threads includes the thread calling run().
+  explicit Scheduler(std::size_t threads);
+  ~Scheduler();
+
+  Scheduler(const Scheduler &) = delete;
+  Scheduler &operator=(const Scheduler &) = delete;
+
+  // Run task(i) for every i in [0, n) and return once all are done. Each
+  // index runs exactly once, on one thread.
+  void run(std::size_t n, const std::function<void(std::size_t)> &task);
+
+  std::size_t threads() const noexcept { return ranges_.size(); }
+
+private:
+  // [begin, end) packed as (begin << 32) | end.
+  struct alignas(64) Range {
+    std::atomic<std::uint64_t> bounds{0};
+  };
+
+  void worker_loop(std::size_t self);
+  // Run tasks of the current job until none are left anywhere.
+  void work(std::size_t self);
+  bool take(std::size_t self, std::uint32_t &index);
+  bool steal(std::size_t self, std::uint32_t &index);
+
+  std::vector<Range> ranges_;
+  std::vector<std::thread> workers_;
+
+  // Current job.
+  const std::function<void(std::size_t)> *task_{nullptr};
+  std::atomic<std::size_t> remaining_{0};
+  std::atomic<std::size_t> active_{0}; // workers inside work()
+  std::atomic<std::uint64_t> job_{0};
+  std::atomic<bool> stop_{false};
+  logiq::utils::Doorbell start_; // rung when a job is published
+  // Rung when its last task finishes or the last worker leaves it.
+  logiq::utils::Doorbell done_;
+};
+
+} // namespace logiq::core
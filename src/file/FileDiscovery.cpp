@@ -0,0 +1,73 @@
+#include "file/FileDiscovery.hpp"
+
+#include <glob.h>
+#include <sys/stat.h>
+
+#include <unordered_set>
+
+#include "utils/Logger.hpp"
+
+namespace logiq::file {
+
+FileDiscovery::FileDiscovery(std::vector<std::string> patterns)
+    : patterns_(std::move(patterns)) {}
+
+bool FileDiscovery::is_glob(const std::string &pattern) noexcept {
+  return pattern.find_first_of("*?[") != std::string::npos;
+}
+
+std::vector<DiscoveredFile> FileDiscovery::scan() const {
+  std::vector<DiscoveredFile> out;
+  std::unordered_set<std::string> seen;
+
+  for (const auto &pattern : patterns_) {
+    if (!is_glob(pattern)) {
+      if (!seen.insert(pattern).second)
+        continue;
+      struct stat st{};
+      if (::stat(pattern.c_str(), &st) == 0) {
+        out.push_back({pattern,
+                       FileIdentity{static_cast<std::uint64_t>(st.st_dev),
+                                    static_cast<std::uint64_t>(st.st_ino)},
+                       true});
+      } else {
+        out.push_back({pattern, std::nullopt, true});
+      }
+      continue;
+    }
+
+    glob_t g{};
+    int rc = ::glob(pattern.c_str(), GLOB_NOSORT, nullptr, &g);
+    if (rc == GLOB_NOMATCH) {
+      ::globfree(&g);
+      continue;
+    }
+    if (rc != 0) {
+      logiq::utils::Logger::warn("FileDiscovery: glob failed for pattern: " +
+                                 pattern);
+      ::globfree(&g);
+      continue;
+    }
+
+    for (std::size_t i = 0; i < g.gl_pathc; ++i) {
+      std::string path = g.gl_pathv[i];
+
+      struct stat st{};
+      if (::stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+        continue;
+
+      if (!seen.insert(path).second)
+        continue;
+      out.push_back({std::move(path),
+                     FileIdentity{static_cast<std::uint64_t>(st.st_dev),
+                                  static_cast<std::uint64_t>(st.st_ino)},
+                     false});
+    }
+
+    ::globfree(&g);
+  }
+
+  return out;
+}
+
+} // namespace logiq::file
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "file/FileIdentity.hpp"
+
+namespace logiq::file {
+
+struct DiscoveredFile {
+  std::string path;
+  std::optional<FileIdentity> id; // nullopt if the file does not exist
+  bool literal{false};            // from a pattern without wildcards
+};
+
+// Expands input patterns into concrete file paths.
+//
+// A pattern without glob metacharacters ("*", "?", "[") is a literal path
+// and is always returned, even if the file does not exist yet, so the agent
+// can wait for it to appear. Glob patterns (e.g. /var/log/pods/*/*/*.log)
+// only yield existing regular files.
+class FileDiscovery {
+public:
+  explicit FileDiscovery(std::vector<std::string> patterns);
+
+  // Run all patterns. The result is deduplicated by path.
+  std::vector<DiscoveredFile> scan() const;
+
+  static bool is_glob(const std::string &pattern) noexcept;
+
+  const std::vector<std::string> &patterns() const noexcept {
+    return patterns_;
+  }
+
+private:
+  std::vector<std::string> patterns_;
+};
+
+} // namespace logiq::file
@@ -1,9 +1,11 @@
 #include "file/FileFollower.hpp"
+#include "file/FileMapping.hpp"
 
 #include <fcntl.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <cerrno>
 #include <cstring>
 
@@ -13,7 +15,10 @@ FileFollower::FileFollower(std::string path)
     : FileFollower(std::move(path), Options{}) {}
 
 FileFollower::FileFollower(std::string path, Options opt)
-    : path_(std::move(path)), opt_(opt) {}
+    : path_(std::move(path)), opt_(opt), read_size_(opt.max_read_bytes) {
+  if (opt_.max_read_bytes_limit < opt_.max_read_bytes)
+    opt_.max_read_bytes_limit = opt_.max_read_bytes;
+}
 
 std::optional<FileIdentity>
 FileFollower::stat_path_id(const std::string &path) {
@@ -43,7 +48,13 @@ bool FileFollower::seek_to(std::uint64_t offset, PollResult &out) {
   return true;
 }
 
+void FileFollower::restart_reads() {
+  map_.reset();
+  check_backlog_ = true;
+}
+
 void FileFollower::close_fd(PollResult &out, const std::string &reason) {
+  map_.reset();
   if (fd_ >= 0) {
     ::close(fd_);
     fd_ = -1;
@@ -72,7 +83,10 @@ bool FileFollower::open_fd_at_path(PollResult &out) {
   active_id_ = *id;
   generation_ = 0;
   read_offset_ = 0;
+  restart_reads();
+  suspended_ = false;
   rotation_pending_ = false;
+  path_missing_ = false;
   last_read_was_eof_ = false;
 
   out.file_opened = true;
@@ -85,24 +99,120 @@ bool FileFollower::open_if_exists() {
   return open_fd_at_path(tmp);
 }
 
+void FileFollower::suspend() {
+  if (fd_ < 0)
+    return;
+  ::close(fd_);
+  fd_ = -1;
+  suspended_ = true;
+  map_.reset();
+  buf_.reset();
+  buf_used_ = 0;
+}
+
+bool FileFollower::resume_fd(PollResult &out) {
+  int fd = ::open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    if (errno == ENOENT) {
+      out.path_missing = true;
+    } else {
+      out.error = true;
+      out.message = "reopen failed: " + std::string(std::strerror(errno));
+    }
+    return false;
+  }
+
+  struct stat st{};
+  if (::fstat(fd, &st) != 0) {
+    out.error = true;
+    out.message =
+        "fstat failed on reopen: " + std::string(std::strerror(errno));
+    ::close(fd);
+    return false;
+  }
+
+  const FileIdentity id{static_cast<std::uint64_t>(st.st_dev),
+                        static_cast<std::uint64_t>(st.st_ino)};
+
+  fd_ = fd;
+  suspended_ = false;
+  restart_reads();
+  rotation_pending_ = false;
+  path_missing_ = false;
+  last_read_was_eof_ = false;
+
+  if (id != active_id_) {
+    // Replaced while we held no fd; the old inode is no longer reachable by
+    // path, so continue with the new file from the start.
+    active_id_ = id;
+    generation_ = 0;
+    read_offset_ = 0;
+    out.switched = true;
+    out.message = "file replaced while suspended; following new file";
+    return true;
+  }
+
+  if (!seek_to(read_offset_, out)) {
+    return false;
+  }
+
+  out.resumed = true;
+  out.message = "resumed suspended file";
+  return true;
+}
+
+const FileFingerprint &FileFollower::fingerprint() {
+  const bool stale = fingerprint_id_ != active_id_ ||
+                     fingerprint_generation_ != generation_;
+  if (fd_ < 0) {
+    if (stale)
+      fingerprint_ = {};
+    return fingerprint_;
+  }
+  if (stale || (fingerprint_.bytes < FileFingerprint::kBytes &&
+                read_offset_ > fingerprint_.bytes)) {
+    fingerprint_ = FileFingerprint::of(fd_);
+    fingerprint_id_ = active_id_;
+    fingerprint_generation_ = generation_;
+  }
+  return fingerprint_;
+}
+
 PollResult FileFollower::poll(std::uint64_t committed_offset) {
+  return poll_impl(committed_offset, nullptr);
+}
+
+PollResult FileFollower::poll(std::uint64_t committed_offset,
+                              const Stats &stats) {
+  return poll_impl(committed_offset, fd_ >= 0 ? &stats : nullptr);
+}
+
+PollResult FileFollower::poll_impl(std::uint64_t committed_offset,
+                                   const Stats *stats) {
   PollResult out;
 
-  // If no fd, try to open if path exists.
+  // If no fd, try to open if path exists. A suspended follower reopens the
+  // same inode at its previous offset and then runs the usual checks.
   if (fd_ < 0) {
-    open_fd_at_path(out);
-    return out;
+    if (!suspended_) {
+      open_fd_at_path(out);
+      return out;
+    }
+    if (!resume_fd(out))
+      return out;
   }
 
   // 1) Detect truncate/copytruncate by comparing current size to our offsets.
   // If size < read_offset => file was truncated while we were reading.
   // Also compare with committed_offset to catch cases where commit > new size.
-  if (auto sz = fstat_size(fd_)) {
+  auto sz = stats ? stats->fd_size : fstat_size(fd_);
+  if (sz) {
     if (*sz < read_offset_ ||
         (committed_offset > 0 && *sz < committed_offset)) {
       // Same inode, content shrank. Treat as new generation.
       generation_++;
       read_offset_ = 0;
+      restart_reads();
       (void)seek_to(0, out);
       out.truncated = true;
       out.message = "truncate detected (copytruncate or manual truncate)";
@@ -117,13 +227,19 @@ PollResult FileFollower::poll(std::uint64_t committed_offset) {
 
   // 2) Detect rotation by rename/recreate: inode at path changed.
   // Note: If path is missing, old fd might still be valid. Keep draining.
-  auto path_id = stat_path_id(path_);
+  auto path_id = stats ? stats->path_id : stat_path_id(path_);
+  path_missing_ = !path_id.has_value();
   if (!path_id) {
     out.path_missing = true;
 
     // If we previously saw EOF and the path is gone, we can close once
     // drained+stable. This prevents holding deleted-but-open files forever.
     if (last_read_was_eof_) {
+      if (*sz > read_offset_) {
+        // Written to after EOF (and before unlink); keep draining.
+        last_read_was_eof_ = false;
+        return out;
+      }
       auto now = std::chrono::steady_clock::now();
       if (now - last_eof_time_ >= opt_.rotate_settle_time) {
         close_fd(out, "path missing and file drained; closing fd");
@@ -152,20 +268,74 @@ std::optional<ReadChunk> FileFollower::read_some() {
   if (fd_ < 0)
     return std::nullopt;
 
-  std::string buf;
-  buf.resize(opt_.max_read_bytes);
+  // Large backlog: serve it from a mapping instead of copying it through
+  // read(2). Only checked after (re)positioning and while lagging, so the
+  // live tail pays no extra fstat.
+  if (opt_.mmap_threshold_bytes > 0) {
+    if (!map_ && check_backlog_) {
+      check_backlog_ = false;
+      map_backlog();
+    }
+    if (map_)
+      return read_mapped();
+  }
 
+  const ReadRequest req = next_read();
   errno = 0;
-  const ssize_t n = ::read(fd_, buf.data(), buf.size());
+  const ssize_t n =
+      ::pread(req.fd, req.dst, req.length, static_cast<off_t>(req.offset));
+  return complete_read(req, n < 0 ? -errno : n);
+}
+
+std::optional<FileFollower::ReadRequest> FileFollower::prepare_read() {
+  if (fd_ < 0)
+    return std::nullopt;
+  if (opt_.mmap_threshold_bytes > 0 && (map_ || check_backlog_))
+    return std::nullopt;
+  return next_read();
+}
+
+FileFollower::ReadRequest FileFollower::next_read() {
+  // Read into the free tail of the current slab. Take a new slab from the
+  // pool when the tail is too small, unless no chunk references the slab
+  // anymore and it can be refilled from the start.
+  if (!buf_ || buf_.capacity() - buf_used_ < read_size_) {
+    if (buf_.unique() && buf_.capacity() >= read_size_) {
+      buf_used_ = 0;
+    } else {
+      buf_ = logiq::utils::BufferPool::instance().acquire(read_size_);
+      buf_used_ = 0;
+    }
+  }
+
+  return ReadRequest{.fd = fd_,
+                     .dst = buf_.data() + buf_used_,
+                     .length = read_size_,
+                     .offset = read_offset_};
+}
 
+std::optional<ReadChunk> FileFollower::complete_read(const ReadRequest &req,
+                                                     std::int64_t n) {
   if (n > 0) {
-    buf.resize(static_cast<std::size_t>(n));
+    // A full read means more is likely waiting: grow towards the limit so a
+    // lagging file catches up at disk speed. A short read means we reached
+    // the tail: go back to the small size to keep latency and memory low.
+    if (static_cast<std::size_t>(n) == req.length) {
+      if (read_size_ == opt_.max_read_bytes_limit)
+        check_backlog_ = true; // still lagging at full size
+      read_size_ = std::min(read_size_ * 2, opt_.max_read_bytes_limit);
+    } else {
+      read_size_ = opt_.max_read_bytes;
+    }
 
     ReadChunk chunk;
     chunk.start_offset = read_offset_;
-    chunk.data = std::move(buf);
+    chunk.data = std::string_view(req.dst, static_cast<std::size_t>(n));
     chunk.id = active_id_;
     chunk.generation = generation_;
+    chunk.buffer = buf_;
+
+    buf_used_ += static_cast<std::size_t>(n);
 
     read_offset_ += static_cast<std::uint64_t>(n);
 
@@ -176,19 +346,27 @@ std::optional<ReadChunk> FileFollower::read_some() {
 
   if (n == 0) {
     // EOF right now. This is not final; the writer may append later.
-    last_read_was_eof_ = true;
-    last_eof_time_ = std::chrono::steady_clock::now();
+    // Only stamp the first EOF so the settle timer measures how long the
+    // file has been stable, not the time since the last read attempt.
+    if (!last_read_was_eof_) {
+      last_read_was_eof_ = true;
+      last_eof_time_ = std::chrono::steady_clock::now();
+    }
+    // Idle followers should not pin a slab; give it back to the pool.
+    buf_.reset();
+    buf_used_ = 0;
     return ReadChunk{
-        .data = "",
+        .data = {},
         .start_offset = read_offset_,
         .id = active_id_,
         .generation =
             generation_}; // Empty chunk signals EOF to caller if needed
   }
 
-  // n < 0
-  if (errno == EINTR) {
-    return ReadChunk{.data = "",
+  // n < 0. Interrupted or cancelled (batched I/O gave up): nothing was
+  // consumed, try again on the next pass.
+  if (n == -EINTR || n == -EAGAIN || n == -ECANCELED) {
+    return ReadChunk{.data = {},
                      .start_offset = read_offset_,
                      .id = active_id_,
                      .generation = generation_};
@@ -200,6 +378,74 @@ std::optional<ReadChunk> FileFollower::read_some() {
   return std::nullopt;
 }
 
+void FileFollower::map_backlog() {
+  auto sz = fstat_size(fd_);
+  if (!sz || *sz <= read_offset_ ||
+      *sz - read_offset_ < opt_.mmap_threshold_bytes)
+    return;
+
+  const std::uint64_t page = FileMapping::page_size();
+  const std::uint64_t start = read_offset_ - read_offset_ % page;
+  const std::uint64_t length =
+      std::min<std::uint64_t>(*sz - start, opt_.mmap_max_bytes);
+
+  map_ = FileMapping::map(fd_, start, static_cast<std::size_t>(length));
+  if (!map_)
+    return; // stay on read(2)
+
+  map_offset_ = start;
+  map_end_ = start + length;
+  map_released_ = start;
+}
+
+std::optional<ReadChunk> FileFollower::read_mapped() {
+  if (FileMapping::poisoned(map_.data())) {
+    // Truncated under the mapping; poll() will see the smaller size.
+    map_.reset();
+    return ReadChunk{.data = {},
+                     .start_offset = read_offset_,
+                     .id = active_id_,
+                     .generation = generation_};
+  }
+
+  const auto window = static_cast<std::size_t>(
+      std::min<std::uint64_t>(opt_.mmap_window_bytes, map_end_ - read_offset_));
+
+  ReadChunk chunk;
+  chunk.start_offset = read_offset_;
+  chunk.data = std::string_view(
+      map_.data() + (read_offset_ - map_offset_), window);
+  chunk.id = active_id_;
+  chunk.generation = generation_;
+  chunk.buffer = map_;
+  chunk.mapped = true;
+
+  read_offset_ += window;
+  last_read_was_eof_ = false;
+
+  // Mapping consumed: back to read(2) for the live tail, unless the file
+  // grew enough meanwhile to map again.
+  if (read_offset_ >= map_end_)
+    restart_reads();
+
+  return chunk;
+}
+
+void FileFollower::release_committed(std::uint64_t committed_offset) {
+  if (!map_)
+    return;
+
+  const std::uint64_t page = FileMapping::page_size();
+  std::uint64_t end = std::min(committed_offset, map_end_);
+  end -= end % page;
+  if (end <= map_released_)
+    return;
+
+  FileMapping::release(map_.data() + (map_released_ - map_offset_),
+                       static_cast<std::size_t>(end - map_released_));
+  map_released_ = end;
+}
+
 bool FileFollower::maybe_switch_to_pending(PollResult &out) {
   if (!rotation_pending_)
     return false;
@@ -228,6 +474,7 @@ bool FileFollower::maybe_switch_to_pending(PollResult &out) {
   }
 
   // Close old fd.
+  map_.reset();
   if (fd_ >= 0)
     ::close(fd_);
   fd_ = -1;
@@ -255,6 +502,7 @@ bool FileFollower::maybe_switch_to_pending(PollResult &out) {
   // New file => reset offsets and generation.
   generation_ = 0;
   read_offset_ = 0;
+  restart_reads();
   last_read_was_eof_ = false;
   rotation_pending_ = false;
 
@@ -271,6 +519,7 @@ bool FileFollower::set_position(std::uint64_t offset,
   PollResult out;
   generation_ = generation;
   read_offset_ = offset;
+  restart_reads();
 
   if (!seek_to(offset, out)) {
     return false;
@@ -4,13 +4,17 @@
 #include <cstdint>
 #include <optional>
 #include <string>
+#include <string_view>
 
 #include "file/FileIdentity.hpp"
+#include "file/FileMapping.hpp"
+#include "utils/BufferPool.hpp"
 
 namespace logiq::file {
 
 struct ReadChunk {
-  std::string data;
+  // Bytes read, as a slice of a pooled buffer (see buffer).
+  std::string_view data;
 
   // The file byte-range covered by this chunk is:
   // [start_offset, start_offset + data.size())
@@ -21,6 +25,12 @@ struct ReadChunk {
 
   // Increments when we detect truncate/copytruncate on the same inode.
   std::uint64_t generation{0};
+
+  // Keeps the buffer behind data alive; hold a copy to keep views valid.
+  logiq::utils::BufferRef buffer{};
+
+  // data points into a file mapping (see FileFollower::chunk_intact()).
+  bool mapped{false};
 };
 
 struct PollResult {
@@ -30,6 +40,7 @@ struct PollResult {
   bool truncated{false};    // File size shrank (copytruncate/truncate).
   bool switched{false};     // We switched from old inode to new inode.
   bool closed{false}; // We closed the active fd (e.g., deleted + drained).
+  bool resumed{false}; // A suspended follower reopened the same inode.
   bool error{false};  // Non-recoverable error encountered.
 
   std::string message;                     // Debug info
@@ -42,7 +53,18 @@ public:
     std::chrono::milliseconds poll_interval{200};
     std::chrono::milliseconds rotate_settle_time{
         500}; // Wait after EOF before switching
+    // Read size adapts to backlog: it starts at max_read_bytes, doubles
+    // after every read that fills the buffer (we are lagging), up to
+    // max_read_bytes_limit, and drops back after a short read (caught up).
     std::size_t max_read_bytes{64 * 1024};
+    std::size_t max_read_bytes_limit{4 * 1024 * 1024};
+
+    // mmap catch-up: when at least mmap_threshold_bytes are unread, map
+    // [read_offset, size) (up to mmap_max_bytes) and hand out windows of
+    // mmap_window_bytes instead of reading. 0 disables the mode.
+    std::uint64_t mmap_threshold_bytes{0};
+    std::size_t mmap_window_bytes{4 * 1024 * 1024};
+    std::uint64_t mmap_max_bytes{1ULL << 30};
   };
 
   explicit FileFollower(std::string path);
@@ -57,30 +79,118 @@ public:
   // can pass 0.
   PollResult poll(std::uint64_t committed_offset);
 
-  // Read up to max_read_bytes from the active fd.
-  // Returns nullopt if no fd open.
+  // Results of the fstat(fd) and stat(path) that poll() would make, gathered
+  // by the caller for many followers at once (e.g. in one io_uring batch).
+  struct Stats {
+    std::optional<std::uint64_t> fd_size; // nullopt: fstat failed
+    std::optional<FileIdentity> path_id;  // nullopt: path missing
+  };
+
+  // poll() using stats taken while the current fd was open. Falls back to
+  // plain poll() if the follower has no fd.
+  PollResult poll(std::uint64_t committed_offset, const Stats &stats);
+
+  // Read up to read_size() bytes from the active fd, directly into a pooled
+  // buffer (no copy, no zero-fill). Consecutive reads fill the same slab
+  // back to back, so steady-state reads do no heap allocation.
+  // Returns nullopt if no fd open; an empty chunk at EOF.
   std::optional<ReadChunk> read_some();
 
+  // read_some() split in two for batched I/O: prepare_read() says where the
+  // next pread() should go, the caller performs it (e.g. via io_uring) and
+  // hands the result (byte count or -errno) to complete_read(), which
+  // returns what read_some() would have. No other call may be made on the
+  // follower in between. prepare_read() returns nullopt when there is no fd
+  // or when the next chunk may come from a mapping; use read_some() then.
+  struct ReadRequest {
+    int fd{-1};
+    char *dst{nullptr};
+    std::size_t length{0};
+    std::uint64_t offset{0};
+  };
+  std::optional<ReadRequest> prepare_read();
+  std::optional<ReadChunk> complete_read(const ReadRequest &req,
+                                         std::int64_t result);
+
+  // In mmap mode, drop mapped pages below committed_offset from memory
+  // (MADV_DONTNEED). A no-op otherwise.
+  void release_committed(std::uint64_t committed_offset);
+
+  // False if chunk came from a mapping that the file was truncated under;
+  // its bytes (and anything framed from them) must be discarded. Check after
+  // copying the data out and before acting on it.
+  static bool chunk_intact(const ReadChunk &chunk) noexcept {
+    return !chunk.mapped || !FileMapping::poisoned(chunk.data.data());
+  }
+
+  // Close the fd but keep identity, generation and offset, e.g. to stay
+  // under an open-file cap while the file is idle. The next poll() reopens
+  // the path and resumes at read_offset() if the inode is unchanged.
+  void suspend();
+
+  // Move the read cursor (e.g. to a committed checkpoint offset).
+  // Returns false if no fd is open or the seek fails.
+  bool set_position(std::uint64_t offset, std::uint64_t generation);
+
+  // Fingerprint of the active file (generation), computed on first use
+  // and again while it covers less than has been read, i.e. for a file
+  // opened while shorter than FileFingerprint::kBytes. Empty without an
+  // fd.
+  const FileFingerprint &fingerprint();
+
   // Exposed state
   bool has_fd() const noexcept { return fd_ >= 0; }
+  int fd() const noexcept { return fd_; }
+  bool suspended() const noexcept { return suspended_; }
   const std::string &path() const noexcept { return path_; }
   FileIdentity active_id() const noexcept { return active_id_; }
   std::uint64_t generation() const noexcept { return generation_; }
   std::uint64_t read_offset() const noexcept { return read_offset_; }
+  std::size_t read_size() const noexcept { return read_size_; }
+
+  // True while the follower waits on a timer rather than on file events:
+  // a rotation waiting to settle, or a deleted file waiting to be closed.
+  // Event-driven callers must keep polling at poll_interval meanwhile.
+  bool settling() const noexcept {
+    return rotation_pending_ || (fd_ >= 0 && path_missing_);
+  }
 
 private:
   std::string path_;
   Options opt_;
 
   int fd_{-1};
+  bool suspended_{false};
   FileIdentity active_id_{};
   std::uint64_t generation_{0};
 
   std::uint64_t read_offset_{0};
 
+  // fingerprint() cache and the file (generation) it was taken from.
+  FileFingerprint fingerprint_{};
+  FileIdentity fingerprint_id_{};
+  std::uint64_t fingerprint_generation_{0};
+
+  // Current adaptive read size (see Options::max_read_bytes).
+  std::size_t read_size_{0};
+
+  // Slab being filled by read_some(); bytes before buf_used_ belong to
+  // chunks already handed out.
+  logiq::utils::BufferRef buf_;
+  std::size_t buf_used_{0};
+
+  // mmap catch-up state: map_ covers file range [map_offset_, map_end_);
+  // pages below map_released_ were already dropped.
+  logiq::utils::BufferRef map_;
+  std::uint64_t map_offset_{0};
+  std::uint64_t map_end_{0};
+  std::uint64_t map_released_{0};
+  bool check_backlog_{true};
+
   // Rotation handling
   bool rotation_pending_{false};
   FileIdentity pending_id_{};
+  bool path_missing_{false};
 
   // EOF tracking for safe switching
   bool last_read_was_eof_{false};
@@ -90,6 +200,25 @@ private:
   // Open and initialize internal identity/offset.
   bool open_fd_at_path(PollResult &out);
 
+  // Drop any mapping and re-check the backlog on the next read; called
+  // whenever the read position jumps.
+  void restart_reads();
+
+  // Map the unread backlog if it exceeds the threshold.
+  void map_backlog();
+
+  // Make room in the read slab for the next pread() at read_offset_.
+  ReadRequest next_read();
+
+  // Hand out the next window of the mapping.
+  std::optional<ReadChunk> read_mapped();
+
+  // poll() with optional prefetched stats.
+  PollResult poll_impl(std::uint64_t committed_offset, const Stats *stats);
+
+  // Reopen a suspended follower; see suspend().
+  bool resume_fd(PollResult &out);
+
   // Close active fd.
   void close_fd(PollResult &out, const std::string &reason);
 
@@ -0,0 +1,38 @@
+#include "file/FileIdentity.hpp"
+#include "utils/XxHash64.hpp"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+
+namespace logiq::file {
+
+FileFingerprint FileFingerprint::of(int fd, std::size_t limit) {
+  char buf[kBytes];
+  const std::size_t want = std::min(limit, kBytes);
+  std::size_t got = 0;
+  while (got < want) {
+    const ssize_t n =
+        ::pread(fd, buf + got, want - got, static_cast<off_t>(got));
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      break;
+    got += static_cast<std::size_t>(n);
+  }
+
+  FileFingerprint fp;
+  if (got == 0)
+    return fp;
+  fp.hash = logiq::utils::xxhash64(buf, got);
+  fp.bytes = static_cast<std::uint32_t>(got);
+  return fp;
+}
+
+bool FileFingerprint::matches(int fd) const {
+  // A shorter read (the file shrank) hashes fewer bytes and fails.
+  return bytes == 0 || of(fd, bytes) == *this;
+}
+
+} // namespace logiq::file
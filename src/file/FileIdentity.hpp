@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <functional>
 
 namespace logiq::file {
 
@@ -16,4 +18,37 @@ struct FileIdentity {
   }
 };
 
+// Hash of a file's first bytes (up to kBytes), to tell whether a file
+// found under a known (dev, ino) is still the one a position was saved
+// for: inodes are reused, and copytruncate keeps the inode.
+struct FileFingerprint {
+  static constexpr std::size_t kBytes = 1024;
+
+  std::uint64_t hash{0};
+  std::uint32_t bytes{0}; // length of the hashed prefix; 0 = none
+
+  // Fingerprint of the first min(limit, kBytes) bytes of fd; empty if
+  // nothing could be read.
+  static FileFingerprint of(int fd, std::size_t limit = kBytes);
+
+  // fd still starts with the bytes this was taken from. An empty
+  // fingerprint matches anything.
+  bool matches(int fd) const;
+
+  bool operator==(const FileFingerprint &o) const noexcept {
+    return hash == o.hash && bytes == o.bytes;
+  }
+  bool operator!=(const FileFingerprint &o) const noexcept {
+    return !(*this == o);
+  }
+};
+
 } // namespace logiq::file
+
+template <> struct std::hash<logiq::file::FileIdentity> {
+  std::size_t operator()(const logiq::file::FileIdentity &id) const noexcept {
+    // dev is nearly constant across a host; mix it into ino.
+    return std::hash<std::uint64_t>{}(id.ino ^
+                                      (id.dev * 0x9e3779b97f4a7c15ULL));
+  }
+};
@@ -0,0 +1,143 @@
+#include "file/FileMapping.hpp"
+
+#include <signal.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+
+#include "utils/Logger.hpp"
+
+namespace logiq::file {
+
+namespace {
+
+struct Slot {
+  std::atomic<bool> used{false};
+  std::atomic<std::uintptr_t> begin{0}; // 0 while not published
+  std::atomic<std::size_t> length{0};
+  std::atomic<bool> poisoned{false};
+};
+
+std::array<Slot, FileMapping::kMaxMappings> g_slots;
+
+struct sigaction g_prev_sigbus{};
+std::once_flag g_handler_once;
+
+Slot *find_slot(std::uintptr_t addr) noexcept {
+  for (auto &s : g_slots) {
+    const auto b = s.begin.load(std::memory_order_acquire);
+    if (b != 0 && addr >= b && addr < b + s.length.load())
+      return &s;
+  }
+  return nullptr;
+}
+
+void sigbus_handler(int sig, siginfo_t *info, void *ctx) {
+  const auto addr = reinterpret_cast<std::uintptr_t>(info->si_addr);
+  Slot *s = find_slot(addr);
+
+  if (!s) {
+    // Not ours: behave as if we were never installed.
+    if (g_prev_sigbus.sa_flags & SA_SIGINFO) {
+      g_prev_sigbus.sa_sigaction(sig, info, ctx);
+      return;
+    }
+    if (g_prev_sigbus.sa_handler != SIG_DFL &&
+        g_prev_sigbus.sa_handler != SIG_IGN) {
+      g_prev_sigbus.sa_handler(sig);
+      return;
+    }
+    ::signal(SIGBUS, SIG_DFL);
+    ::raise(SIGBUS);
+    return;
+  }
+
+  // The file shrank under us. Back the rest of the range with zero pages so
+  // the faulting access (and any later one) completes, and let the owner
+  // discard what it read.
+  const auto page = static_cast<std::uintptr_t>(::sysconf(_SC_PAGESIZE));
+  const auto from = addr & ~(page - 1);
+  const auto end = s->begin.load() + s->length.load();
+  ::mmap(reinterpret_cast<void *>(from), end - from, PROT_READ,
+         MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
+  s->poisoned.store(true, std::memory_order_release);
+}
+
+void install_handler() {
+  struct sigaction sa{};
+  sa.sa_sigaction = sigbus_handler;
+  sa.sa_flags = SA_SIGINFO | SA_RESTART;
+  sigemptyset(&sa.sa_mask);
+  if (::sigaction(SIGBUS, &sa, &g_prev_sigbus) != 0) {
+    logiq::utils::Logger::warn("FileMapping: cannot install SIGBUS handler: " +
+                               std::string(std::strerror(errno)));
+  }
+}
+
+void unmap(char *data, std::size_t length) noexcept {
+  if (Slot *s = find_slot(reinterpret_cast<std::uintptr_t>(data))) {
+    s->begin.store(0, std::memory_order_release);
+    s->used.store(false, std::memory_order_release);
+  }
+  ::munmap(data, length);
+}
+
+} // namespace
+
+std::size_t FileMapping::page_size() noexcept {
+  static const auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+  return page;
+}
+
+logiq::utils::BufferRef FileMapping::map(int fd, std::uint64_t offset,
+                                         std::size_t length) {
+  if (length == 0 || offset % page_size() != 0)
+    return {};
+
+  std::call_once(g_handler_once, install_handler);
+
+  Slot *slot = nullptr;
+  for (auto &s : g_slots) {
+    bool expected = false;
+    if (s.used.compare_exchange_strong(expected, true)) {
+      slot = &s;
+      break;
+    }
+  }
+  if (!slot)
+    return {};
+
+  void *p = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd,
+                   static_cast<off_t>(offset));
+  if (p == MAP_FAILED) {
+    slot->used.store(false, std::memory_order_release);
+    return {};
+  }
+
+  ::madvise(p, length, MADV_SEQUENTIAL);
+
+  slot->length.store(length);
+  slot->poisoned.store(false);
+  slot->begin.store(reinterpret_cast<std::uintptr_t>(p),
+                    std::memory_order_release);
+
+  return logiq::utils::BufferRef::adopt(static_cast<char *>(p), length,
+                                        &unmap);
+}
+
+bool FileMapping::poisoned(const void *p) noexcept {
+  Slot *s = find_slot(reinterpret_cast<std::uintptr_t>(p));
+  return s && s->poisoned.load(std::memory_order_acquire);
+}
+
+void FileMapping::release(char *begin, std::size_t length) noexcept {
+  if (length == 0)
+    return;
+  ::madvise(begin, length, MADV_DONTNEED);
+}
+
+} // namespace logiq::file
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "utils/BufferPool.hpp"
+
+namespace logiq::file {
+
+// Read-only shared mappings of file ranges, protected against SIGBUS.
+//
+// Touching a mapped page past EOF raises SIGBUS, which happens when a file
+// is truncated under a live mapping. Every mapping is registered in a small
+// process-wide table; a SIGBUS inside a registered range replaces the rest
+// of that range with zero pages and marks the mapping poisoned instead of
+// killing the process. Callers must check poisoned() after consuming bytes
+// and before acting on them (e.g. before sending a batch).
+class FileMapping {
+public:
+  // Maximum number of live mappings; map() fails beyond it.
+  static constexpr std::size_t kMaxMappings = 64;
+
+  // Map [offset, offset + length) of fd with MADV_SEQUENTIAL. offset must be
+  // page aligned. Returns an empty ref on failure so the caller can fall back
+  // to read(2). The mapping is unmapped when the last ref is dropped.
+  static logiq::utils::BufferRef map(int fd, std::uint64_t offset,
+                                     std::size_t length);
+
+  // True if a SIGBUS hit the mapping that contains p.
+  static bool poisoned(const void *p) noexcept;
+
+  // Drop the pages of [begin, begin + length) from our address space
+  // (MADV_DONTNEED); later access re-reads them from the page cache.
+  static void release(char *begin, std::size_t length) noexcept;
+
+  static std::size_t page_size() noexcept;
+};
+
+} // namespace logiq::file
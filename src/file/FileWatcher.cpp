@@ -0,0 +1,260 @@
+#include "file/FileWatcher.hpp"
+
+#include <sys/epoll.h>
+#include <sys/inotify.h>
+#include <sys/vfs.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+#include "utils/Logger.hpp"
+
+namespace logiq::file {
+
+namespace {
+
+constexpr std::uint32_t kFileMask =
+    IN_MODIFY | IN_MOVE_SELF | IN_DELETE_SELF | IN_ATTRIB;
+constexpr std::uint32_t kDirMask =
+    IN_CREATE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE | IN_ONLYDIR;
+
+void split_path(const std::string &path, std::string &dir, std::string &name) {
+  // Built with assign() rather than operator= from literals, which GCC 12
+  // flags with a spurious -Wrestrict at -O2.
+  const auto slash = path.find_last_of('/');
+  if (slash == std::string::npos) {
+    dir.assign(1, '.');
+    name.assign(path);
+  } else {
+    dir.assign(path, 0, slash == 0 ? 1 : slash);
+    name.assign(path, slash + 1);
+  }
+}
+
+} // namespace
+
+WatchMode parse_watch_mode(const std::string &s) {
+  if (s == "inotify")
+    return WatchMode::Inotify;
+  if (s == "poll" || s == "polling")
+    return WatchMode::Poll;
+  return WatchMode::Auto;
+}
+
+FileWatcher::FileWatcher(WatchMode mode) : mode_(mode) {
+  if (mode_ == WatchMode::Poll)
+    return;
+
+  inotify_fd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (inotify_fd_ < 0) {
+    logiq::utils::Logger::warn("FileWatcher: inotify_init1 failed (" +
+                               std::string(std::strerror(errno)) +
+                               "); falling back to polling");
+    return;
+  }
+
+  epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+  if (epoll_fd_ < 0) {
+    logiq::utils::Logger::warn("FileWatcher: epoll_create1 failed (" +
+                               std::string(std::strerror(errno)) +
+                               "); falling back to polling");
+    ::close(inotify_fd_);
+    inotify_fd_ = -1;
+    return;
+  }
+
+  epoll_event ev{};
+  ev.events = EPOLLIN;
+  ev.data.fd = inotify_fd_;
+  if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, inotify_fd_, &ev) != 0) {
+    logiq::utils::Logger::warn("FileWatcher: epoll_ctl failed (" +
+                               std::string(std::strerror(errno)) +
+                               "); falling back to polling");
+    ::close(epoll_fd_);
+    ::close(inotify_fd_);
+    epoll_fd_ = -1;
+    inotify_fd_ = -1;
+  }
+}
+
+FileWatcher::~FileWatcher() {
+  if (epoll_fd_ >= 0)
+    ::close(epoll_fd_);
+  if (inotify_fd_ >= 0)
+    ::close(inotify_fd_); // also drops all watches
+}
+
+bool FileWatcher::is_unreliable_fs(const std::string &dir) {
+  struct statfs sfs{};
+  if (::statfs(dir.c_str(), &sfs) != 0)
+    return false;
+
+  switch (static_cast<unsigned long>(sfs.f_type)) {
+  case 0x6969UL:     // NFS_SUPER_MAGIC
+  case 0x794c7630UL: // OVERLAYFS_SUPER_MAGIC
+  case 0x65735546UL: // FUSE_SUPER_MAGIC
+  case 0xff534d42UL: // CIFS_MAGIC_NUMBER
+  case 0xfe534d42UL: // SMB2_MAGIC_NUMBER
+  case 0x517bUL:     // SMB_SUPER_MAGIC
+    return true;
+  default:
+    return false;
+  }
+}
+
+bool FileWatcher::dir_needs_polling(const std::string &dir) {
+  if (mode_ != WatchMode::Auto)
+    return false;
+  auto [it, inserted] = dir_polled_.try_emplace(dir, false);
+  if (inserted)
+    it->second = is_unreliable_fs(dir);
+  return it->second;
+}
+
+void FileWatcher::watch(const std::string &path, Token token) {
+  auto [it, inserted] = entries_.try_emplace(path);
+  Entry &e = it->second;
+
+  if (inserted) {
+    split_path(path, e.dir, e.name);
+    e.token = token;
+    e.polled = !active() || dir_needs_polling(e.dir);
+    if (e.polled)
+      polled_++;
+  }
+  if (e.polled)
+    return;
+
+  if (e.dir_wd < 0) {
+    int wd = ::inotify_add_watch(inotify_fd_, e.dir.c_str(), kDirMask);
+    if (wd < 0) {
+      // Without the directory watch we would miss creation/rotation.
+      logiq::utils::Logger::warn("FileWatcher: cannot watch directory " +
+                                 e.dir + " (" +
+                                 std::string(std::strerror(errno)) +
+                                 "); polling " + path);
+      e.polled = true;
+      polled_++;
+      return;
+    }
+    e.dir_wd = wd;
+    dir_names_[wd][e.name] = token;
+  }
+
+  // (Re)arm the file watch on whatever inode is at path now. A missing file
+  // is fine: the directory watch reports its creation.
+  int wd = ::inotify_add_watch(inotify_fd_, path.c_str(), kFileMask);
+  if (wd >= 0 && wd != e.file_wd) {
+    if (e.file_wd >= 0) {
+      ::inotify_rm_watch(inotify_fd_, e.file_wd);
+      file_wds_.erase(e.file_wd);
+    }
+    e.file_wd = wd;
+    file_wds_[wd] = token;
+  }
+}
+
+void FileWatcher::unwatch(const std::string &path) {
+  auto it = entries_.find(path);
+  if (it == entries_.end())
+    return;
+
+  Entry &e = it->second;
+  if (e.file_wd >= 0) {
+    ::inotify_rm_watch(inotify_fd_, e.file_wd);
+    file_wds_.erase(e.file_wd);
+  }
+  if (e.dir_wd >= 0)
+    release_dir_wd(e.dir_wd, e.name);
+  if (e.polled)
+    polled_--;
+
+  entries_.erase(it);
+}
+
+void FileWatcher::release_dir_wd(int wd, const std::string &name) {
+  auto it = dir_names_.find(wd);
+  if (it == dir_names_.end())
+    return;
+
+  it->second.erase(name);
+  if (!it->second.empty())
+    return;
+
+  ::inotify_rm_watch(inotify_fd_, wd);
+  dir_names_.erase(it);
+}
+
+bool FileWatcher::is_polled(const std::string &path) const {
+  if (!active())
+    return true;
+  auto it = entries_.find(path);
+  return it != entries_.end() && it->second.polled;
+}
+
+bool FileWatcher::wait(std::chrono::milliseconds timeout,
+                       std::vector<Token> &ready) {
+  if (!active()) {
+    std::this_thread::sleep_for(timeout);
+    return false;
+  }
+
+  epoll_event ev{};
+  int n = ::epoll_wait(epoll_fd_, &ev, 1, static_cast<int>(timeout.count()));
+  if (n <= 0) {
+    // Timeout, or EINTR (e.g. shutdown signal): let the caller re-check.
+    return false;
+  }
+
+  return drain_events(ready);
+}
+
+bool FileWatcher::drain_events(std::vector<Token> &ready) {
+  alignas(inotify_event) char buf[16 * 1024];
+  bool any = false;
+
+  while (true) {
+    ssize_t n = ::read(inotify_fd_, buf, sizeof(buf));
+    if (n <= 0)
+      break; // EAGAIN: queue drained
+
+    for (char *p = buf; p < buf + n;) {
+      auto *ev = reinterpret_cast<inotify_event *>(p);
+      p += sizeof(inotify_event) + ev->len;
+
+      if (ev->mask & IN_Q_OVERFLOW) {
+        // Lost events: the caller must look at everything.
+        rescan_ = true;
+        any = true;
+        continue;
+      }
+
+      if (auto f = file_wds_.find(ev->wd); f != file_wds_.end()) {
+        ready.push_back(f->second);
+        any = true;
+        continue;
+      }
+
+      // Directory event: wake the follower of that name, or ask for a
+      // rescan if a new file appeared that nobody follows yet.
+      auto dir = dir_names_.find(ev->wd);
+      if (dir == dir_names_.end() || ev->len == 0)
+        continue; // stale wd we already removed
+
+      if (auto name = dir->second.find(ev->name); name != dir->second.end()) {
+        ready.push_back(name->second);
+        any = true;
+      } else if (ev->mask & (IN_CREATE | IN_MOVED_TO)) {
+        rescan_ = true;
+        any = true;
+      }
+    }
+  }
+
+  return any;
+}
+
+} // namespace logiq::file
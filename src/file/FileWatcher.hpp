@@ -0,0 +1,114 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace logiq::file {
+
+enum class WatchMode {
+  Auto,    // inotify, unless the filesystem is known to be unreliable
+  Inotify, // inotify only (fall back to polling only if setup fails)
+  Poll     // stat polling only
+};
+
+// Parses "auto" | "inotify" | "poll". Unknown values map to Auto.
+WatchMode parse_watch_mode(const std::string &s);
+
+// Event-driven wakeups for followed files (inotify + epoll).
+//
+// For each watched path we add two inotify watches:
+// - the file inode: IN_MODIFY, IN_MOVE_SELF, IN_DELETE_SELF, IN_ATTRIB
+// - the parent directory: IN_CREATE, IN_MOVED_TO, IN_MOVED_FROM, IN_DELETE
+//
+// Every path carries a caller-chosen token; wait() reports the tokens of
+// paths that saw events, so the caller only visits files with work.
+// The watcher only tells the caller *that* something happened; the
+// FileFollower still decides what happened (rotation, truncate, ...).
+//
+// When inotify is unavailable or the path lives on a filesystem where it is
+// unreliable (NFS, overlay, FUSE, ...), is_polled() returns true for it and
+// the caller must keep polling it at its poll interval.
+class FileWatcher {
+public:
+  using Token = std::uint64_t;
+
+  explicit FileWatcher(WatchMode mode = WatchMode::Auto);
+  ~FileWatcher();
+
+  FileWatcher(const FileWatcher &) = delete;
+  FileWatcher &operator=(const FileWatcher &) = delete;
+
+  // Start watching path (or re-arm the file watch after reopen/rotation).
+  // Safe to call repeatedly; the file watch is moved to the inode currently
+  // at path.
+  void watch(const std::string &path, Token token);
+
+  // Stop watching path.
+  void unwatch(const std::string &path);
+
+  // Block until at least one event arrives or timeout expires. Tokens of
+  // paths with events are appended to ready (possibly with duplicates).
+  // Returns true if any event was observed.
+  bool wait(std::chrono::milliseconds timeout, std::vector<Token> &ready);
+
+  // True once after the watcher lost events (queue overflow) or saw a new
+  // name appear in a watched directory; the caller should rescan inputs.
+  bool take_rescan() noexcept {
+    bool r = rescan_;
+    rescan_ = false;
+    return r;
+  }
+
+  // True if inotify + epoll are set up.
+  bool active() const noexcept { return epoll_fd_ >= 0; }
+
+  // True if path cannot rely on inotify and must be polled.
+  bool is_polled(const std::string &path) const;
+
+  // True if some watched path must be polled.
+  bool needs_polling() const noexcept { return !active() || polled_ > 0; }
+
+private:
+  struct Entry {
+    std::string dir;
+    std::string name;
+    Token token{0};
+    int file_wd{-1};
+    int dir_wd{-1};
+    bool polled{false}; // inotify not trusted for this path
+  };
+
+  WatchMode mode_;
+  int inotify_fd_{-1};
+  int epoll_fd_{-1};
+  bool rescan_{false};
+  std::size_t polled_{0};
+
+  std::unordered_map<std::string, Entry> entries_;
+
+  // File watch -> token.
+  std::unordered_map<int, Token> file_wds_;
+
+  // Directory watch -> followed names inside it. A directory watch is
+  // removed once no followed path references it.
+  std::unordered_map<int, std::unordered_map<std::string, Token>> dir_names_;
+
+  // Directories already classified by is_unreliable_fs().
+  std::unordered_map<std::string, bool> dir_polled_;
+
+private:
+  // Read pending inotify events and collect tokens of affected paths.
+  bool drain_events(std::vector<Token> &ready);
+
+  void release_dir_wd(int wd, const std::string &name);
+
+  bool dir_needs_polling(const std::string &dir);
+
+  // Filesystems where inotify misses remote or lower-layer writes.
+  static bool is_unreliable_fs(const std::string &dir);
+};
+
+} // namespace logiq::file
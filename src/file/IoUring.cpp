@@ -0,0 +1,260 @@
+#include "file/IoUring.hpp"
+
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "utils/Logger.hpp"
+
+namespace logiq::file {
+
+namespace {
+
+int sys_setup(unsigned entries, io_uring_params *p) {
+  return static_cast<int>(::syscall(__NR_io_uring_setup, entries, p));
+}
+
+int sys_enter(int fd, unsigned to_submit, unsigned min_complete,
+              unsigned flags) {
+  return static_cast<int>(::syscall(__NR_io_uring_enter, fd, to_submit,
+                                    min_complete, flags, nullptr, 0));
+}
+
+int sys_register(int fd, unsigned opcode, void *arg, unsigned nr_args) {
+  return static_cast<int>(
+      ::syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+}
+
+template <typename T> T *at(void *base, std::uint32_t offset) {
+  return reinterpret_cast<T *>(static_cast<char *>(base) + offset);
+}
+
+unsigned load_acquire(unsigned *p) {
+  return std::atomic_ref<unsigned>(*p).load(std::memory_order_acquire);
+}
+
+void store_release(unsigned *p, unsigned v) {
+  std::atomic_ref<unsigned>(*p).store(v, std::memory_order_release);
+}
+
+} // namespace
+
+IoUring::IoUring(unsigned entries) {
+  if (!setup(entries) || !probe()) {
+    teardown();
+    return;
+  }
+  ops_.reserve(sq_entries_);
+}
+
+IoUring::~IoUring() { teardown(); }
+
+bool IoUring::setup(unsigned entries) {
+  io_uring_params p{};
+  p.flags = IORING_SETUP_CLAMP;
+
+  ring_fd_ = sys_setup(entries, &p);
+  if (ring_fd_ < 0) {
+    logiq::utils::Logger::warn("IoUring: io_uring_setup failed (" +
+                               std::string(std::strerror(errno)) + ")");
+    return false;
+  }
+
+  sq_ring_size_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+  cq_ring_size_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+  const bool single = p.features & IORING_FEAT_SINGLE_MMAP;
+  if (single) {
+    sq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+    cq_ring_size_ = sq_ring_size_;
+  }
+
+  sq_ring_ = ::mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+  if (sq_ring_ == MAP_FAILED) {
+    sq_ring_ = nullptr;
+    return false;
+  }
+
+  if (single) {
+    cq_ring_ = sq_ring_;
+  } else {
+    cq_ring_ = ::mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+    if (cq_ring_ == MAP_FAILED) {
+      cq_ring_ = nullptr;
+      return false;
+    }
+  }
+
+  sqes_size_ = p.sq_entries * sizeof(io_uring_sqe);
+  sqes_ = ::mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+  if (sqes_ == MAP_FAILED) {
+    sqes_ = nullptr;
+    return false;
+  }
+
+  sq_tail_ = at<unsigned>(sq_ring_, p.sq_off.tail);
+  sq_mask_ = *at<unsigned>(sq_ring_, p.sq_off.ring_mask);
+  sq_entries_ = p.sq_entries;
+  sq_array_ = at<unsigned>(sq_ring_, p.sq_off.array);
+
+  cq_head_ = at<unsigned>(cq_ring_, p.cq_off.head);
+  cq_tail_ = at<unsigned>(cq_ring_, p.cq_off.tail);
+  cq_mask_ = *at<unsigned>(cq_ring_, p.cq_off.ring_mask);
+  cqes_ = at<io_uring_cqe>(cq_ring_, p.cq_off.cqes);
+  return true;
+}
+
+bool IoUring::probe() {
+  // IORING_OP_READ and IORING_OP_STATX need 5.6; older kernels have a ring
+  // but reject the opcodes.
+  constexpr unsigned kOps = 256;
+  const std::size_t size =
+      sizeof(io_uring_probe) + kOps * sizeof(io_uring_probe_op);
+  auto mem = std::make_unique<unsigned char[]>(size);
+  std::memset(mem.get(), 0, size);
+  auto *pr = reinterpret_cast<io_uring_probe *>(mem.get());
+
+  if (sys_register(ring_fd_, IORING_REGISTER_PROBE, pr, kOps) < 0) {
+    logiq::utils::Logger::warn("IoUring: opcode probe failed (" +
+                               std::string(std::strerror(errno)) + ")");
+    return false;
+  }
+
+  for (unsigned op : {unsigned{IORING_OP_READ}, unsigned{IORING_OP_STATX}}) {
+    if (op > pr->last_op || !(pr->ops[op].flags & IO_URING_OP_SUPPORTED)) {
+      logiq::utils::Logger::warn("IoUring: kernel lacks read/statx opcodes");
+      return false;
+    }
+  }
+  return true;
+}
+
+void IoUring::teardown() {
+  // Closing the ring waits for (or cancels) anything still in flight.
+  if (sqes_)
+    ::munmap(sqes_, sqes_size_);
+  if (cq_ring_ && cq_ring_ != sq_ring_)
+    ::munmap(cq_ring_, cq_ring_size_);
+  if (sq_ring_)
+    ::munmap(sq_ring_, sq_ring_size_);
+  if (ring_fd_ >= 0)
+    ::close(ring_fd_);
+
+  sqes_ = nullptr;
+  cq_ring_ = nullptr;
+  sq_ring_ = nullptr;
+  ring_fd_ = -1;
+}
+
+void IoUring::read(int fd, char *dst, std::size_t length,
+                   std::uint64_t offset, std::uint64_t tag) {
+  ops_.push_back(Op{.opcode = IORING_OP_READ,
+                    .fd = fd,
+                    .addr = reinterpret_cast<std::uint64_t>(dst),
+                    .len = static_cast<std::uint32_t>(length),
+                    .off = offset,
+                    .flags = 0,
+                    .tag = tag});
+}
+
+void IoUring::statx(int dirfd, const char *path, int flags, unsigned mask,
+                    struct ::statx *out, std::uint64_t tag) {
+  ops_.push_back(Op{.opcode = IORING_OP_STATX,
+                    .fd = dirfd,
+                    .addr = reinterpret_cast<std::uint64_t>(path),
+                    .len = mask,
+                    .off = reinterpret_cast<std::uint64_t>(out),
+                    .flags = static_cast<std::uint32_t>(flags),
+                    .tag = tag});
+}
+
+bool IoUring::run_impl(Callback done, void *ctx) {
+  // Callbacks must not queue new operations while this runs.
+  const std::vector<Op> &ops = ops_;
+  auto *sqes = static_cast<io_uring_sqe *>(sqes_);
+  auto *cqes = static_cast<io_uring_cqe *>(cqes_);
+
+  // The CQ holds at least twice the SQ entries, so waiting for a whole
+  // SQ-sized slice before submitting the next one never overflows it.
+  std::size_t next = 0;
+  std::vector<bool> reported(ops.size(), false);
+  bool failed = ring_fd_ < 0;
+
+  while (!failed && next < ops.size()) {
+    const auto n = static_cast<unsigned>(
+        std::min<std::size_t>(ops.size() - next, sq_entries_));
+
+    unsigned tail = *sq_tail_;
+    for (unsigned i = 0; i < n; ++i) {
+      const Op &op = ops[next + i];
+      const unsigned idx = tail & sq_mask_;
+      io_uring_sqe &sqe = sqes[idx];
+      std::memset(&sqe, 0, sizeof(sqe));
+      sqe.opcode = op.opcode;
+      sqe.fd = op.fd;
+      sqe.addr = op.addr;
+      sqe.len = op.len;
+      sqe.off = op.off;
+      sqe.statx_flags = op.flags;
+      sqe.user_data = next + i; // index into ops
+      sq_array_[idx] = idx;
+      ++tail;
+    }
+    store_release(sq_tail_, tail);
+
+    unsigned to_submit = n;
+    unsigned completed = 0;
+    while (completed < n) {
+      const int rc =
+          sys_enter(ring_fd_, to_submit, n - completed, IORING_ENTER_GETEVENTS);
+      if (rc >= 0) {
+        to_submit -= std::min<unsigned>(to_submit, static_cast<unsigned>(rc));
+      } else if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+        logiq::utils::Logger::warn("IoUring: io_uring_enter failed (" +
+                                   std::string(std::strerror(errno)) +
+                                   "); falling back to POSIX I/O");
+        failed = true;
+        break;
+      }
+
+      unsigned head = *cq_head_;
+      const unsigned cq_tail = load_acquire(cq_tail_);
+      for (; head != cq_tail; ++head) {
+        const io_uring_cqe &cqe = cqes[head & cq_mask_];
+        const auto i = static_cast<std::size_t>(cqe.user_data);
+        if (i < ops.size() && !reported[i]) {
+          reported[i] = true;
+          done(ctx, ops[i].tag, cqe.res);
+        }
+        ++completed;
+      }
+      store_release(cq_head_, head);
+    }
+    next += n;
+  }
+
+  if (failed) {
+    teardown();
+    for (std::size_t i = 0; i < ops.size(); ++i) {
+      if (!reported[i])
+        done(ctx, ops[i].tag, -ECANCELED);
+    }
+    ops_.clear();
+    return false;
+  }
+  ops_.clear();
+  return true;
+}
+
+} // namespace logiq::file
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <sys/stat.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace logiq::file {
+
+// A minimal io_uring instance driven through the raw syscalls (no liburing).
+//
+// Callers queue read and statx operations for many files, then run() submits
+// them with as few io_uring_enter() calls as the ring size allows and reports
+// every completion. This turns the per-file fstat/stat/pread of a scheduling
+// pass into one or two syscalls in total.
+//
+// Not thread-safe; one ring per scheduling thread.
+class IoUring {
+public:
+  // entries is the submission queue depth; larger batches are split.
+  explicit IoUring(unsigned entries = 256);
+  ~IoUring();
+
+  IoUring(const IoUring &) = delete;
+  IoUring &operator=(const IoUring &) = delete;
+
+  // False if the kernel has no io_uring (or lacks IORING_OP_READ/STATX), or
+  // if the ring failed; callers then use the POSIX calls instead.
+  bool ready() const noexcept { return ring_fd_ >= 0; }
+
+  // Queue pread(fd, dst, length, offset).
+  void read(int fd, char *dst, std::size_t length, std::uint64_t offset,
+            std::uint64_t tag);
+
+  // Queue statx(dirfd, path, flags, mask, out). path and out must stay valid
+  // until run() returns.
+  void statx(int dirfd, const char *path, int flags, unsigned mask,
+             struct ::statx *out, std::uint64_t tag);
+
+  std::size_t queued() const noexcept { return ops_.size(); }
+
+  // Submit all queued operations, wait for them and call
+  // done(tag, result) for each, where result is what the syscall would have
+  // returned, or -errno. Returns false if the ring failed; operations that
+  // did not complete are then reported with -ECANCELED and the ring is shut
+  // down (ready() turns false).
+  template <typename Fn> bool run(Fn &&done) {
+    return run_impl(
+        [](void *ctx, std::uint64_t tag, int result) {
+          (*static_cast<Fn *>(ctx))(tag, result);
+        },
+        &done);
+  }
+
+private:
+  struct Op {
+    std::uint8_t opcode;
+    int fd;
+    std::uint64_t addr;
+    std::uint32_t len;
+    std::uint64_t off;
+    std::uint32_t flags; // statx flags
+    std::uint64_t tag;
+  };
+
+  using Callback = void (*)(void *ctx, std::uint64_t tag, int result);
+
+  bool setup(unsigned entries);
+  bool probe();
+  void teardown();
+  bool run_impl(Callback done, void *ctx);
+
+  int ring_fd_{-1};
+
+  // Submission queue ring
+  void *sq_ring_{nullptr};
+  std::size_t sq_ring_size_{0};
+  unsigned *sq_tail_{nullptr};
+  unsigned sq_mask_{0};
+  unsigned sq_entries_{0};
+  unsigned *sq_array_{nullptr};
+  void *sqes_{nullptr};
+  std::size_t sqes_size_{0};
+
+  // Completion queue ring (may share the SQ mapping)
+  void *cq_ring_{nullptr};
+  std::size_t cq_ring_size_{0};
+  unsigned *cq_head_{nullptr};
+  unsigned *cq_tail_{nullptr};
+  unsigned cq_mask_{0};
+  void *cqes_{nullptr};
+
+  std::vector<Op> ops_;
+};
+
+} // namespace logiq::file
@@ -0,0 +1,38 @@
+#include "framing/AnyFramer.hpp"
+
+namespace logiq::framing {
+
+std::optional<FramingFormat> parse_framing_format(const std::string &s) {
+  if (s == "lf")
+    return FramingFormat::Lf;
+  if (s == "crlf")
+    return FramingFormat::Crlf;
+  if (s == "nul")
+    return FramingFormat::Nul;
+  if (s == "length_prefixed")
+    return FramingFormat::LengthPrefixed;
+  if (s == "cri")
+    return FramingFormat::Cri;
+  return std::nullopt;
+}
+
+AnyFramer::AnyFramer(FramingFormat format) {
+  switch (format) {
+  case FramingFormat::Lf:
+    break; // the default alternative
+  case FramingFormat::Crlf:
+    framer_.emplace<BasicStreamFramer<CrlfFramer>>();
+    break;
+  case FramingFormat::Nul:
+    framer_.emplace<BasicStreamFramer<NulFramer>>();
+    break;
+  case FramingFormat::LengthPrefixed:
+    framer_.emplace<BasicStreamFramer<LengthPrefixedFramer>>();
+    break;
+  case FramingFormat::Cri:
+    framer_.emplace<BasicStreamFramer<CriFramer>>();
+    break;
+  }
+}
+
+} // namespace logiq::framing
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <chrono>
+#include <optional>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "framing/StreamFramer.hpp"
+
+namespace logiq::framing {
+
+// Record formats an input can be framed as.
+enum class FramingFormat {
+  Lf,             // '\n'-terminated lines
+  Crlf,           // "\r\n"-terminated lines
+  Nul,            // '\0'-terminated records
+  LengthPrefixed, // 4-byte big-endian length + payload
+  Cri             // CRI container log lines, partials joined
+};
+
+// Parses "lf" | "crlf" | "nul" | "length_prefixed" | "cri".
+std::optional<FramingFormat> parse_framing_format(const std::string &s);
+
+// The framer of one input: a BasicStreamFramer instantiated for each
+// format, picked at runtime.
+//
+// The per-byte and per-record loops live inside the concrete framers, so
+// dispatch costs one variant switch per chunk (visit()), not per record.
+class AnyFramer {
+public:
+  using Clock = std::chrono::steady_clock;
+  using Variant = std::variant<
+      BasicStreamFramer<LineFramer>, BasicStreamFramer<CrlfFramer>,
+      BasicStreamFramer<NulFramer>, BasicStreamFramer<LengthPrefixedFramer>,
+      BasicStreamFramer<CriFramer>>;
+
+  explicit AnyFramer(FramingFormat format = FramingFormat::Lf);
+
+  // Call fn with the concrete framer; use this on the hot path, e.g.
+  //   framer.visit([&](auto &f) { f.ingest(data, off); use(f.drain()); });
+  template <typename Fn> decltype(auto) visit(Fn &&fn) {
+    return std::visit(std::forward<Fn>(fn), framer_);
+  }
+
+  // See StreamFramer.
+  const std::vector<FramedRecord> &flush_expired(Clock::time_point now,
+                                                 bool force = false) {
+    return visit([&](auto &f) -> const std::vector<FramedRecord> & {
+      return f.flush_expired(now, force);
+    });
+  }
+  std::size_t buffered_bytes() const noexcept {
+    return std::visit([](const auto &f) { return f.buffered_bytes(); },
+                      framer_);
+  }
+  bool pending() const noexcept {
+    return std::visit([](const auto &f) { return f.pending(); }, framer_);
+  }
+  void reset() {
+    visit([](auto &f) { f.reset(); });
+  }
+  void set_parallel(ParallelFramer *parallel) noexcept {
+    visit([&](auto &f) { f.set_parallel(parallel); });
+  }
+  void set_limit(const LineLimit &limit) noexcept {
+    visit([&](auto &f) { f.set_limit(limit); });
+  }
+  void set_multiline(const LinePattern *start,
+                     std::chrono::milliseconds flush_timeout) noexcept {
+    visit([&](auto &f) { f.set_multiline(start, flush_timeout); });
+  }
+
+private:
+  Variant framer_;
+};
+
+} // namespace logiq::framing
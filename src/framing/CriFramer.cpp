@@ -0,0 +1,104 @@
+#include "framing/CriFramer.hpp"
+
+#include <algorithm>
+
+namespace logiq::framing {
+
+namespace {
+
+struct CriLine {
+  bool valid{false};
+  bool partial{false};
+  std::string_view content;
+};
+
+// "<time> <stream> <tag> <content>"; tag is "P" or "F", possibly followed
+// by further ':'-separated tags.
+CriLine parse(std::string_view line) {
+  constexpr auto npos = std::string_view::npos;
+  CriLine out;
+  const std::size_t stream = line.find(' ');
+  if (stream == npos || stream == 0)
+    return out;
+  const std::size_t tag = line.find(' ', stream + 1);
+  if (tag == npos || tag + 1 >= line.size())
+    return out;
+
+  const char kind = line[tag + 1];
+  if (kind != 'P' && kind != 'F')
+    return out;
+  const std::size_t content = line.find(' ', tag + 1);
+  const std::size_t tag_end = content == npos ? line.size() : content;
+  if (tag_end != tag + 2 && line[tag + 2] != ':')
+    return out;
+
+  out.valid = true;
+  out.partial = kind == 'P';
+  if (content != npos)
+    out.content = line.substr(content + 1);
+  return out;
+}
+
+} // namespace
+
+const std::vector<FramedRecord> &CriFramer::drain() {
+  out_.clear();
+  emitted_used_ = 0;
+
+  for (const auto &line : lines_.drain()) {
+    const CriLine cri = parse(line.payload);
+    if (!cri.valid) {
+      if (open_)
+        emit_joined();
+      out_.push_back(line);
+      continue;
+    }
+    if (!cri.partial && !open_) {
+      out_.push_back({cri.content, line.start_offset, line.end_offset});
+      continue;
+    }
+    join(cri.content, line);
+    if (!cri.partial)
+      emit_joined();
+  }
+  return out_;
+}
+
+void CriFramer::join(std::string_view content, const FramedRecord &line) {
+  const std::size_t max = limit_.max_bytes;
+  if (open_ && max > 0 && joined_.size() + content.size() > max) {
+    if (limit_.overflow == LineOverflow::Split) {
+      emit_joined();
+    } else {
+      content = content.substr(0, max - std::min(max, joined_.size()));
+    }
+  }
+
+  if (!open_) {
+    open_ = true;
+    joined_.clear();
+    joined_start_ = line.start_offset;
+  }
+  joined_.append(content);
+  joined_end_ = line.end_offset;
+}
+
+void CriFramer::emit_joined() {
+  if (emitted_used_ == emitted_.size())
+    emitted_.emplace_back();
+  std::string &slot = emitted_[emitted_used_++];
+  slot.swap(joined_);
+  joined_.clear();
+  out_.push_back({slot, joined_start_, joined_end_});
+  open_ = false;
+}
+
+void CriFramer::reset() {
+  lines_.reset();
+  out_.clear();
+  open_ = false;
+  joined_.clear();
+  emitted_used_ = 0;
+}
+
+} // namespace logiq::framing
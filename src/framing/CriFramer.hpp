@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "framing/Framer.hpp"
+#include "framing/LineFramer.hpp"
+
+namespace logiq::framing {
+
+// Frames container logs written by CRI runtimes (containerd, CRI-O):
+//
+//   <RFC3339 time> <stdout|stderr> <P|F> <content>
+//
+// The runtime splits long output lines into several "P" (partial) lines
+// closed by an "F" (full) line; these are joined back into one record
+// whose range spans all of them. Records carry only the content: time and
+// stream are dropped, as the agent stamps and labels records itself. Lines
+// that do not parse are passed through unchanged.
+//
+// Single-line records are views into the ingested data; joined records are
+// copied.
+class CriFramer {
+public:
+  // See LineFramer.
+  void ingest(std::string_view data, std::uint64_t base_offset) {
+    lines_.ingest(data, base_offset);
+  }
+
+  // Extract completed records. The returned vector is reused by the next
+  // call.
+  const std::vector<FramedRecord> &drain();
+
+  // Reset internal state (used on truncate or rotation); a record still
+  // waiting for its "F" line is dropped.
+  void reset();
+
+  // See LineFramer.
+  void set_parallel(ParallelFramer *parallel) noexcept {
+    lines_.set_parallel(parallel);
+  }
+
+  // See LineFramer; also bounds joined records. With Split a joined record
+  // is cut at line boundaries, with Truncate its tail is dropped.
+  void set_limit(const LineLimit &limit) noexcept {
+    lines_.set_limit(limit);
+    limit_ = limit;
+  }
+
+  // Carried line plus the partial lines joined so far.
+  std::size_t buffered_bytes() const noexcept {
+    return lines_.buffered_bytes() + joined_.size();
+  }
+
+private:
+  LineFramer lines_;
+  LineLimit limit_;
+
+  std::vector<FramedRecord> out_;
+
+  // Partial lines joined so far.
+  bool open_{false};
+  std::string joined_;
+  std::uint64_t joined_start_{0};
+  std::uint64_t joined_end_{0};
+
+  // Payloads of joined records handed out since the last drain(). Records
+  // view them, so slots must not move as more are added: a deque.
+  std::deque<std::string> emitted_;
+  std::size_t emitted_used_{0};
+
+private:
+  void join(std::string_view content, const FramedRecord &line);
+  void emit_joined();
+};
+
+} // namespace logiq::framing
@@ -0,0 +1,11 @@
+#include "framing/Framer.hpp"
+
+namespace logiq::framing {
+
+LineOverflow parse_line_overflow(const std::string &s) {
+  if (s == "truncate")
+    return LineOverflow::Truncate;
+  return LineOverflow::Split;
+}
+
+} // namespace logiq::framing
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace logiq::framing {
+
+// One framed record and the file byte-range it came from. Framers never
+// produce gaps or overlaps: consecutive records' ranges are contiguous, so
+// the end_offset of a shipped record is always a safe checkpoint.
+struct FramedRecord {
+  // Record bytes without the trailing '\n'. A view into either the data
+  // passed to ingest() or a buffer owned by the framer; valid until the
+  // next ingest(), drain() or reset().
+  std::string_view payload;
+  std::uint64_t start_offset{0};
+  std::uint64_t end_offset{0}; // exclusive
+};
+
+// What to do with a record longer than LineLimit::max_bytes.
+enum class LineOverflow {
+  Split,   // emit it as consecutive records of at most max_bytes each
+  Truncate // emit its first max_bytes; the rest of the record is dropped
+};
+
+// Parses "split" | "truncate". Unknown values map to Split.
+LineOverflow parse_line_overflow(const std::string &s);
+
+// Upper bound on record size. Either way every input byte stays covered by
+// exactly one record's [start_offset, end_offset): split pieces are
+// contiguous, and a truncated record's range still ends after its
+// terminator.
+struct LineLimit {
+  std::size_t max_bytes{0}; // 0 = unlimited
+  LineOverflow overflow{LineOverflow::Split};
+};
+
+// A framer turns a byte stream into records, in place where it can.
+//
+// ingest() borrows data (which must stay valid until the next drain()),
+// drain() returns the records completed so far, reset() forgets all state
+// (truncate or rotation), set_limit() bounds record size and thus the
+// framer's own buffers, and buffered_bytes() reports what those buffers
+// hold (for memory accounting). Framers are plain classes rather than a
+// virtual interface so the pipeline can be instantiated per framer and the
+// hot loops compiled without indirect calls.
+template <typename F>
+concept Framer = requires(F &f, std::string_view data, std::uint64_t offset,
+                          const LineLimit &limit) {
+  f.ingest(data, offset);
+  { f.drain() } -> std::same_as<const std::vector<FramedRecord> &>;
+  f.reset();
+  f.set_limit(limit);
+  { std::as_const(f).buffered_bytes() } -> std::convertible_to<std::size_t>;
+};
+
+} // namespace logiq::framing
@@ -0,0 +1,124 @@
+#include "framing/LengthPrefixedFramer.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace logiq::framing {
+
+namespace {
+
+std::size_t max_of(const LineLimit &limit) {
+  return limit.max_bytes > 0 ? limit.max_bytes
+                             : std::numeric_limits<std::size_t>::max();
+}
+
+} // namespace
+
+void LengthPrefixedFramer::ingest(std::string_view data,
+                                  std::uint64_t base_offset) {
+  // Records are framed right away; they view data, which the caller keeps
+  // alive until drain().
+  if (drained_) {
+    out_.clear();
+    emitted_used_ = 0;
+    drained_ = false;
+  }
+  frame(data, base_offset);
+}
+
+const std::vector<FramedRecord> &LengthPrefixedFramer::drain() {
+  if (drained_) {
+    out_.clear();
+    emitted_used_ = 0;
+  }
+  drained_ = true;
+  return out_;
+}
+
+void LengthPrefixedFramer::frame(std::string_view data, std::uint64_t base) {
+  std::size_t pos = 0;
+  while (pos < data.size()) {
+    if (!in_body_) {
+      if (header_len_ == 0)
+        record_start_ = base + pos;
+      const std::size_t n =
+          std::min(kHeaderBytes - header_len_, data.size() - pos);
+      std::memcpy(header_ + header_len_, data.data() + pos, n);
+      header_len_ += n;
+      pos += n;
+      if (header_len_ < kHeaderBytes)
+        return;
+      header_len_ = 0;
+      remaining_ = static_cast<std::uint64_t>(header_[0]) << 24 |
+                   static_cast<std::uint64_t>(header_[1]) << 16 |
+                   static_cast<std::uint64_t>(header_[2]) << 8 |
+                   static_cast<std::uint64_t>(header_[3]);
+      in_body_ = true;
+    }
+
+    const auto n = static_cast<std::size_t>(
+        std::min<std::uint64_t>(remaining_, data.size() - pos));
+    remaining_ -= n;
+    pos += n;
+    take_body(data.substr(pos - n, n), base + pos);
+  }
+}
+
+void LengthPrefixedFramer::take_body(std::string_view bytes,
+                                     std::uint64_t end) {
+  const std::size_t max = max_of(limit_);
+
+  if (limit_.overflow == LineOverflow::Split) {
+    std::uint64_t offset = end - bytes.size();
+    while (body_.size() + bytes.size() > max) {
+      const std::size_t n = max - body_.size();
+      offset += n;
+      if (body_.empty()) {
+        out_.push_back({bytes.substr(0, n), record_start_, offset});
+      } else {
+        body_.append(bytes.substr(0, n));
+        emit_owned(offset);
+      }
+      record_start_ = offset;
+      bytes.remove_prefix(n);
+    }
+  } else {
+    bytes = bytes.substr(0, max - body_.size());
+  }
+
+  if (remaining_ > 0) {
+    body_.append(bytes);
+    return;
+  }
+
+  in_body_ = false;
+  if (body_.empty()) {
+    out_.push_back({bytes, record_start_, end});
+  } else {
+    body_.append(bytes);
+    emit_owned(end);
+  }
+}
+
+void LengthPrefixedFramer::emit_owned(std::uint64_t end) {
+  if (emitted_used_ == emitted_.size())
+    emitted_.emplace_back();
+  std::string &slot = emitted_[emitted_used_++];
+  slot.swap(body_);
+  body_.clear();
+  out_.push_back({slot, record_start_, end});
+}
+
+void LengthPrefixedFramer::reset() {
+  out_.clear();
+  drained_ = true;
+  header_len_ = 0;
+  remaining_ = 0;
+  in_body_ = false;
+  record_start_ = 0;
+  body_.clear();
+  emitted_used_ = 0;
+}
+
+} // namespace logiq::framing
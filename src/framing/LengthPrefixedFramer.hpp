@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "framing/Framer.hpp"
+
+namespace logiq::framing {
+
+// Splits a stream of length-prefixed records: a 4-byte big-endian payload
+// length followed by that many payload bytes, as written by binary loggers
+// and message-queue dumps.
+//
+// Each record's range covers its header and payload. Records that lie
+// within one ingested chunk are returned as views; a record split across
+// chunks is reassembled in a buffer bounded by the LineLimit, so a corrupt
+// length cannot make the framer allocate more than max_bytes.
+class LengthPrefixedFramer {
+public:
+  static constexpr std::size_t kHeaderBytes = 4;
+
+  // data must stay valid until drain() has been called.
+  void ingest(std::string_view data, std::uint64_t base_offset);
+
+  // Extract completed records. The returned vector is reused by the next
+  // call.
+  const std::vector<FramedRecord> &drain();
+
+  void reset();
+
+  void set_limit(const LineLimit &limit) noexcept { limit_ = limit; }
+
+  // Bytes of the record being reassembled across chunks.
+  std::size_t buffered_bytes() const noexcept { return body_.size(); }
+
+private:
+  // Frame data into out_; called once per ingest().
+  void frame(std::string_view data, std::uint64_t base);
+
+  // Take the next body bytes of the current record, which end at file
+  // offset end; emits the record (or Split pieces) once complete.
+  void take_body(std::string_view bytes, std::uint64_t end);
+
+  // Emit body_ as a record ending at end.
+  void emit_owned(std::uint64_t end);
+
+  std::vector<FramedRecord> out_;
+  bool drained_{true}; // out_ was handed out; clear it on the next ingest
+
+  // Header bytes seen so far, and the body bytes still expected.
+  unsigned char header_[kHeaderBytes]{};
+  std::size_t header_len_{0};
+  std::uint64_t remaining_{0};
+  bool in_body_{false};
+
+  // File offset where the current record (or Split piece) starts.
+  std::uint64_t record_start_{0};
+  // Body of a record that spans chunks; at most max_bytes.
+  std::string body_;
+
+  // Owned payloads handed out since the last drain(); a deque, so
+  // handed-out views stay put while more records are added (a vector would
+  // move short strings' inline bytes when it grows).
+  std::deque<std::string> emitted_;
+  std::size_t emitted_used_{0};
+
+  LineLimit limit_;
+};
+
+} // namespace logiq::framing
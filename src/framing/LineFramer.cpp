@@ -1,46 +1,194 @@
 #include "framing/LineFramer.hpp"
+#include "framing/NewlineScanner.hpp"
+#include "framing/ParallelFramer.hpp"
+
+#include <algorithm>
+#include <limits>
 
 namespace logiq::framing {
 
-void LineFramer::ingest(const std::string &data, std::uint64_t base_offset) {
-  if (buffer_.empty()) {
-    buffer_start_offset_ = base_offset;
+namespace {
+
+constexpr std::size_t kNpos = std::string_view::npos;
+
+std::size_t max_of(const LineLimit &limit) {
+  return limit.max_bytes > 0 ? limit.max_bytes
+                             : std::numeric_limits<std::size_t>::max();
+}
+
+} // namespace
+
+void emit_line(const LineLimit &limit, std::string_view data,
+               std::size_t begin, std::size_t end, std::size_t delim,
+               std::uint64_t base, std::vector<FramedRecord> &out) {
+  const std::size_t max = max_of(limit);
+  std::size_t pos = begin;
+
+  if (limit.overflow == LineOverflow::Split) {
+    while (end - pos > max) {
+      out.push_back({data.substr(pos, max), base + pos, base + pos + max});
+      pos += max;
+    }
   }
-  buffer_ += data;
+
+  FramedRecord rec;
+  rec.payload = data.substr(pos, std::min(end - pos, max));
+  rec.start_offset = base + pos;
+  rec.end_offset = base + delim + 1; // include the terminator
+  out.push_back(rec);
 }
 
-std::vector<FramedRecord> LineFramer::drain() {
-  std::vector<FramedRecord> out;
+template <typename Format>
+void BasicLineFramer<Format>::ingest(std::string_view data,
+                                     std::uint64_t base_offset) {
+  // Two ingests without a drain: frame the earlier data now, so the carry
+  // buffer only ever holds an unterminated tail.
+  frame_pending();
+  pending_ = data;
+  pending_offset_ = base_offset;
+}
+
+template <typename Format>
+const std::vector<FramedRecord> &BasicLineFramer<Format>::drain() {
+  frame_pending();
+  drained_ = true;
+  return out_;
+}
+
+template <typename Format> void BasicLineFramer<Format>::frame_pending() {
+  if (drained_) {
+    out_.clear();
+    joined_used_ = 0;
+    drained_ = false;
+  }
+
+  std::string_view data = pending_;
+  pending_ = {};
 
   std::size_t pos = 0;
-  while (true) {
-    auto newline = buffer_.find('\n', pos);
-    if (newline == std::string::npos)
-      break;
 
-    std::size_t record_len = newline - pos;
+  // Complete the line carried over from previous chunks, if any.
+  if (!carry_.empty()) {
+    pos = continue_carry(data);
+    if (pos == kNpos)
+      return;
+  }
 
-    FramedRecord rec;
-    rec.payload = buffer_.substr(pos, record_len);
-    rec.start_offset = buffer_start_offset_ + pos;
-    rec.end_offset = rec.start_offset + record_len + 1; // include '\n'
+  // Big backlog chunk: split it across cores.
+  if (parallel_ && data.size() - pos >= parallel_->min_bytes()) {
+    pos += parallel_->frame<Format>(data.substr(pos), pending_offset_ + pos,
+                                    out_, limit_);
+  }
+
+  // Find every line end of the rest in one vectorized pass, then cut.
+  newlines_.clear();
+  NewlineScanner::scan(data.substr(pos), newlines_, Format::kDelim);
+  out_.reserve(out_.size() + newlines_.size());
+
+  const std::size_t scan_base = pos;
+  for (std::size_t nl : newlines_) {
+    const std::size_t delim = scan_base + nl;
+    emit_line(limit_, data, pos, payload_end<Format>(data, pos, delim), delim,
+              pending_offset_, out_);
+    pos = delim + 1;
+  }
+
+  // Copy the unterminated tail; everything else stays in place.
+  carry_tail(data, pos);
+}
+
+template <typename Format>
+std::size_t BasicLineFramer<Format>::continue_carry(std::string_view data) {
+  const std::size_t max = max_of(limit_);
+  const std::size_t delim = data.find(Format::kDelim);
 
-    out.push_back(std::move(rec));
+  // Hand finished lines out from a joined_ slot so carry_ can be reused.
+  auto emit_carry = [&](std::uint64_t end_offset) {
+    if (joined_used_ == joined_.size())
+      joined_.emplace_back();
+    std::string &slot = joined_[joined_used_++];
+    slot.swap(carry_);
+    carry_.clear();
+    out_.push_back({slot, carry_start_offset_, end_offset});
+  };
 
-    pos = newline + 1;
+  if (limit_.overflow == LineOverflow::Truncate) {
+    const std::size_t head = delim == kNpos ? data.size() : delim;
+    if (carry_.size() < max)
+      carry_.append(data.substr(0, std::min(head, max - carry_.size())));
+    if (delim == kNpos) {
+      if constexpr (Format::kStripCr) {
+        if (!data.empty())
+          carry_cr_ = data.back() == '\r';
+      }
+      return kNpos;
+    }
+    if constexpr (Format::kStripCr) {
+      // The '\r' before the terminator is in carry_ unless it was cut off.
+      const bool cr = delim > 0 ? data[delim - 1] == '\r' : carry_cr_;
+      if (cr && carry_.size() >= pending_offset_ + delim - carry_start_offset_)
+        carry_.pop_back();
+    }
+    emit_carry(pending_offset_ + delim + 1); // include the terminator
+    return delim + 1;
   }
 
-  if (pos > 0) {
-    buffer_.erase(0, pos);
-    buffer_start_offset_ += pos;
+  // Split: the carried piece has room for max - size() more bytes.
+  const std::size_t room = carry_.size() < max ? max - carry_.size() : 0;
+  if (delim != kNpos && payload_end<Format>(data, 0, delim) <= room) {
+    carry_.append(data.substr(0, payload_end<Format>(data, 0, delim)));
+    if constexpr (Format::kStripCr) {
+      if (delim == 0 && carry_.back() == '\r')
+        carry_.pop_back();
+    }
+    emit_carry(pending_offset_ + delim + 1); // include the terminator
+    return delim + 1;
   }
+  if (data.size() <= room) {
+    carry_.append(data);
+    return kNpos;
+  }
+  // Full piece; the line goes on in data[room...].
+  carry_.append(data.substr(0, room));
+  emit_carry(pending_offset_ + room);
+  return room;
+}
 
-  return out;
+template <typename Format>
+void BasicLineFramer<Format>::carry_tail(std::string_view data,
+                                         std::size_t pos) {
+  const std::size_t max = max_of(limit_);
+
+  if (limit_.overflow == LineOverflow::Split) {
+    while (data.size() - pos > max) {
+      out_.push_back({data.substr(pos, max), pending_offset_ + pos,
+                      pending_offset_ + pos + max});
+      pos += max;
+    }
+  }
+
+  if (pos < data.size()) {
+    carry_.assign(data.substr(pos, std::min(data.size() - pos, max)));
+    carry_start_offset_ = pending_offset_ + pos;
+    if constexpr (Format::kStripCr)
+      carry_cr_ = data.back() == '\r';
+  }
 }
 
-void LineFramer::reset() {
-  buffer_.clear();
-  buffer_start_offset_ = 0;
+template <typename Format> void BasicLineFramer<Format>::reset() {
+  pending_ = {};
+  pending_offset_ = 0;
+  carry_.clear();
+  carry_start_offset_ = 0;
+  carry_cr_ = false;
+  joined_.clear();
+  joined_used_ = 0;
+  out_.clear();
+  drained_ = true;
 }
 
+template class BasicLineFramer<LfFormat>;
+template class BasicLineFramer<CrlfFormat>;
+template class BasicLineFramer<NulFormat>;
+
 } // namespace logiq::framing
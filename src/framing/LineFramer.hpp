@@ -1,31 +1,139 @@
 #pragma once
 
 #include <cstdint>
+#include <deque>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include "framing/Framer.hpp"
+
 namespace logiq::framing {
 
-struct FramedRecord {
-  std::string payload;
-  std::uint64_t start_offset{0};
-  std::uint64_t end_offset{0}; // exclusive
+class ParallelFramer;
+
+// Record terminators understood by BasicLineFramer.
+struct LfFormat {
+  static constexpr char kDelim = '\n';
+  static constexpr bool kStripCr = false;
+};
+// "\r\n" line ends (Windows writers): the '\r' is dropped from payloads
+// but stays inside the record's byte range. (With a Split limit, a line
+// whose "\r\n" straddles a piece boundary ends in an empty piece.)
+struct CrlfFormat {
+  static constexpr char kDelim = '\n';
+  static constexpr bool kStripCr = true;
 };
+// NUL-separated records (e.g. find -print0, some journald exports).
+struct NulFormat {
+  static constexpr char kDelim = '\0';
+  static constexpr bool kStripCr = false;
+};
+
+// Append the record(s) for data[begin, end) per limit, where data[0] is at
+// file offset base and data[delim] is the record's terminator (end is
+// delim, or delim - 1 with a stripped '\r'). The last record's range ends
+// after the terminator.
+void emit_line(const LineLimit &limit, std::string_view data,
+               std::size_t begin, std::size_t end, std::size_t delim,
+               std::uint64_t base, std::vector<FramedRecord> &out);
+
+// Payload end of the record starting at data[begin] whose terminator is at
+// data[delim].
+template <typename Format>
+std::size_t payload_end(std::string_view data, std::size_t begin,
+                        std::size_t delim) {
+  if constexpr (Format::kStripCr) {
+    if (delim > begin && data[delim - 1] == '\r')
+      return delim - 1;
+  }
+  return delim;
+}
 
-class LineFramer {
+// Splits a byte stream into records terminated by Format::kDelim, in place.
+//
+// Complete lines are returned as views into the ingested data, so the
+// caller must keep that data alive until it is done with the records
+// (ReadChunk::buffer does this). Only the unterminated tail of a chunk is
+// copied, into a carry buffer that is reused across chunks. With a
+// LineLimit the carry buffer never holds more than max_bytes, so framer
+// memory stays bounded even if a writer never emits a terminator.
+//
+// Instantiated (in LineFramer.cpp) for LfFormat, CrlfFormat and NulFormat.
+template <typename Format> class BasicLineFramer {
 public:
-  // Ingest raw bytes from file with base file offset
-  void ingest(const std::string &data, std::uint64_t base_offset);
+  // Ingest raw bytes from file with base file offset. data is not copied
+  // here; it must stay valid until drain() has been called. Ingesting
+  // again before a drain() frames the earlier data first; drain() then
+  // returns the records of both.
+  void ingest(std::string_view data, std::uint64_t base_offset);
 
-  // Extract completed records
-  std::vector<FramedRecord> drain();
+  // Extract completed records. The returned vector is reused by the next
+  // call.
+  const std::vector<FramedRecord> &drain();
 
   // Reset internal state (used on truncate or rotation)
   void reset();
 
+  // Frame large chunks (>= ParallelFramer::min_bytes()) on several cores.
+  // The ParallelFramer may be shared by framers used from one thread.
+  void set_parallel(ParallelFramer *parallel) noexcept {
+    parallel_ = parallel;
+  }
+
+  // Bound record (and carry buffer) size; takes effect on the next line.
+  void set_limit(const LineLimit &limit) noexcept { limit_ = limit; }
+
+  // Bytes of the unterminated line carried to the next chunk.
+  std::size_t buffered_bytes() const noexcept { return carry_.size(); }
+
 private:
-  std::string buffer_;
-  std::uint64_t buffer_start_offset_{0};
+  // Ingested, not yet drained data (borrowed from the caller).
+  std::string_view pending_;
+  std::uint64_t pending_offset_{0};
+
+  // Unterminated tail carried over from earlier chunks; at most
+  // max_bytes with a limit (Truncate drops the rest of the line).
+  std::string carry_;
+  std::uint64_t carry_start_offset_{0};
+
+  // Truncate with CRLF: the last byte of the line so far was '\r' (it may
+  // have been dropped from carry_).
+  bool carry_cr_{false};
+
+  // Lines completed across chunks since the last drain(); records view
+  // them until the next one. A deque, so the slots never move.
+  std::deque<std::string> joined_;
+  std::size_t joined_used_{0};
+
+  // out_ was handed out by drain(); the next framing starts it afresh.
+  bool drained_{true};
+
+  std::vector<FramedRecord> out_;
+
+  // Terminator positions of the chunk being drained (see NewlineScanner).
+  std::vector<std::size_t> newlines_;
+
+  ParallelFramer *parallel_{nullptr};
+  LineLimit limit_;
+
+private:
+  // Frame pending_ into out_ (after the records of earlier ingests since
+  // the last drain()).
+  void frame_pending();
+
+  // Complete (or extend) the carried line with the head of data. Returns
+  // the position in data where unframed bytes start, or npos if all of
+  // data went into the carry buffer.
+  std::size_t continue_carry(std::string_view data);
+
+  // Frame an unterminated tail: full Split pieces are emitted, the rest
+  // is carried.
+  void carry_tail(std::string_view data, std::size_t pos);
 };
 
+using LineFramer = BasicLineFramer<LfFormat>;
+using CrlfFramer = BasicLineFramer<CrlfFormat>;
+using NulFramer = BasicLineFramer<NulFormat>;
+
 } // namespace logiq::framing
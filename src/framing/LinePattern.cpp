@@ -0,0 +1,502 @@
+#include "framing/LinePattern.hpp"
+
+#include <algorithm>
+#include <bitset>
+#include <stdexcept>
+
+namespace logiq::framing {
+
+namespace {
+
+using ByteClass = std::bitset<256>;
+
+struct Node {
+  enum Kind { Leaf, Empty, Concat, Alt, Star, Plus, Opt };
+
+  Kind kind{Empty};
+  ByteClass cls{};         // Leaf
+  std::vector<Node> kids{}; // Concat, Alt, Star, Plus, Opt
+};
+
+std::size_t count_leaves(const Node &n) {
+  if (n.kind == Node::Leaf)
+    return 1;
+  std::size_t total = 0;
+  for (const auto &k : n.kids)
+    total += count_leaves(k);
+  return total;
+}
+
+Node wrap(Node::Kind kind, Node inner) {
+  Node n{kind};
+  n.kids.push_back(std::move(inner));
+  return n;
+}
+
+// Recursive-descent parser: alt := concat ('|' concat)*,
+// concat := repeat*, repeat := atom quantifier*.
+class Parser {
+public:
+  explicit Parser(std::string_view s) : s_(s) {}
+
+  Node parse(bool &anchored_end) {
+    if (more() && s_[i_] == '^')
+      ++i_;
+    Node n = alt();
+    if (at_final_dollar()) {
+      anchored_end = true;
+      ++i_;
+    }
+    if (more())
+      fail("unexpected '" + std::string(1, s_[i_]) + "'");
+    return n;
+  }
+
+private:
+  std::string_view s_;
+  std::size_t i_{0};
+
+  bool more() const { return i_ < s_.size(); }
+  bool at_final_dollar() const {
+    return more() && s_[i_] == '$' && i_ + 1 == s_.size();
+  }
+
+  [[noreturn]] void fail(const std::string &what) const {
+    throw std::invalid_argument("LinePattern: " + what + " at offset " +
+                                std::to_string(i_) + " in '" +
+                                std::string(s_) + "'");
+  }
+
+  Node alt() {
+    Node first = concat();
+    if (!more() || s_[i_] != '|')
+      return first;
+    Node n{Node::Alt};
+    n.kids.push_back(std::move(first));
+    while (more() && s_[i_] == '|') {
+      ++i_;
+      n.kids.push_back(concat());
+    }
+    return n;
+  }
+
+  Node concat() {
+    Node n{Node::Concat};
+    while (more() && s_[i_] != '|' && s_[i_] != ')' && !at_final_dollar())
+      n.kids.push_back(repeat());
+    return n;
+  }
+
+  Node repeat() {
+    Node n = atom();
+    while (more()) {
+      const char c = s_[i_];
+      if (c == '*') {
+        n = wrap(Node::Star, std::move(n));
+      } else if (c == '+') {
+        n = wrap(Node::Plus, std::move(n));
+      } else if (c == '?') {
+        n = wrap(Node::Opt, std::move(n));
+      } else if (c == '{') {
+        n = counted(std::move(n));
+        continue;
+      } else {
+        break;
+      }
+      ++i_;
+    }
+    return n;
+  }
+
+  std::size_t number() {
+    std::size_t v = 0;
+    const std::size_t start = i_;
+    while (more() && s_[i_] >= '0' && s_[i_] <= '9') {
+      v = v * 10 + static_cast<std::size_t>(s_[i_] - '0');
+      if (v > LinePattern::kMaxPositions)
+        fail("repeat count too large");
+      ++i_;
+    }
+    if (i_ == start)
+      fail("expected a number");
+    return v;
+  }
+
+  // {n}, {n,}, {n,m}: expanded into n copies plus m - n optional copies
+  // (or a star), since a position automaton has no counters.
+  Node counted(Node inner) {
+    ++i_; // '{'
+    const std::size_t min = number();
+    std::size_t max = min;
+    bool unbounded = false;
+    if (more() && s_[i_] == ',') {
+      ++i_;
+      if (more() && s_[i_] == '}')
+        unbounded = true;
+      else
+        max = number();
+    }
+    if (!more() || s_[i_] != '}')
+      fail("expected '}'");
+    ++i_;
+    if (max < min)
+      fail("bad repeat range");
+
+    const std::size_t copies = unbounded ? min + 1 : max;
+    if (count_leaves(inner) * copies > LinePattern::kMaxPositions)
+      fail("pattern too large");
+
+    Node n{Node::Concat};
+    for (std::size_t k = 0; k < min; ++k)
+      n.kids.push_back(inner);
+    if (unbounded) {
+      n.kids.push_back(wrap(Node::Star, std::move(inner)));
+    } else {
+      for (std::size_t k = min; k < max; ++k)
+        n.kids.push_back(wrap(Node::Opt, inner));
+    }
+    return n;
+  }
+
+  static ByteClass shorthand(char c) {
+    ByteClass cls;
+    auto range = [&](int lo, int hi) {
+      for (int b = lo; b <= hi; ++b)
+        cls.set(static_cast<std::size_t>(b));
+    };
+    switch (c) {
+    case 'd':
+    case 'D':
+      range('0', '9');
+      break;
+    case 'w':
+    case 'W':
+      range('0', '9');
+      range('a', 'z');
+      range('A', 'Z');
+      cls.set('_');
+      break;
+    case 's':
+    case 'S':
+      for (char s : {' ', '\t', '\r', '\n', '\f', '\v'})
+        cls.set(static_cast<unsigned char>(s));
+      break;
+    default:
+      break;
+    }
+    if (c == 'D' || c == 'W' || c == 'S')
+      cls.flip();
+    return cls;
+  }
+
+  static int hex(char c) {
+    if (c >= '0' && c <= '9')
+      return c - '0';
+    if (c >= 'a' && c <= 'f')
+      return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+      return c - 'A' + 10;
+    return -1;
+  }
+
+  // After a backslash: a class for shorthands, else a single byte.
+  ByteClass escape() {
+    if (!more())
+      fail("trailing backslash");
+    const char c = s_[i_++];
+    ByteClass cls;
+    switch (c) {
+    case 'd':
+    case 'D':
+    case 'w':
+    case 'W':
+    case 's':
+    case 'S':
+      return shorthand(c);
+    case 't':
+      cls.set('\t');
+      return cls;
+    case 'x': {
+      const int hi = i_ < s_.size() ? hex(s_[i_]) : -1;
+      const int lo = i_ + 1 < s_.size() ? hex(s_[i_ + 1]) : -1;
+      if (hi < 0 || lo < 0)
+        fail("bad \\x escape");
+      i_ += 2;
+      cls.set(static_cast<std::size_t>(hi * 16 + lo));
+      return cls;
+    }
+    default:
+      cls.set(static_cast<unsigned char>(c));
+      return cls;
+    }
+  }
+
+  ByteClass bracket() {
+    ByteClass cls;
+    bool negate = false;
+    if (more() && s_[i_] == '^') {
+      negate = true;
+      ++i_;
+    }
+    bool first = true;
+    while (true) {
+      if (!more())
+        fail("unterminated '['");
+      char c = s_[i_];
+      if (c == ']' && !first) {
+        ++i_;
+        break;
+      }
+      first = false;
+      ++i_;
+
+      ByteClass item;
+      if (c == '\\') {
+        item = escape();
+      } else {
+        item.set(static_cast<unsigned char>(c));
+      }
+
+      // Range a-z (only between single bytes).
+      if (item.count() == 1 && i_ + 1 < s_.size() && s_[i_] == '-' &&
+          s_[i_ + 1] != ']') {
+        ++i_;
+        char hi = s_[i_++];
+        if (hi == '\\') {
+          ByteClass h = escape();
+          if (h.count() != 1)
+            fail("bad range");
+          std::size_t b = 0;
+          while (!h.test(b))
+            ++b;
+          hi = static_cast<char>(b);
+        }
+        std::size_t lo = 0;
+        while (!item.test(lo))
+          ++lo;
+        const auto hi_b = static_cast<unsigned char>(hi);
+        if (hi_b < lo)
+          fail("bad range");
+        for (std::size_t b = lo; b <= hi_b; ++b)
+          item.set(b);
+      }
+      cls |= item;
+    }
+    if (negate)
+      cls.flip();
+    return cls;
+  }
+
+  Node atom() {
+    const char c = s_[i_++];
+    Node n{Node::Leaf};
+    switch (c) {
+    case '(': {
+      // Accept non-capturing groups; nothing is captured anyway.
+      if (i_ + 1 < s_.size() && s_[i_] == '?' && s_[i_ + 1] == ':')
+        i_ += 2;
+      Node inner = alt();
+      if (!more() || s_[i_] != ')')
+        fail("missing ')'");
+      ++i_;
+      return inner;
+    }
+    case '[':
+      n.cls = bracket();
+      return n;
+    case '.':
+      n.cls.set();
+      return n;
+    case '\\':
+      n.cls = escape();
+      return n;
+    case '*':
+    case '+':
+    case '?':
+    case '{':
+      --i_;
+      fail("nothing to repeat");
+    default:
+      n.cls.set(static_cast<unsigned char>(c));
+      return n;
+    }
+  }
+};
+
+// Glushkov construction over the parsed tree.
+class Builder {
+public:
+  using Bits = std::vector<std::uint64_t>;
+
+  struct Info {
+    bool nullable{false};
+    Bits first;
+    Bits last;
+  };
+
+  Builder(std::size_t words, std::vector<Bits> &follow,
+          std::vector<ByteClass> &classes)
+      : words_(words), follow_(follow), classes_(classes) {}
+
+  Info build(const Node &n) {
+    switch (n.kind) {
+    case Node::Leaf: {
+      const std::size_t p = classes_.size();
+      classes_.push_back(n.cls);
+      Info info = empty();
+      set(info.first, p);
+      set(info.last, p);
+      return info;
+    }
+    case Node::Empty:
+      return nullable_empty();
+    case Node::Concat: {
+      Info acc = nullable_empty();
+      for (const auto &k : n.kids) {
+        Info next = build(k);
+        link(acc.last, next.first);
+        if (acc.nullable)
+          merge(acc.first, next.first);
+        if (next.nullable) {
+          merge(next.last, acc.last);
+        }
+        acc.last = std::move(next.last);
+        acc.nullable = acc.nullable && next.nullable;
+      }
+      return acc;
+    }
+    case Node::Alt: {
+      Info acc = empty();
+      for (const auto &k : n.kids) {
+        Info next = build(k);
+        acc.nullable = acc.nullable || next.nullable;
+        merge(acc.first, next.first);
+        merge(acc.last, next.last);
+      }
+      return acc;
+    }
+    case Node::Star:
+    case Node::Plus:
+    case Node::Opt: {
+      Info info = build(n.kids.front());
+      if (n.kind != Node::Opt)
+        link(info.last, info.first);
+      if (n.kind != Node::Plus)
+        info.nullable = true;
+      return info;
+    }
+    }
+    return empty();
+  }
+
+  void set(Bits &b, std::size_t p) const { b[p / 64] |= 1ULL << (p % 64); }
+
+  void merge(Bits &into, const Bits &from) const {
+    for (std::size_t w = 0; w < words_; ++w)
+      into[w] |= from[w];
+  }
+
+  // Every position in from may be followed by every position in to.
+  void link(const Bits &from, const Bits &to) {
+    for (std::size_t w = 0; w < words_; ++w) {
+      std::uint64_t m = from[w];
+      while (m) {
+        const auto p = w * 64 + static_cast<std::size_t>(__builtin_ctzll(m));
+        merge(follow_[p], to);
+        m &= m - 1;
+      }
+    }
+  }
+
+private:
+  std::size_t words_;
+  std::vector<Bits> &follow_;
+  std::vector<ByteClass> &classes_;
+
+  Info empty() const { return Info{false, Bits(words_), Bits(words_)}; }
+  Info nullable_empty() const { return Info{true, Bits(words_), Bits(words_)}; }
+};
+
+} // namespace
+
+LinePattern::LinePattern(std::string_view pattern) : source_(pattern) {
+  Node root = Parser(pattern).parse(anchored_end_);
+
+  const std::size_t positions = count_leaves(root) + 1; // + start state
+  if (positions > kMaxPositions)
+    throw std::invalid_argument("LinePattern: pattern too large: " + source_);
+  words_ = (positions + 63) / 64;
+
+  follow_.assign(positions, Bits(words_));
+  std::vector<ByteClass> classes;
+  classes.reserve(positions);
+  classes.emplace_back(); // start state matches no byte
+
+  Builder b(words_, follow_, classes);
+  auto info = b.build(root);
+
+  // The start state leads to the pattern's first positions.
+  b.merge(follow_[0], info.first);
+
+  accept_ = info.last;
+  if (info.nullable)
+    b.set(accept_, 0);
+
+  byte_.assign(256 * words_, 0);
+  for (std::size_t p = 1; p < classes.size(); ++p) {
+    for (std::size_t c = 0; c < 256; ++c) {
+      if (classes[p].test(c))
+        byte_[c * words_ + p / 64] |= 1ULL << (p % 64);
+    }
+  }
+}
+
+bool LinePattern::matches(std::string_view line) const {
+  // kMaxPositions bounds words_, so the state fits on the stack.
+  constexpr std::size_t kMaxWords = (kMaxPositions + 63) / 64;
+  std::uint64_t cur[kMaxWords] = {1}; // start state
+  std::uint64_t next[kMaxWords];
+
+  auto accepting = [&](const std::uint64_t *state) {
+    for (std::size_t w = 0; w < words_; ++w) {
+      if (state[w] & accept_[w])
+        return true;
+    }
+    return false;
+  };
+
+  if (!anchored_end_ && accepting(cur))
+    return true;
+
+  for (char ch : line) {
+    std::fill(next, next + words_, 0);
+    for (std::size_t w = 0; w < words_; ++w) {
+      std::uint64_t m = cur[w];
+      while (m) {
+        const auto p = w * 64 + static_cast<std::size_t>(__builtin_ctzll(m));
+        const Bits &f = follow_[p];
+        for (std::size_t v = 0; v < words_; ++v)
+          next[v] |= f[v];
+        m &= m - 1;
+      }
+    }
+
+    const std::uint64_t *allowed =
+        &byte_[static_cast<unsigned char>(ch) * words_];
+    std::uint64_t live = 0;
+    for (std::size_t w = 0; w < words_; ++w) {
+      next[w] &= allowed[w];
+      live |= next[w];
+    }
+    if (!live)
+      return false;
+
+    std::copy(next, next + words_, cur);
+    if (!anchored_end_ && accepting(cur))
+      return true;
+  }
+
+  return accepting(cur);
+}
+
+} // namespace logiq::framing
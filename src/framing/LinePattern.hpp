@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace logiq::framing {
+
+// A regular expression compiled once into a bit-parallel position automaton
+// (Glushkov), used to test whether a line starts a new multiline record.
+//
+// Matching never backtracks: each byte costs one table lookup and a few
+// bitset operations per active position, so time is linear in the line
+// length whatever the pattern. The pattern is anchored at the start of the
+// line (a leading '^' is accepted and ignored) and matches a prefix unless
+// it ends with '$'.
+//
+// Supported syntax: literals, '.', classes ("[a-z_]", "[^ ]"), escapes
+// \d \D \w \W \s \S \t \xHH and escaped metacharacters, groups "( )",
+// alternation '|', and the quantifiers * + ? {n} {n,} {n,m}.
+class LinePattern {
+public:
+  // Upper bound on pattern positions (character classes after expanding
+  // counted repeats).
+  static constexpr std::size_t kMaxPositions = 1024;
+
+  // Throws std::invalid_argument on a syntax error or an oversized pattern.
+  explicit LinePattern(std::string_view pattern);
+
+  bool matches(std::string_view line) const;
+
+  const std::string &source() const noexcept { return source_; }
+
+private:
+  // A set of positions; position 0 is the start state.
+  using Bits = std::vector<std::uint64_t>;
+
+  std::string source_;
+  bool anchored_end_{false};
+  std::size_t words_{0};
+
+  // follow_[p]: positions that may come after position p.
+  std::vector<Bits> follow_;
+  // accept_: positions a match may end in (0 if the pattern is nullable).
+  Bits accept_;
+  // byte_[c]: positions whose class contains byte c, words_ per byte.
+  std::vector<std::uint64_t> byte_;
+};
+
+} // namespace logiq::framing
@@ -0,0 +1,141 @@
+#include "framing/NewlineScanner.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define LOGIQ_SCAN_X86 1
+#endif
+
+namespace logiq::framing {
+
+namespace {
+
+using ScanFn = void (*)(const char *p, std::size_t n, char delim,
+                        std::vector<std::size_t> &out);
+
+void scan_scalar(const char *p, std::size_t n, char delim,
+                 std::vector<std::size_t> &out) {
+  const char *cur = p;
+  const char *end = p + n;
+  while (cur < end) {
+    const auto *nl = static_cast<const char *>(
+        std::memchr(cur, delim, static_cast<std::size_t>(end - cur)));
+    if (!nl)
+      break;
+    out.push_back(static_cast<std::size_t>(nl - p));
+    cur = nl + 1;
+  }
+}
+
+#ifdef LOGIQ_SCAN_X86
+
+// Emit the positions of the set bits of mask, offset by base.
+inline void emit(std::uint64_t mask, std::size_t base,
+                 std::vector<std::size_t> &out) {
+  while (mask) {
+    out.push_back(base + static_cast<std::size_t>(__builtin_ctzll(mask)));
+    mask &= mask - 1;
+  }
+}
+
+__attribute__((target("sse2"))) void
+scan_sse2(const char *p, std::size_t n, char delim,
+          std::vector<std::size_t> &out) {
+  const __m128i nl = _mm_set1_epi8(delim);
+  std::size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const __m128i v =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+    const auto mask = static_cast<std::uint32_t>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(v, nl)));
+    emit(mask, i, out);
+  }
+  for (; i < n; ++i) {
+    if (p[i] == delim)
+      out.push_back(i);
+  }
+}
+
+__attribute__((target("avx2"))) void
+scan_avx2(const char *p, std::size_t n, char delim,
+          std::vector<std::size_t> &out) {
+  const __m256i nl = _mm256_set1_epi8(delim);
+  std::size_t i = 0;
+  // 64 bytes per step: one 64-bit mask, one branch when there is no match.
+  for (; i + 64 <= n; i += 64) {
+    const __m256i a =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i));
+    const __m256i b =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i + 32));
+    const auto lo = static_cast<std::uint32_t>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(a, nl)));
+    const auto hi = static_cast<std::uint32_t>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(b, nl)));
+    emit(lo | (static_cast<std::uint64_t>(hi) << 32), i, out);
+  }
+  for (; i + 32 <= n; i += 32) {
+    const __m256i a =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i));
+    emit(static_cast<std::uint32_t>(
+             _mm256_movemask_epi8(_mm256_cmpeq_epi8(a, nl))),
+         i, out);
+  }
+  for (; i < n; ++i) {
+    if (p[i] == delim)
+      out.push_back(i);
+  }
+}
+
+#endif // LOGIQ_SCAN_X86
+
+struct Impl {
+  ScanFn fn;
+  const char *name;
+};
+
+Impl pick() {
+#ifdef LOGIQ_SCAN_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return {scan_avx2, "avx2"};
+  if (__builtin_cpu_supports("sse2"))
+    return {scan_sse2, "sse2"};
+#endif
+  return {scan_scalar, "scalar"};
+}
+
+Impl &impl() {
+  static Impl chosen = pick();
+  return chosen;
+}
+
+} // namespace
+
+void NewlineScanner::scan(std::string_view data,
+                          std::vector<std::size_t> &out, char delim) {
+  impl().fn(data.data(), data.size(), delim, out);
+}
+
+const char *NewlineScanner::isa() noexcept { return impl().name; }
+
+bool NewlineScanner::use(std::string_view isa) noexcept {
+  if (isa == "scalar") {
+    impl() = {scan_scalar, "scalar"};
+    return true;
+  }
+#ifdef LOGIQ_SCAN_X86
+  if (isa == "sse2" && __builtin_cpu_supports("sse2")) {
+    impl() = {scan_sse2, "sse2"};
+    return true;
+  }
+  if (isa == "avx2" && __builtin_cpu_supports("avx2")) {
+    impl() = {scan_avx2, "avx2"};
+    return true;
+  }
+#endif
+  return false;
+}
+
+} // namespace logiq::framing
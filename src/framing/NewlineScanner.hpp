@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+namespace logiq::framing {
+
+// Finds all '\n' (or other delimiter) bytes of a block in one pass.
+//
+// On x86 the block is compared 32 (AVX2) or 16 (SSE2) bytes at a time and
+// every match in the resulting bit mask is emitted, so the cost per line is
+// a few instructions instead of one memchr() call. The implementation is
+// picked once at runtime from the CPU's features; other architectures use a
+// scalar memchr() loop.
+class NewlineScanner {
+public:
+  // Append the position (relative to data) of every delim byte in data to
+  // out, in increasing order. out is not cleared, so callers can reuse one
+  // array across blocks without reallocating.
+  static void scan(std::string_view data, std::vector<std::size_t> &out,
+                   char delim = '\n');
+
+  // "avx2", "sse2" or "scalar": the implementation used on this CPU.
+  static const char *isa() noexcept;
+
+  // Switch to the named implementation, for benchmarks and tests; false
+  // (and no change) if this CPU or build lacks it. Not thread-safe: call
+  // before any scan().
+  static bool use(std::string_view isa) noexcept;
+};
+
+} // namespace logiq::framing
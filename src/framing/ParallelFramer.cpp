@@ -0,0 +1,140 @@
+#include "framing/ParallelFramer.hpp"
+#include "framing/NewlineScanner.hpp"
+
+#include <algorithm>
+
+namespace logiq::framing {
+
+namespace {
+
+// First line start at or after nominal position pos.
+std::size_t boundary(std::string_view data, std::size_t pos, char delim) {
+  if (pos == 0 || pos >= data.size())
+    return std::min(pos, data.size());
+  if (data[pos - 1] == delim)
+    return pos;
+  auto found = data.find(delim, pos);
+  return found == std::string_view::npos ? data.size() : found + 1;
+}
+
+} // namespace
+
+ParallelFramer::ParallelFramer(std::size_t threads,
+                               std::size_t min_part_bytes)
+    : min_part_bytes_(std::max<std::size_t>(min_part_bytes, 1)),
+      parts_(std::max<std::size_t>(threads, 1)) {
+  for (std::size_t i = 1; i < parts_.size(); ++i)
+    workers_.emplace_back([this, i] { worker_loop(i); });
+}
+
+ParallelFramer::~ParallelFramer() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  work_cv_.notify_all();
+  for (auto &t : workers_)
+    t.join();
+}
+
+void ParallelFramer::worker_loop(std::size_t index) {
+  std::uint64_t seen = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      work_cv_.wait(lock, [&] { return stop_ || job_ != seen; });
+      if (stop_)
+        return;
+      seen = job_;
+      if (index >= nparts_)
+        continue; // job too small to need this worker
+    }
+
+    (this->*part_fn_)(index);
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (--pending_ == 0)
+        done_cv_.notify_one();
+    }
+  }
+}
+
+template <typename Format> void ParallelFramer::run_part(std::size_t index) {
+  Part &part = parts_[index];
+  part.records.clear();
+
+  constexpr char kDelim = Format::kDelim;
+  const std::size_t size = data_.size();
+  const std::size_t begin = boundary(data_, size / nparts_ * index, kDelim);
+  const std::size_t end =
+      index + 1 == nparts_
+          ? size
+          : boundary(data_, size / nparts_ * (index + 1), kDelim);
+
+  part.newlines.clear();
+  NewlineScanner::scan(data_.substr(begin, end - begin), part.newlines,
+                       kDelim);
+  part.records.reserve(part.newlines.size());
+
+  std::size_t pos = begin;
+  for (std::size_t nl : part.newlines) {
+    const std::size_t delim = begin + nl;
+    emit_line(limit_, data_, pos, payload_end<Format>(data_, pos, delim),
+              delim, base_offset_, part.records);
+    pos = delim + 1;
+  }
+  part.consumed = pos;
+}
+
+template void ParallelFramer::run_part<LfFormat>(std::size_t);
+template void ParallelFramer::run_part<CrlfFormat>(std::size_t);
+template void ParallelFramer::run_part<NulFormat>(std::size_t);
+
+std::size_t ParallelFramer::frame_impl(std::string_view data,
+                                       std::uint64_t base_offset,
+                                       std::vector<FramedRecord> &out,
+                                       const LineLimit &limit,
+                                       PartFn part_fn) {
+  const std::size_t nparts = std::clamp<std::size_t>(
+      data.size() / min_part_bytes_, 1, parts_.size());
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    data_ = data;
+    base_offset_ = base_offset;
+    limit_ = limit;
+    part_fn_ = part_fn;
+    nparts_ = nparts;
+    pending_ = nparts - 1;
+    job_++;
+  }
+  if (nparts > 1)
+    work_cv_.notify_all();
+
+  (this->*part_fn)(0);
+
+  if (nparts > 1) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [&] { return pending_ == 0; });
+  }
+
+  // Merge in offset order. A part that found no line start of its own has
+  // begin == end and contributes nothing.
+  std::size_t total = 0;
+  for (std::size_t i = 0; i < nparts; ++i)
+    total += parts_[i].records.size();
+  out.reserve(out.size() + total);
+
+  std::size_t consumed = 0;
+  for (std::size_t i = 0; i < nparts; ++i) {
+    const Part &part = parts_[i];
+    out.insert(out.end(), part.records.begin(), part.records.end());
+    if (!part.records.empty())
+      consumed = part.consumed;
+  }
+
+  return consumed;
+}
+
+} // namespace logiq::framing
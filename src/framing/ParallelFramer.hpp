@@ -0,0 +1,85 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "framing/LineFramer.hpp"
+
+namespace logiq::framing {
+
+// Frames a large contiguous range of delimited records (see LineFramer.hpp)
+// on several cores, for catch-up on big backlogs.
+//
+// The range is cut into equal parts; each worker moves its start forward to
+// just past the next terminator (so every line belongs to the part holding its
+// first byte), frames its part independently, and the per-part results are
+// concatenated in offset order. Records keep their exact
+// [start_offset, end_offset), so output is identical to sequential framing.
+class ParallelFramer {
+public:
+  // threads includes the calling thread. Ranges shorter than
+  // 2 * min_part_bytes are framed on the calling thread.
+  explicit ParallelFramer(std::size_t threads,
+                          std::size_t min_part_bytes = 1024 * 1024);
+  ~ParallelFramer();
+
+  ParallelFramer(const ParallelFramer &) = delete;
+  ParallelFramer &operator=(const ParallelFramer &) = delete;
+
+  // Append the complete records of data (whose first byte is at file offset
+  // base_offset) to out, cutting long lines per limit. Returns the number of
+  // bytes consumed, i.e. the end of the last complete line; the rest is an
+  // unterminated tail.
+  template <typename Format>
+  std::size_t frame(std::string_view data, std::uint64_t base_offset,
+                    std::vector<FramedRecord> &out,
+                    const LineLimit &limit = {}) {
+    return frame_impl(data, base_offset, out, limit,
+                      &ParallelFramer::run_part<Format>);
+  }
+
+  std::size_t threads() const noexcept { return parts_.size(); }
+  std::size_t min_bytes() const noexcept { return 2 * min_part_bytes_; }
+
+private:
+  using PartFn = void (ParallelFramer::*)(std::size_t index);
+
+  struct Part {
+    std::vector<FramedRecord> records;
+    std::vector<std::size_t> newlines; // scratch, reused across jobs
+    std::size_t consumed{0}; // end of last record, relative to data
+  };
+
+  std::size_t min_part_bytes_;
+  std::vector<Part> parts_;
+  std::vector<std::thread> workers_;
+
+  // Current job, published under mutex_.
+  std::mutex mutex_;
+  std::condition_variable work_cv_;
+  std::condition_variable done_cv_;
+  std::string_view data_;
+  std::uint64_t base_offset_{0};
+  LineLimit limit_;
+  PartFn part_fn_{nullptr};
+  std::size_t nparts_{0};
+  std::uint64_t job_{0};
+  std::size_t pending_{0};
+  bool stop_{false};
+
+private:
+  void worker_loop(std::size_t index);
+  // Instantiated in ParallelFramer.cpp for the BasicLineFramer formats.
+  template <typename Format> void run_part(std::size_t index);
+
+  std::size_t frame_impl(std::string_view data, std::uint64_t base_offset,
+                         std::vector<FramedRecord> &out,
+                         const LineLimit &limit, PartFn part_fn);
+};
+
+} // namespace logiq::framing
@@ -0,0 +1,120 @@
+#include "framing/StreamFramer.hpp"
+
+namespace logiq::framing {
+
+template <Framer Inner>
+const std::vector<FramedRecord> &BasicStreamFramer<Inner>::drain() {
+  const auto &lines = lines_.drain();
+  if (!start_)
+    return lines;
+
+  out_.clear();
+  emitted_used_ = 0;
+  if (lines.empty())
+    return out_;
+
+  for (const auto &line : lines) {
+    if (open_) {
+      const std::size_t joined = group_size() +
+                                 (last_had_newline_ ? 1 : 0) +
+                                 line.payload.size();
+      if (start_->matches(line.payload) ||
+          (max_bytes_ > 0 && joined > max_bytes_))
+        emit_group();
+    }
+    append(line);
+  }
+  last_line_time_ = Clock::now();
+
+  // The views die with this chunk; keep the open record in our own buffer.
+  if (open_ && !owned_) {
+    group_buf_.assign(group_view_);
+    owned_ = true;
+  }
+  return out_;
+}
+
+template <Framer Inner>
+const std::vector<FramedRecord> &
+BasicStreamFramer<Inner>::flush_expired(Clock::time_point now, bool force) {
+  out_.clear();
+  emitted_used_ = 0;
+  if (open_ && (force || now - last_line_time_ >= flush_timeout_))
+    emit_group();
+  return out_;
+}
+
+template <Framer Inner>
+void BasicStreamFramer<Inner>::append(const FramedRecord &line) {
+  if (!open_) {
+    open_ = true;
+    owned_ = false;
+    group_view_ = line.payload;
+    group_start_ = line.start_offset;
+  } else {
+    const std::size_t sep = last_had_newline_ ? 1 : 0;
+    const char *end = group_view_.data() + group_view_.size();
+
+    // Extend the view if this line directly follows the last one in memory
+    // (separated only by its '\n', which we then include).
+    if (!owned_ && last_was_whole_ && line.payload.data() == end + sep &&
+        (sep == 0 || *end == '\n')) {
+      group_view_ = std::string_view(group_view_.data(),
+                                     group_view_.size() + sep +
+                                         line.payload.size());
+    } else {
+      if (!owned_) {
+        group_buf_.assign(group_view_);
+        owned_ = true;
+      }
+      if (sep)
+        group_buf_.push_back('\n');
+      group_buf_.append(line.payload);
+    }
+  }
+
+  const std::uint64_t span = line.end_offset - line.start_offset;
+  last_had_newline_ = span > line.payload.size();
+  last_was_whole_ = span <= line.payload.size() + 1; // not truncated
+  group_end_ = line.end_offset;
+}
+
+template <Framer Inner> void BasicStreamFramer<Inner>::emit_group() {
+  FramedRecord rec;
+  rec.start_offset = group_start_;
+  rec.end_offset = group_end_;
+
+  if (owned_) {
+    if (emitted_used_ == emitted_.size())
+      emitted_.emplace_back();
+    std::string &slot = emitted_[emitted_used_++];
+    slot.swap(group_buf_);
+    group_buf_.clear();
+    rec.payload = slot;
+  } else {
+    rec.payload = group_view_;
+  }
+
+  out_.push_back(rec);
+  open_ = false;
+  owned_ = false;
+  group_view_ = {};
+}
+
+template <Framer Inner> void BasicStreamFramer<Inner>::reset() {
+  lines_.reset();
+  out_.clear();
+  open_ = false;
+  owned_ = false;
+  group_view_ = {};
+  group_buf_.clear();
+  emitted_used_ = 0;
+}
+
+template class BasicStreamFramer<LineFramer>;
+template class BasicStreamFramer<CrlfFramer>;
+template class BasicStreamFramer<NulFramer>;
+template class BasicStreamFramer<LengthPrefixedFramer>;
+template class BasicStreamFramer<CriFramer>;
+
+} // namespace logiq::framing
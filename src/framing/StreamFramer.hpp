@@ -0,0 +1,123 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "framing/CriFramer.hpp"
+#include "framing/Framer.hpp"
+#include "framing/LengthPrefixedFramer.hpp"
+#include "framing/LineFramer.hpp"
+#include "framing/LinePattern.hpp"
+
+namespace logiq::framing {
+
+// Multiline framing: groups the lines of a stack trace (or any record that
+// spans lines) into one record.
+//
+// Lines come from an Inner framer (any Framer; the instantiations are in
+// StreamFramer.cpp). A line matching the start pattern
+// opens a new record; any other line is appended to the open one. Since
+// the end of a record is only known when the next one starts, the open
+// record is held back until then, until it would exceed the line limit,
+// or until no line arrived for flush_timeout (see flush_expired()).
+//
+// A record's range runs from its first line's start_offset to its last
+// line's end_offset, and the open record is never shipped partially, so
+// checkpoints stay exact. When a record's lines are adjacent in the
+// ingested data (the common case) its payload is a view into that data;
+// only a record carried across chunks is copied.
+//
+// Without a start pattern every line is its own record, exactly as Inner
+// frames it.
+template <Framer Inner> class BasicStreamFramer {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  // The pattern is not owned and must outlive the framer; null disables
+  // multiline grouping.
+  void set_multiline(const LinePattern *start,
+                     std::chrono::milliseconds flush_timeout) noexcept {
+    start_ = start;
+    flush_timeout_ = flush_timeout;
+  }
+
+  // See Framer.
+  void ingest(std::string_view data, std::uint64_t base_offset) {
+    lines_.ingest(data, base_offset);
+  }
+
+  // Extract completed records. The returned vector is reused by the next
+  // call to drain() or flush_expired().
+  const std::vector<FramedRecord> &drain();
+
+  // Emit the open record if no line arrived for flush_timeout (or always,
+  // with force, e.g. before a rotation or truncate discards framer state).
+  const std::vector<FramedRecord> &flush_expired(Clock::time_point now,
+                                                 bool force = false);
+
+  // True while a record is held back waiting for more lines; the caller
+  // must call flush_expired() periodically meanwhile.
+  bool pending() const noexcept { return open_; }
+
+  // Reset internal state (used on truncate or rotation)
+  void reset();
+
+  // See LineFramer; a no-op for framers that cannot split work.
+  void set_parallel(ParallelFramer *parallel) noexcept {
+    if constexpr (requires { lines_.set_parallel(parallel); })
+      lines_.set_parallel(parallel);
+  }
+
+  // See Framer; also bounds grouped records.
+  void set_limit(const LineLimit &limit) noexcept {
+    lines_.set_limit(limit);
+    max_bytes_ = limit.max_bytes;
+  }
+
+  // Inner framer's buffers plus a held-back record copied out of the data.
+  std::size_t buffered_bytes() const noexcept {
+    return lines_.buffered_bytes() + (owned_ ? group_buf_.size() : 0);
+  }
+
+private:
+  Inner lines_;
+
+  const LinePattern *start_{nullptr};
+  std::chrono::milliseconds flush_timeout_{1000};
+  std::size_t max_bytes_{0};
+
+  std::vector<FramedRecord> out_;
+
+  // The open record: either a view into the current data (group_view_) or,
+  // once it is not contiguous or outlives a drain(), a copy (group_buf_).
+  bool open_{false};
+  bool owned_{false};
+  std::string_view group_view_;
+  std::string group_buf_;
+  std::uint64_t group_start_{0};
+  std::uint64_t group_end_{0};
+  bool last_had_newline_{false}; // join the next line with '\n'
+  bool last_was_whole_{false};   // last line's bytes are all in the payload
+  Clock::time_point last_line_time_{};
+
+  // Payloads of copied records handed out since the last drain(); a deque
+  // so handed-out views stay put while more records are added.
+  std::deque<std::string> emitted_;
+  std::size_t emitted_used_{0};
+
+private:
+  std::size_t group_size() const noexcept {
+    return owned_ ? group_buf_.size() : group_view_.size();
+  }
+
+  void append(const FramedRecord &line);
+  void emit_group();
+};
+
+using StreamFramer = BasicStreamFramer<LineFramer>;
+
+} // namespace logiq::framing
@@ -1,10 +1,8 @@
 #include <atomic>
 #include <cctype>
-#include <chrono>
 #include <csignal>
 #include <iostream>
 #include <memory>
-#include <thread>
 
 #include "config/ConfigLoader.hpp"
 #include "core/Agent.hpp"
@@ -86,10 +84,11 @@ int main(int argc, char *argv[]) {
     // 5. Run main processing loop
     // ---------------------------------------------------------
     while (g_running.load()) {
-      agent->run_once();
-
-      // Prevent tight CPU loop
-      std::this_thread::sleep_for(std::chrono::milliseconds(200));
+      // Keep going while there is data; otherwise sleep until the file
+      // changes (or the poll interval expires on polled filesystems).
+      if (!agent->run_once()) {
+        agent->wait_for_work();
+      }
     }
 
     // ---------------------------------------------------------
@@ -9,6 +9,8 @@ void Router::add_sink(std::shared_ptr<logiq::Sink> sink) {
   if (!sink)
     return;
   sinks_by_name_[std::string(sink->name())] = std::move(sink);
+  primary_ = get_sink_ptr(cfg_.primary_sink_name);
+  decisions_.clear(); // cached decisions may name the new sink
 }
 
 bool Router::validate(std::string &error) const {
@@ -49,7 +51,7 @@ bool Router::validate(std::string &error) const {
 }
 
 logiq::Sink *Router::get_sink_ptr(std::string_view name) const noexcept {
-  auto it = sinks_by_name_.find(std::string(name));
+  auto it = sinks_by_name_.find(name);
   if (it == sinks_by_name_.end())
     return nullptr;
   return it->second.get();
@@ -57,13 +59,26 @@ logiq::Sink *Router::get_sink_ptr(std::string_view name) const noexcept {
 
 bool Router::rule_matches(const RouteRule &rule,
                           const logiq::Record &record) const {
-  auto it = record.labels.find(rule.label_key);
-  if (it == record.labels.end())
+  if (!record.labels)
+    return false;
+  const auto &labels = record.labels->labels;
+  auto it = labels.find(rule.label_key);
+  if (it == labels.end())
     return false;
   return it->second == rule.label_value;
 }
 
-RouteDecision Router::decide(const logiq::Record &record) const {
+const RouteDecision &Router::decide(const logiq::Record &record) const {
+  const std::uint32_t id = logiq::label_id(record.labels);
+  if (id >= decisions_.size())
+    decisions_.resize(id + 1);
+  auto &slot = decisions_[id];
+  if (!slot)
+    slot = std::make_unique<RouteDecision>(compute_decision(record));
+  return *slot;
+}
+
+RouteDecision Router::compute_decision(const logiq::Record &record) const {
   RouteDecision decision;
 
   // First-match rule routing (simple + deterministic).
@@ -74,10 +89,8 @@ RouteDecision Router::decide(const logiq::Record &record) const {
     for (const auto &sink_name : rule.sink_names) {
       if (auto *s = get_sink_ptr(sink_name)) {
         decision.sinks.push_back(s);
-        if (cfg_.ack_policy == AckPolicy::Primary &&
-            sink_name == cfg_.primary_sink_name) {
+        if (cfg_.ack_policy == AckPolicy::Primary && s == primary_)
           decision.uses_primary = true;
-        }
       }
     }
     return decision;
@@ -87,10 +100,8 @@ RouteDecision Router::decide(const logiq::Record &record) const {
   for (const auto &sink_name : cfg_.default_sink_names) {
     if (auto *s = get_sink_ptr(sink_name)) {
       decision.sinks.push_back(s);
-      if (cfg_.ack_policy == AckPolicy::Primary &&
-          sink_name == cfg_.primary_sink_name) {
+      if (cfg_.ack_policy == AckPolicy::Primary && s == primary_)
         decision.uses_primary = true;
-      }
     }
   }
 
@@ -135,8 +146,7 @@ std::optional<std::uint64_t> Router::send_and_decide_commit(
     }
 
     // Primary tracking (by name comparison).
-    if (cfg_.ack_policy == AckPolicy::Primary &&
-        sink->name() == cfg_.primary_sink_name) {
+    if (cfg_.ack_policy == AckPolicy::Primary && sink == primary_) {
       primary_ok = res.ok;
       primary_commit = res.commit_end_offset;
     }
@@ -1,6 +1,7 @@
 // File: src/router/Router.hpp
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
@@ -62,8 +63,14 @@ public:
   // Returns false with message if invalid.
   [[nodiscard]] bool validate(std::string &error) const;
 
-  // Decide which sinks to use for a given record.
-  [[nodiscard]] RouteDecision decide(const logiq::Record &record) const;
+  // Decide which sinks to use for a given record. Decisions depend only on
+  // the record's labels and are cached per interned label set, so this is
+  // an array lookup after the first record of each set. Each decision is
+  // allocated once, so the reference survives the cache growing for later
+  // label sets; add_sink() discards the cache and invalidates it. Not
+  // thread-safe (it fills the cache).
+  [[nodiscard]] const RouteDecision &
+  decide(const logiq::Record &record) const;
 
   // Send a batch to the sinks selected for the batch.
   // Returns the effective commit_end_offset according to AckPolicy.
@@ -75,10 +82,27 @@ public:
   const RouterConfig &config() const noexcept { return cfg_; }
 
 private:
+  // Lets sinks_by_name_ be searched with a string_view, no temporary.
+  struct NameHash {
+    using is_transparent = void;
+    std::size_t operator()(std::string_view s) const noexcept {
+      return std::hash<std::string_view>{}(s);
+    }
+  };
+
   RouterConfig cfg_;
-  std::unordered_map<std::string, std::shared_ptr<logiq::Sink>> sinks_by_name_;
+  std::unordered_map<std::string, std::shared_ptr<logiq::Sink>, NameHash,
+                     std::equal_to<>>
+      sinks_by_name_;
+  logiq::Sink *primary_{nullptr}; // cfg_.primary_sink_name, once added
+
+  // decisions_[label_id(record.labels)], filled on first use. Held by
+  // pointer so decide()'s references stay put when the vector grows.
+  mutable std::vector<std::unique_ptr<RouteDecision>> decisions_;
 
   [[nodiscard]] logiq::Sink *get_sink_ptr(std::string_view name) const noexcept;
+  [[nodiscard]] RouteDecision compute_decision(
+      const logiq::Record &record) const;
   [[nodiscard]] bool rule_matches(const RouteRule &rule,
                                   const logiq::Record &record) const;
 };
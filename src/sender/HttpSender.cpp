@@ -0,0 +1,632 @@
+#include "sender/HttpSender.hpp"
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace logiq::sender {
+
+namespace {
+
+using Clock = HttpSender::Clock;
+
+constexpr std::size_t kMaxHeaderBytes = 64 * 1024;
+constexpr std::size_t kMaxResponseBytes = 4 * 1024 * 1024;
+constexpr std::size_t kReadBytes = 16 * 1024;
+// Response body kept for Response::message.
+constexpr std::size_t kMessageBytes = 256;
+// Least time between two lookups of the endpoint's name.
+constexpr std::chrono::seconds kResolveInterval{30};
+
+std::string errno_text(const std::string &what) {
+  return what + ": " + std::strerror(errno);
+}
+
+bool iequals(std::string_view a, std::string_view b) {
+  return a.size() == b.size() &&
+         std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+           return std::tolower(static_cast<unsigned char>(x)) ==
+                  std::tolower(static_cast<unsigned char>(y));
+         });
+}
+
+bool icontains(std::string_view s, std::string_view word) {
+  for (std::size_t i = 0; i + word.size() <= s.size(); ++i) {
+    if (iequals(s.substr(i, word.size()), word))
+      return true;
+  }
+  return false;
+}
+
+std::string_view trim(std::string_view s) {
+  while (!s.empty() && (s.front() == ' ' || s.front() == '\t'))
+    s.remove_prefix(1);
+  while (!s.empty() && (s.back() == ' ' || s.back() == '\t'))
+    s.remove_suffix(1);
+  return s;
+}
+
+template <typename T>
+bool parse_number(std::string_view s, T &out, int base = 10) {
+  const auto [p, ec] =
+      std::from_chars(s.data(), s.data() + s.size(), out, base);
+  return !s.empty() && ec == std::errc() && p == s.data() + s.size();
+}
+
+enum class Parse { More, Done, Bad };
+
+// What a request needs from its response.
+struct Head {
+  int status{0};
+  bool keep{false};   // the connection may be reused
+  std::size_t end{0}; // bytes of input the response took
+  std::string body;   // its first kMessageBytes
+};
+
+// Decode the chunked body at the start of in; consumed is its length,
+// trailer included, once complete.
+Parse dechunk(std::string_view in, std::string &body, std::size_t &consumed,
+              std::string &error) {
+  std::size_t pos = 0;
+  for (;;) {
+    const auto eol = in.find("\r\n", pos);
+    if (eol == std::string_view::npos)
+      return Parse::More;
+    auto line = in.substr(pos, eol - pos);
+    line = trim(line.substr(0, line.find(';'))); // drop chunk extensions
+    std::size_t n = 0;
+    if (!parse_number(line, n, 16) || n > kMaxResponseBytes) {
+      error = "malformed chunk size";
+      return Parse::Bad;
+    }
+    pos = eol + 2;
+
+    if (n == 0) {
+      // Trailer fields, up to an empty line.
+      for (;;) {
+        const auto end = in.find("\r\n", pos);
+        if (end == std::string_view::npos)
+          return Parse::More;
+        const bool last = end == pos;
+        pos = end + 2;
+        if (last) {
+          consumed = pos;
+          return Parse::Done;
+        }
+      }
+    }
+
+    if (in.size() < pos + n + 2)
+      return Parse::More;
+    if (in.substr(pos + n, 2) != "\r\n") {
+      error = "malformed chunk";
+      return Parse::Bad;
+    }
+    if (body.size() < kMessageBytes)
+      body.append(in.substr(pos, std::min(n, kMessageBytes - body.size())));
+    pos += n + 2;
+  }
+}
+
+// Parse the response at the start of in (eof: nothing more will come).
+// Interim 1xx responses are skipped. Parses from the start on every call:
+// responses to log ingestion are a few hundred bytes.
+Parse parse_response(std::string_view in, bool eof, Head &out,
+                     std::string &error) {
+  std::size_t offset = 0;
+  for (;;) {
+    const auto rest = in.substr(offset);
+    const auto head_end = rest.find("\r\n\r\n");
+    if (head_end == std::string_view::npos) {
+      if (rest.size() > kMaxHeaderBytes) {
+        error = "response header too large";
+        return Parse::Bad;
+      }
+      return Parse::More;
+    }
+    const auto head = rest.substr(0, head_end);
+    const auto body = rest.substr(head_end + 4);
+
+    // HTTP/1.x SSS reason
+    const auto status_line = head.substr(0, head.find("\r\n"));
+    int status = 0;
+    if (status_line.size() < 12 || status_line.substr(0, 7) != "HTTP/1." ||
+        status_line[8] != ' ' ||
+        !parse_number(status_line.substr(9, 3), status)) {
+      error = "malformed status line";
+      return Parse::Bad;
+    }
+
+    bool close = status_line[7] == '0'; // HTTP/1.0 closes by default
+    bool chunked = false;
+    bool has_length = false;
+    std::size_t length = 0;
+    std::size_t pos = status_line.size();
+    while (pos < head.size()) {
+      pos += 2; // CRLF
+      auto eol = head.find("\r\n", pos);
+      if (eol == std::string_view::npos)
+        eol = head.size();
+      const auto line = head.substr(pos, eol - pos);
+      pos = eol;
+      const auto colon = line.find(':');
+      if (colon == std::string_view::npos)
+        continue;
+      const auto name = trim(line.substr(0, colon));
+      const auto value = trim(line.substr(colon + 1));
+      if (iequals(name, "content-length")) {
+        if (!parse_number(value, length) || length > kMaxResponseBytes) {
+          error = "invalid Content-Length";
+          return Parse::Bad;
+        }
+        has_length = true;
+      } else if (iequals(name, "transfer-encoding")) {
+        chunked = icontains(value, "chunked");
+      } else if (iequals(name, "connection")) {
+        if (icontains(value, "close"))
+          close = true;
+        else if (icontains(value, "keep-alive"))
+          close = false;
+      }
+    }
+
+    if (status >= 100 && status < 200 && status != 101) {
+      offset += head_end + 4;
+      continue;
+    }
+
+    out.body.clear();
+    std::size_t consumed = 0;
+    if (status == 204 || status == 304) {
+      // No body.
+    } else if (chunked) {
+      const auto r = dechunk(body, out.body, consumed, error);
+      if (r != Parse::Done)
+        return r;
+    } else if (has_length) {
+      if (body.size() < length)
+        return Parse::More;
+      consumed = length;
+      out.body = body.substr(0, std::min(length, kMessageBytes));
+    } else {
+      // Delimited by the server closing the connection.
+      if (!eof)
+        return Parse::More;
+      consumed = body.size();
+      out.body = body.substr(0, std::min(consumed, kMessageBytes));
+      close = true;
+    }
+
+    out.status = status;
+    out.keep = !close;
+    out.end = offset + head_end + 4 + consumed;
+    return Parse::Done;
+  }
+}
+
+} // namespace
+
+Endpoint Endpoint::parse(const std::string &url) {
+  constexpr std::string_view kScheme = "http://";
+  if (url.rfind("https://", 0) == 0)
+    throw std::runtime_error("Endpoint: https is not supported: " + url);
+  if (url.rfind(kScheme, 0) != 0)
+    throw std::runtime_error("Endpoint: not an http:// URL: " + url);
+
+  std::string_view rest(url);
+  rest.remove_prefix(kScheme.size());
+  const auto path_start = rest.find_first_of("/?");
+  const auto authority = rest.substr(0, path_start);
+
+  Endpoint ep;
+  if (path_start != std::string_view::npos) {
+    const auto path = rest.substr(path_start);
+    ep.path.clear();
+    if (path.front() == '?')
+      ep.path += '/';
+    ep.path += path;
+  }
+
+  std::string_view host = authority;
+  std::string_view port;
+  if (!authority.empty() && authority.front() == '[') {
+    const auto close = authority.find(']');
+    if (close == std::string_view::npos)
+      throw std::runtime_error("Endpoint: invalid host in URL: " + url);
+    host = authority.substr(1, close - 1);
+    const auto after = authority.substr(close + 1);
+    if (!after.empty() && after.front() != ':')
+      throw std::runtime_error("Endpoint: invalid host in URL: " + url);
+    if (!after.empty())
+      port = after.substr(1);
+  } else if (const auto colon = authority.rfind(':');
+             colon != std::string_view::npos) {
+    host = authority.substr(0, colon);
+    port = authority.substr(colon + 1);
+  }
+  if (host.empty() || host.find('@') != std::string_view::npos)
+    throw std::runtime_error("Endpoint: invalid host in URL: " + url);
+
+  if (!port.empty()) {
+    unsigned v = 0;
+    if (!parse_number(port, v) || v == 0 || v > 65535)
+      throw std::runtime_error("Endpoint: invalid port in URL: " + url);
+    ep.port = static_cast<std::uint16_t>(v);
+  }
+  ep.host = std::string(host);
+  return ep;
+}
+
+std::string Endpoint::authority() const {
+  const bool v6 = host.find(':') != std::string::npos;
+  std::string out;
+  out.reserve(host.size() + 8);
+  if (v6)
+    out += '[';
+  out += host;
+  if (v6)
+    out += ']';
+  if (port != 80) {
+    out += ':';
+    out += std::to_string(port);
+  }
+  return out;
+}
+
+struct HttpSender::Address {
+  sockaddr_storage addr{};
+  socklen_t len{0};
+  int family{AF_UNSPEC};
+};
+
+struct HttpSender::Connection {
+  int fd{-1};
+  int ep{-1}; // epoll instance watching fd only, edge-triggered
+  std::string in;
+
+  Connection() = default;
+  Connection(const Connection &) = delete;
+  Connection &operator=(const Connection &) = delete;
+  ~Connection() {
+    if (fd >= 0)
+      ::close(fd);
+    if (ep >= 0)
+      ::close(ep);
+  }
+
+  // Wait until fd may have become readable or writable; false (with
+  // error set) once deadline has passed.
+  bool wait(Clock::time_point deadline, std::string &error) const {
+    for (;;) {
+      const auto left = std::chrono::ceil<std::chrono::milliseconds>(
+                            deadline - Clock::now())
+                            .count();
+      if (left <= 0) {
+        error = "timed out";
+        return false;
+      }
+      epoll_event ev{};
+      const int n = ::epoll_wait(
+          ep, &ev, 1, static_cast<int>(std::min<long long>(left, INT_MAX)));
+      if (n > 0)
+        return true;
+      if (n < 0 && errno != EINTR) {
+        error = errno_text("epoll_wait failed");
+        return false;
+      }
+    }
+  }
+
+  // Still usable after sitting in the pool: not closed by the peer, and
+  // nothing unexpected to read.
+  bool alive() const {
+    char c;
+    const ssize_t n = ::recv(fd, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+    return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+  }
+
+  // Write head and body; reset is set if the peer had closed the
+  // connection.
+  bool send(std::string_view head, std::string_view body,
+            Clock::time_point deadline, std::string &error, bool &reset) {
+    const std::size_t total = head.size() + body.size();
+    std::size_t done = 0;
+    while (done < total) {
+      iovec iov[2];
+      std::size_t count = 0;
+      if (done < head.size()) {
+        iov[count++] = {const_cast<char *>(head.data() + done),
+                        head.size() - done};
+        iov[count++] = {const_cast<char *>(body.data()), body.size()};
+      } else {
+        const std::size_t at = done - head.size();
+        iov[count++] = {const_cast<char *>(body.data() + at),
+                        body.size() - at};
+      }
+      msghdr msg{};
+      msg.msg_iov = iov;
+      msg.msg_iovlen = count;
+      const ssize_t n = ::sendmsg(fd, &msg, MSG_NOSIGNAL);
+      if (n >= 0) {
+        done += static_cast<std::size_t>(n);
+        continue;
+      }
+      if (errno == EINTR)
+        continue;
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        if (!wait(deadline, error))
+          return false;
+        continue;
+      }
+      reset = errno == EPIPE || errno == ECONNRESET;
+      error = errno_text("send failed");
+      return false;
+    }
+    return true;
+  }
+
+  // Read one response into out; reset is set if the peer closed the
+  // connection before sending anything.
+  bool receive(Head &out, Clock::time_point deadline, std::string &error,
+               bool &reset) {
+    in.clear();
+    bool eof = false;
+    for (;;) {
+      switch (parse_response(in, eof, out, error)) {
+      case Parse::Done:
+        return true;
+      case Parse::Bad:
+        return false;
+      case Parse::More:
+        break;
+      }
+      if (eof) {
+        reset = in.empty();
+        error = "connection closed by peer";
+        return false;
+      }
+      if (in.size() > kMaxResponseBytes) {
+        error = "response too large";
+        return false;
+      }
+
+      const std::size_t used = in.size();
+      in.resize(used + kReadBytes);
+      const ssize_t n = ::recv(fd, in.data() + used, kReadBytes, 0);
+      in.resize(used + (n > 0 ? static_cast<std::size_t>(n) : 0));
+      if (n > 0)
+        continue;
+      if (n == 0) {
+        eof = true;
+        continue;
+      }
+      if (errno == EINTR)
+        continue;
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        if (!wait(deadline, error))
+          return false;
+        continue;
+      }
+      reset = errno == ECONNRESET && in.empty();
+      error = errno_text("recv failed");
+      return false;
+    }
+  }
+};
+
+namespace {
+
+// The addresses of ep (getaddrinfo order); empty, with error set, if it
+// cannot be resolved.
+std::vector<HttpSender::Address> resolve(const Endpoint &ep,
+                                         std::string &error) {
+  addrinfo hints{};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo *res = nullptr;
+  const auto port = std::to_string(ep.port);
+  if (const int rc = ::getaddrinfo(ep.host.c_str(), port.c_str(), &hints, &res);
+      rc != 0) {
+    error = "cannot resolve " + ep.host + ": " + ::gai_strerror(rc);
+    return {};
+  }
+  std::unique_ptr<addrinfo, decltype(&::freeaddrinfo)> guard(res,
+                                                              ::freeaddrinfo);
+  std::vector<HttpSender::Address> out;
+  for (const addrinfo *ai = res; ai; ai = ai->ai_next) {
+    if (ai->ai_addrlen > sizeof(sockaddr_storage))
+      continue;
+    auto &a = out.emplace_back();
+    std::memcpy(&a.addr, ai->ai_addr, ai->ai_addrlen);
+    a.len = ai->ai_addrlen;
+    a.family = ai->ai_family;
+  }
+  return out;
+}
+
+// A new connection to one of addrs, tried in turn.
+std::unique_ptr<HttpSender::Connection>
+connect_to(const std::vector<HttpSender::Address> &addrs,
+           Clock::time_point deadline, std::string &error) {
+  for (const auto &a : addrs) {
+    auto c = std::make_unique<HttpSender::Connection>();
+    c->fd = ::socket(a.family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                     0);
+    if (c->fd < 0) {
+      error = errno_text("socket failed");
+      continue;
+    }
+    // Requests are written whole; do not hold back their last segment.
+    const int one = 1;
+    ::setsockopt(c->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    c->ep = ::epoll_create1(EPOLL_CLOEXEC);
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    if (c->ep < 0 || ::epoll_ctl(c->ep, EPOLL_CTL_ADD, c->fd, &ev) != 0) {
+      error = errno_text("epoll setup failed");
+      return nullptr;
+    }
+
+    if (::connect(c->fd, reinterpret_cast<const sockaddr *>(&a.addr),
+                  a.len) != 0) {
+      if (errno != EINPROGRESS) {
+        error = errno_text("connect failed");
+        continue;
+      }
+      if (!c->wait(deadline, error)) {
+        error = "connect " + error;
+        return nullptr; // out of time for other addresses too
+      }
+      int err = 0;
+      socklen_t len = sizeof(err);
+      if (::getsockopt(c->fd, SOL_SOCKET, SO_ERROR, &err, &len) != 0)
+        err = errno;
+      if (err != 0) {
+        errno = err;
+        error = errno_text("connect failed");
+        continue;
+      }
+    }
+    return c;
+  }
+  return nullptr;
+}
+
+} // namespace
+
+HttpSender::HttpSender(Endpoint endpoint, Options opt)
+    : endpoint_(std::move(endpoint)), opt_(opt) {}
+
+HttpSender::~HttpSender() = default;
+
+std::size_t HttpSender::idle() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return idle_.size();
+}
+
+std::unique_ptr<HttpSender::Connection>
+HttpSender::acquire(Clock::time_point deadline, bool &reused,
+                    std::string &error) {
+  for (;;) {
+    std::unique_ptr<Connection> conn;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (idle_.empty())
+        break;
+      conn = std::move(idle_.back()); // the most recently used
+      idle_.pop_back();
+    }
+    if (conn->alive()) {
+      reused = true;
+      return conn;
+    }
+  }
+  reused = false;
+
+  // Resolve once and reuse the addresses. Look the name up again only
+  // when none of them takes a connection (the endpoint may have moved),
+  // and at most every kResolveInterval, so a down endpoint does not cost
+  // a lookup per attempt.
+  std::vector<Address> addrs;
+  Clock::time_point resolved_at;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    addrs = addresses_;
+    resolved_at = resolved_at_;
+  }
+  if (!addrs.empty()) {
+    if (auto conn = connect_to(addrs, deadline, error))
+      return conn;
+    const auto now = Clock::now();
+    if (now >= deadline || now - resolved_at < kResolveInterval)
+      return nullptr;
+  }
+  addrs = resolve(endpoint_, error);
+  if (addrs.empty())
+    return nullptr;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    addresses_ = addrs;
+    resolved_at_ = Clock::now();
+  }
+  return connect_to(addrs, deadline, error);
+}
+
+void HttpSender::release(std::unique_ptr<Connection> conn) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (idle_.size() < opt_.max_idle)
+    idle_.push_back(std::move(conn));
+}
+
+Response HttpSender::post(std::string_view content_type,
+                          std::string_view content_encoding,
+                          std::string_view body) {
+  in_flight_.fetch_add(1, std::memory_order_relaxed);
+  struct Done {
+    std::atomic<std::size_t> &n;
+    ~Done() { n.fetch_sub(1, std::memory_order_relaxed); }
+  } done{in_flight_};
+
+  const auto deadline =
+      Clock::now() + std::chrono::milliseconds(opt_.timeout_ms);
+
+  std::string head;
+  head.reserve(160 + endpoint_.path.size() + endpoint_.host.size() +
+               content_type.size() + content_encoding.size());
+  head += "POST ";
+  head += endpoint_.path;
+  head += " HTTP/1.1\r\nHost: ";
+  head += endpoint_.authority();
+  head += "\r\nUser-Agent: logiq-agent\r\nContent-Type: ";
+  head += content_type;
+  if (!content_encoding.empty()) {
+    head += "\r\nContent-Encoding: ";
+    head += content_encoding;
+  }
+  head += "\r\nContent-Length: ";
+  head += std::to_string(body.size());
+  head += "\r\n\r\n";
+
+  Response out;
+  for (int attempt = 0; attempt < 2; ++attempt) {
+    bool reused = false;
+    auto conn = acquire(deadline, reused, out.message);
+    if (!conn)
+      return out;
+
+    bool reset = false;
+    Head r;
+    if (conn->send(head, body, deadline, out.message, reset) &&
+        conn->receive(r, deadline, out.message, reset)) {
+      out.ok = true;
+      out.status = r.status;
+      out.message = std::move(r.body);
+      // Bytes past the response mean the stream is out of step.
+      if (r.keep && r.end == conn->in.size())
+        release(std::move(conn));
+      return out;
+    }
+
+    // The server closed a pooled connection while it sat idle: retry once
+    // on a new one.
+    if (!reused || !reset)
+      break;
+  }
+  return out;
+}
+
+} // namespace logiq::sender
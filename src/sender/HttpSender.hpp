@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "sender/Sender.hpp"
+
+namespace logiq::sender {
+
+// HTTP/1.1 client for one endpoint, with a pool of keep-alive connections.
+//
+// Sockets are non-blocking and each waits on its own edge-triggered epoll
+// instance (created once per pooled connection, not per request), so every
+// request (connect, send and response together) is bounded by timeout_ms
+// however the peer behaves. The host name is resolved on the first
+// connect and only again (at most every 30 s) when none of its addresses
+// accepts one; that lookup (getaddrinfo) is the one step the timeout
+// cannot bound. Connections go back to
+// the pool after a complete response the server did not ask to close, so
+// a busy sender pays for a TCP handshake only when it runs more requests
+// at once than before. A pooled connection the server closed while idle is
+// detected before use, or on the first read, and the request is retried
+// once on a new connection.
+//
+// post() may be called from several threads at once; each call uses a
+// connection of its own.
+class HttpSender {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  struct Options {
+    int timeout_ms{2000};
+    // Idle connections kept for reuse; more are closed after their request.
+    std::size_t max_idle{8};
+  };
+
+  HttpSender(Endpoint endpoint, Options opt);
+  ~HttpSender();
+
+  HttpSender(const HttpSender &) = delete;
+  HttpSender &operator=(const HttpSender &) = delete;
+
+  // POST body (Content-Length framed; content_encoding, unless empty,
+  // names its compression) and wait for the response. Responses may be
+  // Content-Length, chunked or close-delimited.
+  Response post(std::string_view content_type,
+                std::string_view content_encoding, std::string_view body);
+
+  // Requests currently in post().
+  std::size_t in_flight() const noexcept {
+    return in_flight_.load(std::memory_order_relaxed);
+  }
+
+  // Connections waiting in the pool.
+  std::size_t idle() const;
+
+  const Endpoint &endpoint() const noexcept { return endpoint_; }
+
+  struct Connection; // defined with the code
+  struct Address;    // a resolved socket address
+
+private:
+  // An idle connection, or a new one; nullptr (and error set) on failure.
+  std::unique_ptr<Connection> acquire(Clock::time_point deadline,
+                                      bool &reused, std::string &error);
+  void release(std::unique_ptr<Connection> conn);
+
+  Endpoint endpoint_;
+  Options opt_;
+
+  mutable std::mutex mutex_;
+  std::vector<std::unique_ptr<Connection>> idle_;
+  // The endpoint's addresses, resolved on the first connect.
+  std::vector<Address> addresses_;
+  Clock::time_point resolved_at_{};
+
+  std::atomic<std::size_t> in_flight_{0};
+};
+
+} // namespace logiq::sender
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace logiq::sender {
+
+// Where requests go: the parts of an http:// URL.
+struct Endpoint {
+  std::string host;
+  std::uint16_t port{80};
+  std::string path{"/"}; // with the query, if any
+
+  // Parse "http://host[:port][/path]" ("[v6addr]" for IPv6 literals).
+  // Throws std::runtime_error on anything else, including https://.
+  static Endpoint parse(const std::string &url);
+
+  // host[:port] as sent in the Host header.
+  std::string authority() const;
+};
+
+// Outcome of one request.
+struct Response {
+  bool ok{false};      // a complete response came back (any status)
+  int status{0};       // HTTP status if ok
+  std::string message; // the error, or the start of the response body
+};
+
+} // namespace logiq::sender
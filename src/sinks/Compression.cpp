@@ -0,0 +1,237 @@
+#include "sinks/Compression.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#ifdef LOGIQ_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef LOGIQ_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace logiq::sinks {
+
+namespace {
+
+// Output space added per step; bodies end up a fraction of their input.
+constexpr std::size_t kOutStep = 16 * 1024;
+
+// Grow out by at least room bytes for a codec to write into; returns
+// where they start.
+char *grow(std::string &out, std::size_t room) {
+  const std::size_t used = out.size();
+  out.resize(used + room);
+  return out.data() + used;
+}
+
+#ifdef LOGIQ_HAVE_ZLIB
+// The thread's deflate state, kept across bodies.
+struct GzipContext {
+  z_stream zs{};
+  bool ready{false};
+  int level{0};
+
+  ~GzipContext() {
+    if (ready)
+      deflateEnd(&zs);
+  }
+
+  z_stream *start(int lvl) {
+    if (lvl == 0)
+      lvl = Z_DEFAULT_COMPRESSION;
+    if (ready && level != lvl) {
+      deflateEnd(&zs);
+      ready = false;
+    }
+    if (ready) {
+      deflateReset(&zs);
+      return &zs;
+    }
+    zs = {};
+    // windowBits 15 + 16: gzip header and trailer instead of zlib's.
+    if (deflateInit2(&zs, lvl, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) !=
+        Z_OK)
+      throw std::runtime_error("Compression: invalid gzip level " +
+                               std::to_string(lvl));
+    ready = true;
+    level = lvl;
+    return &zs;
+  }
+};
+
+thread_local GzipContext gzip_context;
+
+void deflate_into(z_stream &zs, std::string &out, std::string_view in,
+                  int flush) {
+  zs.next_in =
+      reinterpret_cast<Bytef *>(const_cast<char *>(in.data()));
+  zs.avail_in = static_cast<uInt>(in.size());
+  for (;;) {
+    const std::size_t room = std::max(kOutStep, in.size() / 2);
+    const std::size_t used = out.size();
+    zs.next_out = reinterpret_cast<Bytef *>(grow(out, room));
+    zs.avail_out = static_cast<uInt>(room);
+    const int rc = deflate(&zs, flush);
+    out.resize(used + room - zs.avail_out);
+    if (rc == Z_STREAM_ERROR)
+      throw std::runtime_error("Compression: deflate failed");
+    if (flush == Z_FINISH ? rc == Z_STREAM_END
+                          : zs.avail_in == 0 && zs.avail_out != 0)
+      return;
+  }
+}
+#endif
+
+#ifdef LOGIQ_HAVE_ZSTD
+// The thread's zstd context, kept across bodies.
+struct ZstdContext {
+  ZSTD_CCtx *cctx{nullptr};
+
+  ~ZstdContext() { ZSTD_freeCCtx(cctx); }
+
+  ZSTD_CCtx *start(int level) {
+    if (!cctx && !(cctx = ZSTD_createCCtx()))
+      throw std::runtime_error("Compression: ZSTD_createCCtx failed");
+    ZSTD_CCtx_reset(cctx, ZSTD_reset_session_only);
+    // 0 selects zstd's default level.
+    if (ZSTD_isError(
+            ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, level)))
+      throw std::runtime_error("Compression: invalid zstd level");
+    return cctx;
+  }
+};
+
+thread_local ZstdContext zstd_context;
+
+void zstd_into(ZSTD_CCtx *cctx, std::string &out, std::string_view data,
+               ZSTD_EndDirective mode) {
+  ZSTD_inBuffer in{data.data(), data.size(), 0};
+  for (;;) {
+    const std::size_t room = std::max(kOutStep, data.size() / 2);
+    const std::size_t used = out.size();
+    ZSTD_outBuffer o{grow(out, room), room, 0};
+    const std::size_t left = ZSTD_compressStream2(cctx, &o, &in, mode);
+    out.resize(used + o.pos);
+    if (ZSTD_isError(left)) {
+      throw std::runtime_error(std::string("Compression: ") +
+                               ZSTD_getErrorName(left));
+    }
+    if (mode == ZSTD_e_end ? left == 0 : in.pos == in.size)
+      return;
+  }
+}
+#endif
+
+[[maybe_unused]] [[noreturn]] void unavailable(Compression c) {
+  throw std::runtime_error("Compression: " +
+                           std::string(content_encoding(c)) +
+                           " support is not built in");
+}
+
+} // namespace
+
+std::optional<Compression> parse_compression(const std::string &s) {
+  if (s == "none")
+    return Compression::None;
+  if (s == "gzip")
+    return Compression::Gzip;
+  if (s == "zstd")
+    return Compression::Zstd;
+  return std::nullopt;
+}
+
+std::string_view content_encoding(Compression c) noexcept {
+  switch (c) {
+  case Compression::Gzip:
+    return "gzip";
+  case Compression::Zstd:
+    return "zstd";
+  case Compression::None:
+    break;
+  }
+  return {};
+}
+
+bool compression_available(Compression c) noexcept {
+  switch (c) {
+  case Compression::Gzip:
+#ifdef LOGIQ_HAVE_ZLIB
+    return true;
+#else
+    return false;
+#endif
+  case Compression::Zstd:
+#ifdef LOGIQ_HAVE_ZSTD
+    return true;
+#else
+    return false;
+#endif
+  case Compression::None:
+    break;
+  }
+  return true;
+}
+
+CompressedWriter::CompressedWriter(Compression c, int level, std::string &out)
+    : codec_(c), out_(out) {
+  switch (codec_) {
+  case Compression::Gzip:
+#ifdef LOGIQ_HAVE_ZLIB
+    ctx_ = gzip_context.start(level);
+    break;
+#else
+    unavailable(c);
+#endif
+  case Compression::Zstd:
+#ifdef LOGIQ_HAVE_ZSTD
+    ctx_ = zstd_context.start(level);
+    break;
+#else
+    unavailable(c);
+#endif
+  case Compression::None:
+    break;
+  }
+  (void)level;
+}
+
+void CompressedWriter::write(std::string_view data) {
+  if (data.empty())
+    return;
+  switch (codec_) {
+  case Compression::Gzip:
+#ifdef LOGIQ_HAVE_ZLIB
+    deflate_into(*static_cast<z_stream *>(ctx_), out_, data, Z_NO_FLUSH);
+#endif
+    break;
+  case Compression::Zstd:
+#ifdef LOGIQ_HAVE_ZSTD
+    zstd_into(static_cast<ZSTD_CCtx *>(ctx_), out_, data, ZSTD_e_continue);
+#endif
+    break;
+  case Compression::None:
+    out_.append(data);
+    break;
+  }
+}
+
+void CompressedWriter::finish() {
+  switch (codec_) {
+  case Compression::Gzip:
+#ifdef LOGIQ_HAVE_ZLIB
+    deflate_into(*static_cast<z_stream *>(ctx_), out_, {}, Z_FINISH);
+#endif
+    break;
+  case Compression::Zstd:
+#ifdef LOGIQ_HAVE_ZSTD
+    zstd_into(static_cast<ZSTD_CCtx *>(ctx_), out_, {}, ZSTD_e_end);
+#endif
+    break;
+  case Compression::None:
+    break;
+  }
+}
+
+} // namespace logiq::sinks
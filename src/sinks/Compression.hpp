@@ -0,0 +1,46 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace logiq::sinks {
+
+// Content-Encoding of request bodies.
+enum class Compression { None, Gzip, Zstd };
+
+// Parses "none" | "gzip" | "zstd".
+std::optional<Compression> parse_compression(const std::string &s);
+
+// The Content-Encoding header value; empty for None.
+std::string_view content_encoding(Compression c) noexcept;
+
+// Support for c was compiled in (zlib, libzstd).
+bool compression_available(Compression c) noexcept;
+
+// Streams data into a compressed body appended to out.
+//
+// Uses the calling thread's context for its codec, reset rather than
+// rebuilt for every body, so a writer per request costs no allocations
+// once a thread has compressed its first one. Only one writer per codec
+// may be open on a thread at a time. level 0 is the codec's default.
+// Throws std::runtime_error if the codec fails (or is not compiled in).
+class CompressedWriter {
+public:
+  CompressedWriter(Compression c, int level, std::string &out);
+
+  CompressedWriter(const CompressedWriter &) = delete;
+  CompressedWriter &operator=(const CompressedWriter &) = delete;
+
+  void write(std::string_view data);
+
+  // End the stream; nothing may be written after it.
+  void finish();
+
+private:
+  Compression codec_;
+  std::string &out_;
+  void *ctx_{nullptr}; // the thread's z_stream or ZSTD_CCtx
+};
+
+} // namespace logiq::sinks
@@ -1,78 +1,108 @@
 // File: src/sinks/HttpNdjsonSink.cpp
 #include "HttpNdjsonSink.hpp"
 
-#include <sstream>
+#include <stdexcept>
+#include <utility>
 
 namespace logiq::sinks {
 
-HttpNdjsonSink::HttpNdjsonSink(Config cfg) : cfg_(std::move(cfg)) {}
+namespace {
 
-std::string HttpNdjsonSink::to_ndjson(const logiq::Batch &batch) {
-  std::ostringstream out;
+// Serialized records handed to the compressor at a time.
+constexpr std::size_t kChunkBytes = 64 * 1024;
 
-  // NOTE: This is intentionally minimal and not a full JSON implementation.
-  // Replace with a proper JSON library later if needed.
-  for (const auto &r : batch.records) {
-    out << "{";
-    out << "\"ts_ingest_agent_ns\":" << r.ts_ingest_agent_ns << ",";
-    out << "\"payload\":\"";
-
-    // Very naive escaping (placeholder). Replace with proper escaping.
-    for (char c : r.payload) {
-      if (c == '\\' || c == '"')
-        out << '\\';
-      if (c == '\n') {
-        out << "\\n";
-        continue;
-      }
-      if (c == '\r') {
-        out << "\\r";
-        continue;
-      }
-      out << c;
-    }
+} // namespace
 
-    out << "\"";
+template <RecordSerializer Serializer>
+HttpSink<Serializer>::HttpSink(Config cfg) : cfg_(std::move(cfg)) {
+  if (cfg_.compression != Compression::None) {
+    // Fail now on a codec not built in or a bad level, not per batch.
+    std::string probe;
+    CompressedWriter(cfg_.compression, cfg_.compression_level, probe)
+        .finish();
+  }
+  if (!cfg_.url.empty()) {
+    sender_ = std::make_unique<logiq::sender::HttpSender>(
+        logiq::sender::Endpoint::parse(cfg_.url),
+        logiq::sender::HttpSender::Options{
+            .timeout_ms = cfg_.timeout_ms,
+            .max_idle = cfg_.max_idle_connections});
+  }
+}
 
-    if (!r.labels.empty()) {
-      out << ",\"labels\":{";
-      bool first = true;
-      for (const auto &[k, v] : r.labels) {
-        if (!first)
-          out << ",";
-        first = false;
+template <RecordSerializer Serializer>
+std::string
+HttpSink<Serializer>::serialize(const logiq::Batch &batch) const {
+  std::string out;
+  if (cfg_.compression == Compression::None) {
+    // Payload bytes plus a rough allowance for per-record framing.
+    out.reserve(batch.bytes + batch.records.size() * 64);
+    for (const auto &r : batch.records)
+      Serializer::append(out, r);
+    return out;
+  }
 
-        out << "\"" << k << "\":\"" << v << "\"";
-      }
-      out << "}";
+  // The uncompressed body is never built whole: records are compressed a
+  // chunk at a time.
+  thread_local std::string chunk;
+  chunk.clear();
+  out.reserve(batch.bytes / 4 + 64);
+  CompressedWriter writer(cfg_.compression, cfg_.compression_level, out);
+  for (const auto &r : batch.records) {
+    Serializer::append(chunk, r);
+    if (chunk.size() >= kChunkBytes) {
+      writer.write(chunk);
+      chunk.clear();
     }
-
-    out << "}\n";
   }
-
-  return out.str();
+  writer.write(chunk);
+  writer.finish();
+  if (chunk.capacity() > 4 * kChunkBytes)
+    chunk = std::string(); // grown by a huge record; do not keep it
+  return out;
 }
 
-logiq::SendResult HttpNdjsonSink::send(const logiq::Batch &batch) noexcept {
-  // Placeholder logic:
-  // - build NDJSON payload
-  // - pretend to send it
-  // Integrate libcurl (or another HTTP client) later.
-
-  if (cfg_.url.empty()) {
-    return {false, 0, "HttpNdjsonSink: url is empty.", std::nullopt};
+template <RecordSerializer Serializer>
+logiq::SendResult
+HttpSink<Serializer>::send(const logiq::Batch &batch) noexcept {
+  std::string body;
+  try {
+    body = serialize(batch);
+  } catch (const std::exception &e) {
+    return {false, 0, std::string("HttpSink: ") + e.what(), std::nullopt};
   }
+  return send_serialized(batch, body);
+}
 
-  const auto payload = to_ndjson(batch);
+template <RecordSerializer Serializer>
+logiq::SendResult
+HttpSink<Serializer>::send_serialized(const logiq::Batch &batch,
+                                      std::string_view body) noexcept {
+  if (!sender_) {
+    return {false, 0, "HttpSink: url is empty.", std::nullopt};
+  }
 
-  // TODO: perform real HTTP POST to cfg_.url with payload (Content-Type:
-  // application/x-ndjson). For now, pretend it succeeded.
-  (void)payload;
+  logiq::sender::Response response;
+  try {
+    response = sender_->post(Serializer::content_type(),
+                             content_encoding(cfg_.compression), body);
+  } catch (const std::exception &e) {
+    return {false, 0, std::string("HttpSink: ") + e.what(), std::nullopt};
+  }
+  if (!response.ok) {
+    return {false, 0, "HttpSink: " + cfg_.url + ": " + response.message,
+            std::nullopt};
+  }
 
   logiq::SendResult res;
-  res.ok = true;
-  res.http_status = 200;
-  res.message = "OK (stub)";
+  res.http_status = response.status;
+  res.ok = response.status >= 200 && response.status < 300;
+  if (!res.ok) {
+    res.message = "HttpSink: " + cfg_.url + ": HTTP " +
+                  std::to_string(response.status) + " " + response.message;
+    return res;
+  }
+  res.message = "OK";
 
   // Commit decision:
   // If you trust HTTP 200 means the receiver durably stored the batch, provide
@@ -84,4 +114,6 @@ logiq::SendResult HttpNdjsonSink::send(const logiq::Batch &batch) noexcept {
   return res;
 }
 
+template class HttpSink<NdjsonSerializer>;
+
 } // namespace logiq::sinks
@@ -1,36 +1,76 @@
 // File: src/sinks/HttpNdjsonSink.hpp
 #pragma once
 
+#include <memory>
 #include <string>
 #include <string_view>
 
+#include "Compression.hpp"
+#include "NdjsonSerializer.hpp"
 #include "Sink.hpp"
+#include "sender/HttpSender.hpp"
 
 namespace logiq::sinks {
 
-// Minimal HTTP NDJSON sink skeleton.
-// This does not implement real HTTP yet; it is a placeholder for wiring +
-// tests.
-class HttpNdjsonSink final : public logiq::Sink {
+// HTTP sink, parameterized by its body format: every batch is one POST to
+// url over a pool of keep-alive connections (see sender::HttpSender). A
+// 2xx response is an ACK; anything else, or no response within
+// timeout_ms, fails the batch. Bodies may be gzip or zstd compressed.
+//
+// The class is final, so callers holding the concrete type (Agent) call
+// send() directly; the serializer is a template parameter, so batches are
+// serialized without per-record indirection. Instantiated in
+// HttpNdjsonSink.cpp.
+template <RecordSerializer Serializer>
+class HttpSink final : public logiq::Sink {
 public:
   struct Config {
     std::string name{"http"};
-    std::string url; // e.g., https://example.com/ingest
-    int timeout_ms{2000};
+    std::string url; // e.g., http://example.com/ingest (no https)
+    int timeout_ms{2000}; // per request, connecting included
+    std::size_t max_idle_connections{8};
+    Compression compression{Compression::None};
+    int compression_level{0}; // 0 = the codec's default
     bool assume_durable_on_200{true}; // if true, treat ok as commit-eligible
+    std::size_t max_batch_records{0};  // per request; 0 = no limit
+    std::size_t max_batch_bytes{0};    // payload bytes per request; 0 = none
   };
 
-  explicit HttpNdjsonSink(Config cfg);
+  // Throws std::runtime_error if url is set but not an http:// URL, or if
+  // the compression (level) is not available.
+  explicit HttpSink(Config cfg);
 
   std::string_view name() const override { return cfg_.name; }
   logiq::SendResult send(const logiq::Batch &batch) noexcept override;
 
+  // Serialize batch records into one request body, compressed as
+  // configured. Records stream into the compressor through a small
+  // per-thread buffer. Throws std::runtime_error if compression fails.
+  std::string serialize(const logiq::Batch &batch) const;
+
+  // send() in two steps, so that a batch can be serialized on one thread
+  // and sent on another: body is serialize(batch). Safe to call from
+  // several threads at once.
+  logiq::SendResult send_serialized(const logiq::Batch &batch,
+                                    std::string_view body) noexcept;
+
+  std::size_t max_batch_records() const noexcept override {
+    return cfg_.max_batch_records;
+  }
+  std::size_t max_batch_bytes() const noexcept override {
+    return cfg_.max_batch_bytes;
+  }
+
+  // Requests waiting for a response.
+  std::size_t in_flight() const noexcept {
+    return sender_ ? sender_->in_flight() : 0;
+  }
+
 private:
   Config cfg_;
-
-  // Serialize batch records to NDJSON payload.
-  // Each record becomes one JSON line. Keep simple for now.
-  static std::string to_ndjson(const logiq::Batch &batch);
+  std::unique_ptr<logiq::sender::HttpSender> sender_; // null without url
 };
 
+using HttpNdjsonSink = HttpSink<NdjsonSerializer>;
+
 } // namespace logiq::sinks
@@ -0,0 +1,63 @@
+// File: src/sinks/Labels.cpp
+#include "Labels.hpp"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace logiq {
+
+namespace {
+
+// Order-independent key for a label set: "len:key len:value" pairs, sorted
+// by key.
+std::string canonical(const Labels &labels) {
+  std::vector<const std::pair<const std::string, std::string> *> items;
+  items.reserve(labels.size());
+  for (const auto &item : labels)
+    items.push_back(&item);
+  std::sort(items.begin(), items.end(),
+            [](const auto *a, const auto *b) { return a->first < b->first; });
+
+  std::string key;
+  for (const auto *item : items) {
+    key += std::to_string(item->first.size());
+    key += ':';
+    key += item->first;
+    key += std::to_string(item->second.size());
+    key += ':';
+    key += item->second;
+  }
+  return key;
+}
+
+} // namespace
+
+LabelInterner &LabelInterner::instance() {
+  static auto *interner = new LabelInterner();
+  return *interner;
+}
+
+LabelSet LabelInterner::intern(const Labels &labels) {
+  if (labels.empty())
+    return nullptr;
+
+  std::string key = canonical(labels);
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto [it, inserted] = sets_.try_emplace(std::move(key));
+  if (inserted) {
+    auto set = std::make_shared<InternedLabels>();
+    set->id = static_cast<std::uint32_t>(sets_.size());
+    set->labels = labels;
+    it->second = std::move(set);
+  }
+  return it->second;
+}
+
+std::uint32_t LabelInterner::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return static_cast<std::uint32_t>(sets_.size());
+}
+
+} // namespace logiq
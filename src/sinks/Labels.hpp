@@ -0,0 +1,51 @@
+// File: src/sinks/Labels.hpp
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace logiq {
+
+using Labels = std::unordered_map<std::string, std::string>;
+
+// One distinct label set, owned by the LabelInterner. Equal sets are the
+// same object, so the id identifies the set: consumers (e.g. Router) can
+// key caches on it instead of hashing the labels.
+struct InternedLabels {
+  std::uint32_t id{0}; // >= 1; 0 is reserved for "no labels"
+  Labels labels;
+};
+
+// Shared by every record that carries the set (typically all records of an
+// input), so records copy a pointer, not a map. May be null (no labels).
+using LabelSet = std::shared_ptr<const InternedLabels>;
+
+// Id of a record's label set; 0 when it has none.
+inline std::uint32_t label_id(const LabelSet &set) noexcept {
+  return set ? set->id : 0;
+}
+
+// Process-wide table of distinct label sets. Interning hashes the labels
+// once, when a set is created (per input, not per record); sets are never
+// freed, which is fine for the handful a configuration produces.
+// Thread-safe.
+class LabelInterner {
+public:
+  static LabelInterner &instance();
+
+  // The shared set equal to labels; null for an empty set.
+  LabelSet intern(const Labels &labels);
+
+  // Number of distinct sets so far (the largest id handed out).
+  std::uint32_t size() const;
+
+private:
+  mutable std::mutex mutex_;
+  // Canonical (sorted, length-prefixed) encoding -> set.
+  std::unordered_map<std::string, LabelSet> sets_;
+};
+
+} // namespace logiq
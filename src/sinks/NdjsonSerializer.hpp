@@ -0,0 +1,96 @@
+// File: src/sinks/NdjsonSerializer.hpp
+#pragma once
+
+#include <charconv>
+#include <concepts>
+#include <string>
+#include <string_view>
+
+#include "Sink.hpp"
+
+namespace logiq::sinks {
+
+// Turns records into a sink's wire format. Sinks take the serializer as a
+// template parameter, so the per-record loop is compiled for it and
+// append() is inlined.
+template <typename S>
+concept RecordSerializer = requires(std::string &out, const Record &r) {
+  { S::content_type() } -> std::convertible_to<std::string_view>;
+  S::append(out, r);
+};
+
+// Append s to out as the body of a JSON string: '"', '\\' and control
+// characters are escaped, other bytes (including UTF-8) are copied as-is.
+inline void append_json_escaped(std::string &out, std::string_view s) {
+  static constexpr char kHex[] = "0123456789abcdef";
+  std::size_t run = 0; // start of the bytes not copied yet
+  for (std::size_t i = 0; i < s.size(); ++i) {
+    const auto c = static_cast<unsigned char>(s[i]);
+    if (c >= 0x20 && c != '"' && c != '\\')
+      continue;
+    out.append(s.substr(run, i - run));
+    run = i + 1;
+    switch (c) {
+    case '"':
+      out += "\\\"";
+      break;
+    case '\\':
+      out += "\\\\";
+      break;
+    case '\n':
+      out += "\\n";
+      break;
+    case '\r':
+      out += "\\r";
+      break;
+    case '\t':
+      out += "\\t";
+      break;
+    default:
+      out += "\\u00";
+      out += kHex[c >> 4];
+      out += kHex[c & 0xf];
+    }
+  }
+  out.append(s.substr(run));
+}
+
+// One JSON object per line:
+//   {"ts_ingest_agent_ns":N,"payload":"...","labels":{"k":"v",...}}
+struct NdjsonSerializer {
+  static constexpr std::string_view content_type() {
+    return "application/x-ndjson";
+  }
+
+  static void append(std::string &out, const Record &r) {
+    char num[24];
+    const auto ts = std::to_chars(num, num + sizeof(num),
+                                  r.ts_ingest_agent_ns);
+
+    out += "{\"ts_ingest_agent_ns\":";
+    out.append(num, ts.ptr);
+    out += ",\"payload\":\"";
+    append_json_escaped(out, r.payload);
+    out += '"';
+
+    if (r.labels) {
+      out += ",\"labels\":{";
+      bool first = true;
+      for (const auto &[k, v] : r.labels->labels) {
+        if (!first)
+          out += ',';
+        first = false;
+        out += '"';
+        append_json_escaped(out, k);
+        out += "\":\"";
+        append_json_escaped(out, v);
+        out += '"';
+      }
+      out += '}';
+    }
+
+    out += "}\n";
+  }
+};
+
+} // namespace logiq::sinks
@@ -1,25 +1,27 @@
 // File: src/sinks/Sink.hpp
 #pragma once
 
+#include <charconv>
 #include <cstdint>
 #include <optional>
 #include <string>
 #include <string_view>
-#include <unordered_map>
 #include <vector>
 
-namespace logiq {
+#include "Labels.hpp"
+#include "utils/Arena.hpp"
 
-using Labels = std::unordered_map<std::string, std::string>;
+namespace logiq {
 
 struct Record {
   // Raw payload (already framed). Keep it as-is; parsing is optional
-  // upstream/downstream.
-  std::string payload;
+  // upstream/downstream. Not owned: normally a view into Batch::arena, so
+  // it lives exactly as long as the batch's current contents.
+  std::string_view payload;
 
   // Deterministic metadata (set by agent).
   std::int64_t ts_ingest_agent_ns{0}; // nanoseconds since epoch
-  Labels labels;                      // env, service, host, etc.
+  LabelSet labels; // env, service, host, etc. (interned); may be null
 
   // File identity + byte-range (for checkpointing).
   std::uint64_t file_dev{0};
@@ -29,10 +31,16 @@ struct Record {
   std::uint64_t end_offset{0}; // exclusive
 };
 
+// Records of one send, stored contiguously, with their payload bytes in a
+// batch-scoped arena. A batch is meant to be reused: clear() drops all
+// records and payloads at once and keeps the memory for the next one.
 struct Batch {
   std::string batch_id; // unique id (uuid/monotonic)
   std::vector<Record> records;
 
+  // Backing store for the records' payloads.
+  logiq::utils::Arena arena;
+
   // Commit metadata: what can be checkpointed if ACKed.
   std::uint64_t file_dev{0};
   std::uint64_t file_ino{0};
@@ -40,6 +48,35 @@ struct Batch {
   std::uint64_t commit_end_offset{
       0};               // highest end_offset in batch for that file/generation
   std::size_t bytes{0}; // approximate payload size
+
+  // Append a record with a copy of payload in the arena.
+  Record &add(std::string_view payload) {
+    Record &rec = records.emplace_back();
+    rec.payload = arena.copy(payload);
+    bytes += payload.size();
+    return rec;
+  }
+
+  // Set batch_id to "<stream>-<seq>": the input slot the batch was cut
+  // from and its number in that slot's sequence, unique for the life of
+  // the process. Reuses batch_id's buffer.
+  void set_id(std::uint64_t stream, std::uint64_t seq) {
+    char buf[2 * 20 + 1];
+    char *p = std::to_chars(buf, buf + 20, stream).ptr;
+    *p++ = '-';
+    p = std::to_chars(p, buf + sizeof(buf), seq).ptr;
+    batch_id.assign(buf, p);
+  }
+
+  // Forget all records (invalidating their payloads); keeps capacity.
+  void clear() noexcept {
+    batch_id.clear();
+    records.clear();
+    arena.reset();
+    file_dev = file_ino = file_generation = 0;
+    commit_end_offset = 0;
+    bytes = 0;
+  }
 };
 
 struct SendResult {
@@ -62,6 +99,11 @@ public:
 
   // Optional: allow a sink to report if it's currently "ready".
   virtual bool is_ready() const noexcept { return true; }
+
+  // Optional: largest batch the sink accepts (records / payload bytes);
+  // batches are cut to fit. 0 means no limit.
+  virtual std::size_t max_batch_records() const noexcept { return 0; }
+  virtual std::size_t max_batch_bytes() const noexcept { return 0; }
 };
 
 } // namespace logiq
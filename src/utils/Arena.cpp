@@ -0,0 +1,35 @@
+#include "utils/Arena.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace logiq::utils {
+
+char *Arena::allocate(std::size_t n) {
+  if (slabs_.empty() || slabs_.back().capacity() - used_ < n) {
+    slabs_.push_back(
+        BufferPool::instance().acquire(std::max(n, slab_bytes_)));
+    used_ = 0;
+  }
+  char *p = slabs_.back().data() + used_;
+  used_ += n;
+  used_total_ += n;
+  return p;
+}
+
+std::string_view Arena::copy(std::string_view s) {
+  if (s.empty())
+    return {};
+  char *p = allocate(s.size());
+  std::memcpy(p, s.data(), s.size());
+  return {p, s.size()};
+}
+
+void Arena::reset() noexcept {
+  if (slabs_.size() > 1)
+    slabs_.resize(1);
+  used_ = 0;
+  used_total_ = 0;
+}
+
+} // namespace logiq::utils
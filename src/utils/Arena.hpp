@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+#include "utils/BufferPool.hpp"
+
+namespace logiq::utils {
+
+// Bump allocator for bytes that all die together (e.g. the payloads of one
+// batch). Allocation is a pointer increment into the current slab; slabs
+// come from BufferPool and go back to it on reset(), so a steady stream of
+// batches allocates nothing.
+//
+// Not thread-safe. Move-only: views handed out point into the slabs.
+class Arena {
+public:
+  // slab_bytes is the usual slab size; larger requests get their own slab.
+  explicit Arena(std::size_t slab_bytes = 64 * 1024) noexcept
+      : slab_bytes_(slab_bytes) {}
+
+  Arena(Arena &&) noexcept = default;
+  Arena &operator=(Arena &&) noexcept = default;
+  Arena(const Arena &) = delete;
+  Arena &operator=(const Arena &) = delete;
+
+  // n uninitialized bytes, valid until reset().
+  char *allocate(std::size_t n);
+
+  // A copy of s, valid until reset().
+  std::string_view copy(std::string_view s);
+
+  // Free everything at once. The first slab is kept for the next round.
+  void reset() noexcept;
+
+  // Bytes handed out since the last reset().
+  std::size_t bytes_used() const noexcept { return used_total_; }
+
+private:
+  std::size_t slab_bytes_;
+  std::vector<BufferRef> slabs_; // the last one is being filled
+  std::size_t used_{0};          // bytes used in slabs_.back()
+  std::size_t used_total_{0};
+};
+
+} // namespace logiq::utils
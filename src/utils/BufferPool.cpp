@@ -0,0 +1,95 @@
+#include "utils/BufferPool.hpp"
+
+#include <new>
+
+namespace logiq::utils {
+
+BufferRef BufferRef::adopt(char *data, std::size_t capacity,
+                           Buffer::Deleter deleter) {
+  return BufferRef(new Buffer(data, capacity, nullptr, deleter));
+}
+
+void BufferRef::reset() noexcept {
+  if (!buf_)
+    return;
+  if (buf_->refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    if (buf_->pool_) {
+      buf_->pool_->release(buf_);
+    } else {
+      buf_->deleter_(buf_->data_, buf_->capacity_);
+      delete buf_;
+    }
+  }
+  buf_ = nullptr;
+}
+
+BufferPool::BufferPool(std::size_t max_cached_bytes)
+    : max_cached_bytes_(max_cached_bytes) {}
+
+BufferPool::~BufferPool() {
+  for (auto &list : free_) {
+    for (Buffer *b : list) {
+      delete[] b->data();
+      delete b;
+    }
+  }
+}
+
+BufferPool &BufferPool::instance() {
+  static auto *pool = new BufferPool();
+  return *pool;
+}
+
+std::size_t BufferPool::class_of(std::size_t bytes) noexcept {
+  std::size_t cls = 0;
+  std::size_t size = kMinClassBytes;
+  while (size < bytes && cls + 1 < kNumClasses) {
+    size <<= 1;
+    cls++;
+  }
+  return cls;
+}
+
+BufferRef BufferPool::acquire(std::size_t min_bytes) {
+  const std::size_t cls = class_of(min_bytes);
+  const std::size_t capacity = kMinClassBytes << cls;
+
+  if (capacity >= min_bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto &list = free_[cls];
+    if (!list.empty()) {
+      Buffer *b = list.back();
+      list.pop_back();
+      cached_bytes_.fetch_sub(b->capacity(), std::memory_order_relaxed);
+      return BufferRef(b);
+    }
+  }
+
+  // Oversized requests beyond the largest class get an exact-size slab.
+  const std::size_t bytes = capacity >= min_bytes ? capacity : min_bytes;
+  // new char[] default-initializes: no zero-fill.
+  return BufferRef(new Buffer(new char[bytes], bytes, this));
+}
+
+void BufferPool::release(Buffer *buf) noexcept {
+  const std::size_t cls = class_of(buf->capacity());
+  const bool pooled_size = (kMinClassBytes << cls) == buf->capacity();
+
+  if (pooled_size &&
+      cached_bytes_.load(std::memory_order_relaxed) + buf->capacity() <=
+          max_cached_bytes_) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    try {
+      free_[cls].push_back(buf);
+      cached_bytes_.fetch_add(buf->capacity(), std::memory_order_relaxed);
+      return;
+    } catch (const std::bad_alloc &) {
+      // Fall through and free it.
+    }
+  }
+
+  delete[] buf->data();
+  delete buf;
+}
+
+} // namespace logiq::utils
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace logiq::utils {
+
+class BufferPool;
+
+// A byte slab with an intrusive reference count. Pooled slabs are created
+// by BufferPool and go back to it when the last BufferRef is dropped; their
+// bytes are never zero-filled. Foreign memory (e.g. a file mapping) can be
+// wrapped with BufferRef::adopt() and a deleter.
+class Buffer {
+public:
+  using Deleter = void (*)(char *data, std::size_t capacity) noexcept;
+
+  char *data() noexcept { return data_; }
+  const char *data() const noexcept { return data_; }
+  std::size_t capacity() const noexcept { return capacity_; }
+
+private:
+  friend class BufferPool;
+  friend class BufferRef;
+
+  Buffer(char *data, std::size_t capacity, BufferPool *pool,
+         Deleter deleter = nullptr)
+      : data_(data), capacity_(capacity), pool_(pool), deleter_(deleter) {}
+
+  char *data_;
+  std::size_t capacity_;
+  BufferPool *pool_;
+  Deleter deleter_;
+  std::atomic<std::uint32_t> refs_{0};
+};
+
+// Shared handle to a pooled Buffer (like a shared_ptr without the control
+// block allocation). Views into the buffer stay valid while a ref is held.
+class BufferRef {
+public:
+  BufferRef() noexcept = default;
+  ~BufferRef() { reset(); }
+
+  BufferRef(const BufferRef &o) noexcept : buf_(o.buf_) { retain(); }
+  BufferRef(BufferRef &&o) noexcept : buf_(o.buf_) { o.buf_ = nullptr; }
+
+  BufferRef &operator=(const BufferRef &o) noexcept {
+    if (this != &o) {
+      reset();
+      buf_ = o.buf_;
+      retain();
+    }
+    return *this;
+  }
+
+  BufferRef &operator=(BufferRef &&o) noexcept {
+    if (this != &o) {
+      reset();
+      buf_ = o.buf_;
+      o.buf_ = nullptr;
+    }
+    return *this;
+  }
+
+  // Take ownership of foreign memory; deleter runs when the last ref goes.
+  static BufferRef adopt(char *data, std::size_t capacity,
+                         Buffer::Deleter deleter);
+
+  void reset() noexcept;
+
+  char *data() const noexcept { return buf_ ? buf_->data() : nullptr; }
+  std::size_t capacity() const noexcept {
+    return buf_ ? buf_->capacity() : 0;
+  }
+  explicit operator bool() const noexcept { return buf_ != nullptr; }
+
+  // True if this is the only reference (the bytes may be overwritten).
+  bool unique() const noexcept {
+    return buf_ && buf_->refs_.load(std::memory_order_acquire) == 1;
+  }
+
+private:
+  friend class BufferPool;
+
+  explicit BufferRef(Buffer *buf) noexcept : buf_(buf) { retain(); }
+
+  void retain() noexcept {
+    if (buf_)
+      buf_->refs_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  Buffer *buf_{nullptr};
+};
+
+// Recycles read buffers in power-of-two size classes so steady-state reads
+// do no heap allocation. Thread-safe.
+class BufferPool {
+public:
+  static constexpr std::size_t kMinClassBytes = 4 * 1024;
+  static constexpr std::size_t kNumClasses = 16; // 4 KiB .. 128 MiB
+
+  // max_cached_bytes bounds how much idle memory the pool keeps.
+  explicit BufferPool(std::size_t max_cached_bytes = 64 * 1024 * 1024);
+  ~BufferPool();
+
+  BufferPool(const BufferPool &) = delete;
+  BufferPool &operator=(const BufferPool &) = delete;
+
+  // Process-wide pool. Never destroyed, so buffers may outlive main().
+  static BufferPool &instance();
+
+  // A buffer with capacity() >= min_bytes (rounded up to its size class).
+  BufferRef acquire(std::size_t min_bytes);
+
+  std::size_t cached_bytes() const noexcept {
+    return cached_bytes_.load(std::memory_order_relaxed);
+  }
+
+private:
+  friend class BufferRef;
+
+  void release(Buffer *buf) noexcept;
+
+  static std::size_t class_of(std::size_t bytes) noexcept;
+
+  std::size_t max_cached_bytes_;
+  std::atomic<std::size_t> cached_bytes_{0};
+
+  std::mutex mutex_;
+  std::array<std::vector<Buffer *>, kNumClasses> free_;
+};
+
+} // namespace logiq::utils
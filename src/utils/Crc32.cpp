@@ -0,0 +1,57 @@
+#include "utils/Crc32.hpp"
+
+#include <array>
+#include <cstring>
+
+namespace logiq::utils {
+
+namespace {
+
+constexpr std::uint32_t kPoly = 0x82f63b78; // reflected Castagnoli
+
+// Slicing-by-8 tables: kTables[k][b] is the CRC of byte b followed by k
+// zero bytes.
+constexpr auto make_tables() {
+  std::array<std::array<std::uint32_t, 256>, 8> t{};
+  for (std::uint32_t b = 0; b < 256; ++b) {
+    std::uint32_t c = b;
+    for (int i = 0; i < 8; ++i)
+      c = (c >> 1) ^ (kPoly & (0u - (c & 1u)));
+    t[0][b] = c;
+  }
+  for (std::size_t k = 1; k < 8; ++k) {
+    for (std::size_t b = 0; b < 256; ++b)
+      t[k][b] = (t[k - 1][b] >> 8) ^ t[0][t[k - 1][b] & 0xff];
+  }
+  return t;
+}
+
+constexpr auto kTables = make_tables();
+
+} // namespace
+
+std::uint32_t crc32c(const void *data, std::size_t size,
+                     std::uint32_t crc) noexcept {
+  const auto *p = static_cast<const unsigned char *>(data);
+  crc = ~crc;
+
+  while (size >= 8) {
+    std::uint32_t lo;
+    std::uint32_t hi;
+    std::memcpy(&lo, p, 4);
+    std::memcpy(&hi, p + 4, 4);
+    lo ^= crc; // little-endian hosts
+    crc = kTables[7][lo & 0xff] ^ kTables[6][(lo >> 8) & 0xff] ^
+          kTables[5][(lo >> 16) & 0xff] ^ kTables[4][lo >> 24] ^
+          kTables[3][hi & 0xff] ^ kTables[2][(hi >> 8) & 0xff] ^
+          kTables[1][(hi >> 16) & 0xff] ^ kTables[0][hi >> 24];
+    p += 8;
+    size -= 8;
+  }
+  while (size--)
+    crc = (crc >> 8) ^ kTables[0][(crc ^ *p++) & 0xff];
+
+  return ~crc;
+}
+
+} // namespace logiq::utils
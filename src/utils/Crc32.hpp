@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace logiq::utils {
+
+// CRC-32C (Castagnoli) of size bytes at data, continuing from crc (0 to
+// start). Table-driven, 8 bytes per step; used to detect torn or corrupt
+// records in on-disk state.
+std::uint32_t crc32c(const void *data, std::size_t size,
+                     std::uint32_t crc = 0) noexcept;
+
+} // namespace logiq::utils
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+namespace logiq::utils {
+
+// Lets a thread sleep until another one signals new work (an eventcount).
+//
+// The waiter reads epoch(), re-checks its queues, and only then calls
+// wait(epoch, deadline); a ring() in between makes wait() return at once,
+// so no wakeup is lost. ring() is a single atomic increment unless someone
+// is actually asleep, which keeps it cheap on the hot path.
+class Doorbell {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  std::uint64_t epoch() const noexcept { return epoch_.load(); }
+
+  void ring() {
+    epoch_.fetch_add(1);
+    if (sleepers_.load() > 0) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      cv_.notify_all();
+    }
+  }
+
+  // Sleep until ring() was called after epoch() returned seen, or until
+  // deadline.
+  void wait(std::uint64_t seen, Clock::time_point deadline) {
+    sleepers_.fetch_add(1);
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait_until(lock, deadline, [&] { return epoch_.load() != seen; });
+    }
+    sleepers_.fetch_sub(1);
+  }
+
+private:
+  std::atomic<std::uint64_t> epoch_{0};
+  std::atomic<std::uint32_t> sleepers_{0};
+  std::mutex mutex_;
+  std::condition_variable cv_;
+};
+
+} // namespace logiq::utils
@@ -0,0 +1,65 @@
+#include "utils/MemoryBudget.hpp"
+#include "utils/Logger.hpp"
+
+#include <algorithm>
+#include <string>
+
+namespace logiq::utils {
+
+namespace {
+
+std::string describe(const MemoryBudget::Usage &u) {
+  return std::to_string(u.total) + " bytes buffered (framer " +
+         std::to_string(u.stages[0]) + ", batch " +
+         std::to_string(u.stages[1]) + ", queued " +
+         std::to_string(u.stages[2]) + ")";
+}
+
+} // namespace
+
+MemoryBudget &MemoryBudget::instance() {
+  static MemoryBudget *budget = new MemoryBudget(); // never destroyed
+  return *budget;
+}
+
+void MemoryBudget::configure(std::size_t high_bytes,
+                             std::size_t low_bytes) noexcept {
+  high_.store(high_bytes);
+  low_.store(std::min(low_bytes, high_bytes));
+}
+
+bool MemoryBudget::paused() {
+  const std::size_t high = high_.load(std::memory_order_relaxed);
+  if (high == 0)
+    return false;
+
+  const auto used = static_cast<std::size_t>(
+      std::max<std::int64_t>(total_.load(std::memory_order_relaxed), 0));
+  bool was = paused_.load(std::memory_order_relaxed);
+  if (!was && used >= high) {
+    if (paused_.compare_exchange_strong(was, true))
+      Logger::warn("Memory budget reached: " + describe(usage()) +
+                   "; pausing reads");
+    return true;
+  }
+  if (was && used <= low_.load(std::memory_order_relaxed)) {
+    if (paused_.compare_exchange_strong(was, false))
+      Logger::info("Memory back under budget: " + describe(usage()) +
+                   "; resuming reads");
+    return false;
+  }
+  return was;
+}
+
+MemoryBudget::Usage MemoryBudget::usage() const noexcept {
+  Usage u;
+  for (std::size_t i = 0; i < kMemoryStages; ++i) {
+    u.stages[i] = static_cast<std::size_t>(std::max<std::int64_t>(
+        stages_[i].load(std::memory_order_relaxed), 0));
+  }
+  u.total = static_cast<std::size_t>(
+      std::max<std::int64_t>(total_.load(std::memory_order_relaxed), 0));
+  return u;
+}
+
+} // namespace logiq::utils
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace logiq::utils {
+
+// Pipeline stages whose buffered bytes count against the memory budget.
+enum class MemoryStage : std::uint8_t {
+  Framer, // partial lines and held-back records
+  Batch,  // payloads of open batches
+  Queued, // chunks and batches travelling between runtime stages
+};
+inline constexpr std::size_t kMemoryStages = 3;
+
+// Process-wide budget for the log data the agent buffers.
+//
+// Owners charge bytes per stage through MemoryCharge (one relaxed atomic
+// add per change). Readers ask paused() before reading more: it turns true
+// once usage reaches the high watermark and stays true until usage falls
+// to the low one, so reading stops and restarts cleanly instead of
+// flapping around a single threshold while the backend is slow.
+class MemoryBudget {
+public:
+  struct Usage {
+    std::size_t total{0};
+    std::array<std::size_t, kMemoryStages> stages{};
+  };
+
+  static MemoryBudget &instance();
+
+  // high_bytes 0 never pauses (usage is still tracked). low_bytes is
+  // clamped to high_bytes.
+  void configure(std::size_t high_bytes, std::size_t low_bytes) noexcept;
+
+  // True while readers should not read (see above). Logs transitions.
+  bool paused();
+
+  // Current usage, e.g. for metrics.
+  Usage usage() const noexcept;
+
+  void charge(MemoryStage stage, std::int64_t delta) noexcept {
+    stages_[static_cast<std::size_t>(stage)].fetch_add(
+        delta, std::memory_order_relaxed);
+    total_.fetch_add(delta, std::memory_order_relaxed);
+  }
+
+private:
+  std::array<std::atomic<std::int64_t>, kMemoryStages> stages_{};
+  std::atomic<std::int64_t> total_{0};
+  std::atomic<std::size_t> high_{0};
+  std::atomic<std::size_t> low_{0};
+  std::atomic<bool> paused_{false};
+};
+
+// Bytes one owner holds in one stage; the budget follows every set() and
+// is given back on destruction. Move-only, so a charge can travel with the
+// data it accounts for (e.g. through a queue).
+class MemoryCharge {
+public:
+  explicit MemoryCharge(MemoryStage stage = MemoryStage::Framer) noexcept
+      : stage_(stage) {}
+  ~MemoryCharge() { set(0); }
+
+  MemoryCharge(MemoryCharge &&o) noexcept
+      : stage_(o.stage_), bytes_(o.bytes_) {
+    o.bytes_ = 0;
+  }
+  MemoryCharge &operator=(MemoryCharge &&o) noexcept {
+    if (this != &o) {
+      set(0);
+      stage_ = o.stage_;
+      bytes_ = o.bytes_;
+      o.bytes_ = 0;
+    }
+    return *this;
+  }
+  MemoryCharge(const MemoryCharge &) = delete;
+  MemoryCharge &operator=(const MemoryCharge &) = delete;
+
+  void set(std::size_t bytes) noexcept {
+    if (bytes == bytes_)
+      return;
+    MemoryBudget::instance().charge(
+        stage_, static_cast<std::int64_t>(bytes) -
+                    static_cast<std::int64_t>(bytes_));
+    bytes_ = bytes;
+  }
+
+  std::size_t bytes() const noexcept { return bytes_; }
+
+private:
+  MemoryStage stage_;
+  std::size_t bytes_{0};
+};
+
+} // namespace logiq::utils
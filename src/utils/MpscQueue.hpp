@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace logiq::utils {
+
+// Bounded multi-producer/single-consumer ring queue, lock-free.
+//
+// Each slot carries a sequence number telling whose turn it is (Vyukov's
+// bounded queue): producers claim a slot with one CAS on the tail and
+// publish it by bumping its sequence, so producers never wait for each
+// other to finish copying. The single consumer needs no atomic RMW at all.
+template <typename T> class MpscQueue {
+public:
+  // capacity is rounded up to a power of two.
+  explicit MpscQueue(std::size_t capacity)
+      : capacity_(round_up(capacity)), mask_(capacity_ - 1),
+        cells_(std::make_unique<Cell[]>(capacity_)) {
+    for (std::size_t i = 0; i < capacity_; ++i)
+      cells_[i].seq.store(i, std::memory_order_relaxed);
+  }
+
+  MpscQueue(const MpscQueue &) = delete;
+  MpscQueue &operator=(const MpscQueue &) = delete;
+
+  // Any thread. Moves from value and returns true, or returns false (value
+  // untouched) if the queue is full.
+  bool try_push(T &value) {
+    std::size_t pos = tail_.load(std::memory_order_relaxed);
+    Cell *cell;
+    while (true) {
+      cell = &cells_[pos & mask_];
+      const std::size_t seq = cell->seq.load(std::memory_order_acquire);
+      const auto diff =
+          static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+      if (diff == 0) {
+        if (tail_.compare_exchange_weak(pos, pos + 1,
+                                        std::memory_order_relaxed))
+          break;
+      } else if (diff < 0) {
+        return false; // full: the consumer has not freed this slot yet
+      } else {
+        pos = tail_.load(std::memory_order_relaxed);
+      }
+    }
+    cell->value = std::move(value);
+    cell->seq.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer only. Returns false if the queue is empty (or the next
+  // producer has claimed its slot but not finished writing it).
+  bool try_pop(T &out) {
+    Cell &cell = cells_[head_ & mask_];
+    if (cell.seq.load(std::memory_order_acquire) != head_ + 1)
+      return false;
+    out = std::move(cell.value);
+    cell.seq.store(head_ + capacity_, std::memory_order_release);
+    ++head_;
+    return true;
+  }
+
+  std::size_t capacity() const noexcept { return capacity_; }
+
+private:
+  static constexpr std::size_t kLine = 64;
+
+  struct Cell {
+    std::atomic<std::size_t> seq{0};
+    T value = T();
+  };
+
+  static std::size_t round_up(std::size_t n) {
+    std::size_t cap = 2;
+    while (cap < n)
+      cap <<= 1;
+    return cap;
+  }
+
+  const std::size_t capacity_;
+  const std::size_t mask_;
+  std::unique_ptr<Cell[]> cells_;
+
+  alignas(kLine) std::atomic<std::size_t> tail_{0}; // producers
+  alignas(kLine) std::size_t head_{0};              // consumer
+};
+
+} // namespace logiq::utils
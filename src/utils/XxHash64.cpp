@@ -0,0 +1,87 @@
+#include "utils/XxHash64.hpp"
+
+#include <cstring>
+
+namespace logiq::utils {
+
+namespace {
+
+constexpr std::uint64_t kP1 = 11400714785074694791ULL;
+constexpr std::uint64_t kP2 = 14029467366897019727ULL;
+constexpr std::uint64_t kP3 = 1609587929392839161ULL;
+constexpr std::uint64_t kP4 = 9650029242287828579ULL;
+constexpr std::uint64_t kP5 = 2870177450012600261ULL;
+
+constexpr std::uint64_t rotl(std::uint64_t x, int r) noexcept {
+  return (x << r) | (x >> (64 - r));
+}
+
+std::uint64_t read64(const unsigned char *p) noexcept {
+  std::uint64_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+std::uint32_t read32(const unsigned char *p) noexcept {
+  std::uint32_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+constexpr std::uint64_t round(std::uint64_t acc, std::uint64_t in) noexcept {
+  return rotl(acc + in * kP2, 31) * kP1;
+}
+
+constexpr std::uint64_t merge(std::uint64_t h, std::uint64_t v) noexcept {
+  return (h ^ round(0, v)) * kP1 + kP4;
+}
+
+} // namespace
+
+std::uint64_t xxhash64(const void *data, std::size_t size,
+                       std::uint64_t seed) noexcept {
+  const auto *p = static_cast<const unsigned char *>(data);
+  const auto *end = p + size;
+  std::uint64_t h;
+
+  if (size >= 32) {
+    // Four independent lanes over 32-byte stripes.
+    std::uint64_t v1 = seed + kP1 + kP2;
+    std::uint64_t v2 = seed + kP2;
+    std::uint64_t v3 = seed;
+    std::uint64_t v4 = seed - kP1;
+    for (; end - p >= 32; p += 32) {
+      v1 = round(v1, read64(p));
+      v2 = round(v2, read64(p + 8));
+      v3 = round(v3, read64(p + 16));
+      v4 = round(v4, read64(p + 24));
+    }
+    h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+    h = merge(h, v1);
+    h = merge(h, v2);
+    h = merge(h, v3);
+    h = merge(h, v4);
+  } else {
+    h = seed + kP5;
+  }
+  h += size;
+
+  for (; end - p >= 8; p += 8)
+    h = rotl(h ^ round(0, read64(p)), 27) * kP1 + kP4;
+  if (end - p >= 4) {
+    h = rotl(h ^ (read32(p) * kP1), 23) * kP2 + kP3;
+    p += 4;
+  }
+  for (; p < end; ++p)
+    h = rotl(h ^ (*p * kP5), 11) * kP1;
+
+  // Avalanche.
+  h ^= h >> 33;
+  h *= kP2;
+  h ^= h >> 29;
+  h *= kP3;
+  h ^= h >> 32;
+  return h;
+}
+
+} // namespace logiq::utils
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace logiq::utils {
+
+// XXH64 of size bytes at data. Fast and well distributed, not
+// cryptographic; used to fingerprint file contents. Reads words in host
+// byte order, so hashes are only comparable on the host that made them.
+std::uint64_t xxhash64(const void *data, std::size_t size,
+                       std::uint64_t seed = 0) noexcept;
+
+} // namespace logiq::utils
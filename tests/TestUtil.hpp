@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <utility>
+
+namespace logiq::test {
+
+// CHECK failures so far; a test passed if it added none.
+inline int failures = 0;
+
+// Runs each {name, fn} test, prints its result and returns the process
+// exit code: non-zero if any CHECK failed.
+template <std::size_t N>
+int run(const std::pair<const char *, void (*)()> (&tests)[N]) {
+  for (const auto &[name, fn] : tests) {
+    const int before = failures;
+    fn();
+    std::printf("%-20s %s\n", name, failures == before ? "ok" : "FAILED");
+  }
+  return failures == 0 ? 0 : 1;
+}
+
+} // namespace logiq::test
+
+// Records a failure and keeps going, so one run reports every failed check.
+#define CHECK(cond)                                                          \
+  do {                                                                       \
+    if (!(cond)) {                                                           \
+      std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__,  \
+                   #cond);                                                   \
+      ++logiq::test::failures;                                               \
+    }                                                                        \
+  } while (0)
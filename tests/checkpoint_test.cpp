@@ -0,0 +1,602 @@
+// Checkpoint bookkeeping: CommitTracker turning batch results into commit
+// advances, and the CheckpointJournal and CheckpointIndex files, in a
+// scratch directory.
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "TestUtil.hpp"
+#include "checkpoint/CheckpointIndex.hpp"
+#include "checkpoint/CheckpointJournal.hpp"
+#include "core/CommitTracker.hpp"
+
+using logiq::checkpoint::Checkpoint;
+using logiq::checkpoint::CheckpointIndex;
+using logiq::checkpoint::CheckpointJournal;
+using logiq::core::CommitTracker;
+using logiq::file::FileIdentity;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// A fresh directory, removed with everything in it.
+struct ScratchDir {
+  fs::path path;
+  ScratchDir() {
+    std::string t = fs::temp_directory_path() / "checkpoint_test.XXXXXX";
+    if (!::mkdtemp(t.data()))
+      throw std::runtime_error("mkdtemp failed");
+    path = t;
+  }
+  ~ScratchDir() { fs::remove_all(path); }
+  std::string file(const char *name) const { return path / name; }
+};
+
+void append_bytes(const std::string &path, const std::string &bytes) {
+  std::ofstream(path, std::ios::binary | std::ios::app) << bytes;
+}
+
+// Flip one byte of a file in place.
+void flip_byte(const std::string &path, std::streamoff at) {
+  std::fstream f(path, std::ios::binary | std::ios::in | std::ios::out);
+  f.seekg(at);
+  const char c = static_cast<char>(f.get() ^ 0x5a);
+  f.seekp(at);
+  f.put(c);
+}
+
+using Advances = std::vector<CommitTracker::Advance>;
+
+bool same(const Advances &got, const Advances &want) {
+  if (got.size() != want.size())
+    return false;
+  for (std::size_t i = 0; i < got.size(); ++i) {
+    if (got[i].id != want[i].id || got[i].generation != want[i].generation ||
+        got[i].offset != want[i].offset)
+      return false;
+  }
+  return true;
+}
+
+const FileIdentity kFile{1, 100};
+const FileIdentity kOther{1, 200};
+
+void test_in_order() {
+  CommitTracker t;
+  Advances out;
+  t.resolve(0, kFile, 0, 10, true, out);
+  t.resolve(1, kFile, 0, 25, true, out);
+  CHECK(same(out, {{kFile, 0, 10}, {kFile, 0, 25}}));
+  CHECK(t.pending() == 0);
+}
+
+void test_out_of_order() {
+  // Later batches wait for earlier ones, then apply in batch order.
+  CommitTracker t(100);
+  Advances out;
+  t.resolve(102, kFile, 0, 30, true, out);
+  t.resolve(101, kOther, 0, 7, true, out);
+  CHECK(out.empty());
+  CHECK(t.pending() == 2);
+  t.resolve(100, kFile, 0, 10, true, out);
+  CHECK(same(out, {{kFile, 0, 10}, {kOther, 0, 7}, {kFile, 0, 30}}));
+  CHECK(t.pending() == 0);
+
+  // Already resolved: ignored.
+  out.clear();
+  t.resolve(101, kOther, 0, 99, true, out);
+  t.resolve(5, kFile, 0, 99, true, out);
+  CHECK(out.empty());
+  CHECK(t.pending() == 0);
+}
+
+void test_gap_stops_generation() {
+  // A failed batch stops its file generation from committing past it,
+  // even when later batches of it succeed (and arrive first).
+  CommitTracker t;
+  Advances out;
+  t.resolve(0, kFile, 3, 10, true, out);
+  t.resolve(2, kFile, 3, 30, true, out);
+  t.resolve(1, kFile, 3, 20, false, out);
+  t.resolve(3, kFile, 3, 40, true, out);
+  CHECK(same(out, {{kFile, 3, 10}}));
+
+  // A result of another generation retires the gap: the input has moved
+  // on and never comes back to generation 3.
+  out.clear();
+  t.resolve(4, kFile, 4, 5, true, out);
+  t.resolve(5, kFile, 4, 9, true, out);
+  CHECK(same(out, {{kFile, 4, 5}, {kFile, 4, 9}}));
+}
+
+void test_gap_other_file() {
+  // Another file's result also retires the gap, and is itself applied.
+  CommitTracker t;
+  Advances out;
+  t.resolve(0, kFile, 0, 10, false, out);
+  t.resolve(1, kOther, 0, 50, true, out);
+  t.resolve(2, kFile, 0, 20, true, out);
+  CHECK(same(out, {{kOther, 0, 50}, {kFile, 0, 20}}));
+}
+
+void test_generations() {
+  // A truncate starts a new generation of the same file; advances carry
+  // it so the commit point is never compared across generations.
+  CommitTracker t;
+  Advances out;
+  t.resolve(1, kFile, 1, 4, true, out);
+  t.resolve(0, kFile, 0, 900, true, out);
+  t.resolve(2, kFile, 1, 8, true, out);
+  CHECK(same(out, {{kFile, 0, 900}, {kFile, 1, 4}, {kFile, 1, 8}}));
+}
+
+Checkpoint cp(std::uint64_t ino, std::uint64_t offset,
+              std::uint64_t generation = 0) {
+  Checkpoint c;
+  c.file_id = {7, ino};
+  c.generation = generation;
+  c.committed_offset = offset;
+  c.fingerprint = {0xfeedULL + ino, 1024};
+  return c;
+}
+
+// What a replay handed out: ino, offset, seq and erase per record.
+struct Replayed {
+  std::uint64_t ino, offset, seq;
+  bool erase;
+  bool operator==(const Replayed &) const = default;
+};
+
+std::vector<Replayed> reopen(const std::string &base, std::uint64_t after,
+                             std::uint64_t *newest = nullptr) {
+  std::vector<Replayed> got;
+  CheckpointJournal j(base);
+  const auto seq = j.open(after, [&](const Checkpoint &c, std::uint64_t s,
+                                     bool erase) {
+    got.push_back({c.file_id.ino, c.committed_offset, s, erase});
+  });
+  if (newest)
+    *newest = seq;
+  return got;
+}
+
+void test_journal_replay() {
+  ScratchDir dir;
+  const auto base = dir.file("cp");
+  {
+    CheckpointJournal j(base);
+    bool replayed = false;
+    CHECK(j.open(0, [&](const Checkpoint &, std::uint64_t, bool) {
+      replayed = true;
+    }) == 0);
+    CHECK(!replayed);
+    CHECK(j.append({cp(1, 10), cp(2, 20, 3)}, {{7, 9}}) == 1);
+    CHECK(j.append({}, {}) == 4);
+    CHECK(j.append({cp(1, 15)}, {}) == 4);
+    CHECK(j.records() == 4);
+  }
+  std::vector<Replayed> got;
+  CheckpointJournal j(base);
+  std::uint64_t generation = 0, hash = 0;
+  CHECK(j.open(0, [&](const Checkpoint &c, std::uint64_t s, bool erase) {
+    got.push_back({c.file_id.ino, c.committed_offset, s, erase});
+    if (c.file_id.ino == 2) {
+      generation = c.generation;
+      hash = c.fingerprint.hash;
+    }
+  }) == 4);
+  const std::vector<Replayed> want = {
+      {1, 10, 1, false}, {2, 20, 2, false}, {9, 0, 3, true}, {1, 15, 4, false}};
+  CHECK(got == want);
+  CHECK(generation == 3 && hash == 0xfeedULL + 2);
+  CHECK(j.records() == 4);
+  // Numbering carries on after the replayed records.
+  CHECK(j.append({cp(3, 30)}, {}) == 5);
+}
+
+void test_journal_after() {
+  // Records the index already covers are skipped but still numbered.
+  ScratchDir dir;
+  const auto base = dir.file("cp");
+  {
+    CheckpointJournal j(base);
+    j.open(0, [](const Checkpoint &, std::uint64_t, bool) {});
+    j.append({cp(1, 10), cp(2, 20), cp(3, 30)}, {});
+  }
+  std::uint64_t newest = 0;
+  const std::vector<Replayed> want = {{3, 30, 3, false}};
+  CHECK(reopen(base, 2, &newest) == want);
+  CHECK(newest == 3);
+  // An index newer than the journal: nothing replayed, numbering from it.
+  CHECK(reopen(base, 10, &newest).empty());
+  CHECK(newest == 10);
+}
+
+void test_journal_torn_tail() {
+  // A crash mid-append leaves part of a record; open() drops it and cuts
+  // the file back to whole records so appends follow the last good one.
+  ScratchDir dir;
+  const auto base = dir.file("cp");
+  const auto path = base + ".journal";
+  {
+    CheckpointJournal j(base);
+    j.open(0, [](const Checkpoint &, std::uint64_t, bool) {});
+    j.append({cp(1, 10), cp(2, 20)}, {});
+  }
+  append_bytes(path, std::string(40, '\x7f'));
+  CHECK(fs::file_size(path) == 2 * 64 + 40);
+  {
+    std::vector<Replayed> got;
+    CheckpointJournal j(base);
+    CHECK(j.open(0, [&](const Checkpoint &c, std::uint64_t s, bool e) {
+      got.push_back({c.file_id.ino, c.committed_offset, s, e});
+    }) == 2);
+    CHECK(got.size() == 2);
+    CHECK(j.records() == 2);
+    CHECK(fs::file_size(path) == 2 * 64);
+    CHECK(j.append({cp(3, 30)}, {}) == 3);
+  }
+  const std::vector<Replayed> want = {
+      {1, 10, 1, false}, {2, 20, 2, false}, {3, 30, 3, false}};
+  CHECK(reopen(base, 0) == want);
+}
+
+void test_journal_crc() {
+  // A record whose CRC does not match ends replay there: it and every
+  // record after it are cut off, even if those are intact.
+  ScratchDir dir;
+  const auto base = dir.file("cp");
+  const auto path = base + ".journal";
+  {
+    CheckpointJournal j(base);
+    j.open(0, [](const Checkpoint &, std::uint64_t, bool) {});
+    j.append({cp(1, 10), cp(2, 20), cp(3, 30)}, {});
+  }
+  flip_byte(path, 64 + 40); // record 2's offset
+  const std::vector<Replayed> want = {{1, 10, 1, false}};
+  CHECK(reopen(base, 0) == want);
+  CHECK(fs::file_size(path) == 64);
+
+  // A corrupt CRC field itself is caught the same way.
+  flip_byte(path, 0);
+  CHECK(reopen(base, 0).empty());
+  CHECK(fs::file_size(path) == 0);
+}
+
+void test_journal_rotate() {
+  ScratchDir dir;
+  const auto base = dir.file("cp");
+  {
+    CheckpointJournal j(base);
+    j.open(0, [](const Checkpoint &, std::uint64_t, bool) {});
+    j.append({cp(1, 10), cp(2, 20)}, {});
+    CHECK(!j.rotated());
+    CHECK(j.rotate() == 2);
+    CHECK(j.rotated());
+    CHECK(j.records() == 0);
+    CHECK(j.append({cp(1, 11)}, {{7, 2}}) == 3);
+  }
+  CHECK(fs::file_size(base + ".journal.old") == 2 * 64);
+  CHECK(fs::file_size(base + ".journal") == 2 * 64);
+
+  // Replay reads the rotated journal first, so the current one's newer
+  // records land last.
+  const std::vector<Replayed> want = {{1, 10, 1, false},
+                                      {2, 20, 2, false},
+                                      {1, 11, 3, false},
+                                      {2, 0, 4, true}};
+  CHECK(reopen(base, 0) == want);
+  const std::vector<Replayed> newer = {{1, 11, 3, false}, {2, 0, 4, true}};
+  CHECK(reopen(base, 2) == newer);
+
+  // Only the current journal is cut on a bad tail; the rotated one is
+  // left for the index to catch up with.
+  append_bytes(base + ".journal", "torn");
+  CHECK(reopen(base, 0) == want);
+  CHECK(fs::file_size(base + ".journal.old") == 2 * 64);
+  CHECK(fs::file_size(base + ".journal") == 2 * 64);
+
+  CheckpointJournal j(base);
+  j.open(2, [](const Checkpoint &, std::uint64_t, bool) {});
+  j.drop_rotated();
+  CHECK(!j.rotated());
+  CHECK(!fs::exists(base + ".journal.old"));
+  CHECK(reopen(base, 0) == newer);
+}
+
+constexpr std::uintmax_t index_bytes(std::uintmax_t capacity) {
+  return 64 + capacity * 64;
+}
+
+std::uint64_t offset_of(const CheckpointIndex &index, std::uint64_t ino) {
+  const auto c = index.find({7, ino});
+  return c ? c->committed_offset : ~0ULL;
+}
+
+// n inos whose slots all start in the same bucket of a table of capacity
+// slots.
+std::vector<std::uint64_t> colliding(std::size_t n, std::size_t capacity) {
+  const auto bucket = [&](std::uint64_t ino) {
+    return std::hash<FileIdentity>{}({7, ino}) & (capacity - 1);
+  };
+  std::vector<std::uint64_t> out{1};
+  for (std::uint64_t ino = 2; out.size() < n; ++ino) {
+    if (bucket(ino) == bucket(1))
+      out.push_back(ino);
+  }
+  return out;
+}
+
+// n inos whose slots start in n different buckets of a table of capacity
+// slots.
+std::vector<std::uint64_t> spread(std::size_t n, std::size_t capacity) {
+  std::vector<bool> taken(capacity);
+  std::vector<std::uint64_t> out;
+  for (std::uint64_t ino = 1; out.size() < n; ++ino) {
+    const auto b = std::hash<FileIdentity>{}({7, ino}) & (capacity - 1);
+    if (!taken[b]) {
+      taken[b] = true;
+      out.push_back(ino);
+    }
+  }
+  return out;
+}
+
+void test_index_basic() {
+  ScratchDir dir;
+  const auto path = dir.file("cp");
+  {
+    CheckpointIndex index(path);
+    index.open();
+    CHECK(index.size() == 0 && index.covered() == 0);
+    CHECK(fs::file_size(path) == index_bytes(1024));
+    index.put(cp(1, 10, 2), 1);
+    index.put(cp(2, 20), 2);
+    index.put(cp(1, 11, 2), 3);
+    CHECK(index.size() == 2);
+    const auto c = index.find({7, 1});
+    CHECK(c && c->committed_offset == 11 && c->generation == 2 &&
+          c->fingerprint.hash == 0xfeedULL + 1);
+    CHECK(!index.find({7, 3}));
+    CHECK(!index.find({8, 1}));
+    index.erase({7, 2}, 4);
+    index.erase({7, 3}, 5); // not there: nothing to do
+    CHECK(index.size() == 1);
+    CHECK(!index.find({7, 2}));
+    index.sync();
+    index.set_covered(4);
+  }
+  CheckpointIndex index(path);
+  index.open();
+  CHECK(index.size() == 1 && index.covered() == 4);
+  CHECK(offset_of(index, 1) == 11);
+  CHECK(!index.find({7, 2}));
+  std::size_t seen = 0;
+  index.for_each([&](const Checkpoint &) { ++seen; });
+  CHECK(seen == 1);
+}
+
+void test_index_seq() {
+  // Journal replay hands the index updates it may already have; only a
+  // newer sequence number changes a slot, erased slots included.
+  ScratchDir dir;
+  CheckpointIndex index(dir.file("cp"));
+  index.open();
+  index.put(cp(1, 50), 5);
+  index.put(cp(1, 30), 3);
+  index.put(cp(1, 50), 5);
+  CHECK(offset_of(index, 1) == 50);
+  index.erase({7, 1}, 4);
+  CHECK(offset_of(index, 1) == 50);
+  index.erase({7, 1}, 6);
+  index.put(cp(1, 50), 5);
+  CHECK(!index.find({7, 1}));
+  CHECK(index.size() == 0);
+  index.put(cp(1, 70), 7);
+  CHECK(offset_of(index, 1) == 70);
+  CHECK(index.size() == 1);
+}
+
+void test_index_probe_chain() {
+  // Entries that share a bucket sit one after another; erasing one in
+  // the middle must not cut off the ones behind it.
+  ScratchDir dir;
+  CheckpointIndex index(dir.file("cp"));
+  index.open();
+  const auto ids = colliding(5, 1024);
+  std::uint64_t seq = 0;
+  for (std::size_t i = 0; i < 4; ++i)
+    index.put(cp(ids[i], 100 + i), ++seq);
+  index.erase({7, ids[1]}, ++seq);
+  CHECK(!index.find({7, ids[1]}));
+  CHECK(offset_of(index, ids[0]) == 100);
+  CHECK(offset_of(index, ids[2]) == 102);
+  CHECK(offset_of(index, ids[3]) == 103);
+
+  // Updating an entry past the hole finds it, not the hole.
+  index.put(cp(ids[3], 203), ++seq);
+  CHECK(offset_of(index, ids[3]) == 203);
+  CHECK(index.size() == 3);
+  std::size_t seen = 0;
+  index.for_each([&](const Checkpoint &) { ++seen; });
+  CHECK(seen == 3);
+
+  // A new entry reuses the hole; the rest of the chain is untouched.
+  index.put(cp(ids[4], 104), ++seq);
+  CHECK(index.size() == 4);
+  CHECK(offset_of(index, ids[4]) == 104);
+  CHECK(offset_of(index, ids[2]) == 102);
+  CHECK(offset_of(index, ids[3]) == 203);
+  index.erase({7, ids[0]}, ++seq);
+  index.erase({7, ids[4]}, ++seq);
+  CHECK(offset_of(index, ids[2]) == 102);
+  CHECK(offset_of(index, ids[3]) == 203);
+  CHECK(index.size() == 2);
+}
+
+void test_index_rehash() {
+  // Past 3/4 full the table is rebuilt twice the size in path.tmp and
+  // renamed over the index.
+  ScratchDir dir;
+  const auto path = dir.file("cp");
+  {
+    CheckpointIndex index(path);
+    index.open();
+    for (std::uint64_t i = 1; i <= 800; ++i)
+      index.put(cp(i, i * 10), i);
+    CHECK(index.size() == 800);
+    CHECK(fs::file_size(path) == index_bytes(2048));
+    CHECK(!fs::exists(path + ".tmp"));
+    bool all = true;
+    for (std::uint64_t i = 1; i <= 800; ++i)
+      all = all && offset_of(index, i) == i * 10;
+    CHECK(all);
+    index.sync();
+  }
+  CheckpointIndex index(path);
+  index.open();
+  CHECK(index.size() == 800);
+  bool all = true;
+  for (std::uint64_t i = 1; i <= 800; ++i)
+    all = all && offset_of(index, i) == i * 10;
+  CHECK(all);
+}
+
+void test_index_rehash_erased() {
+  // Erased slots count towards the load. A rehash drops those the index
+  // covers, so the table need not grow; uncovered ones are kept so older
+  // journal records cannot bring their entries back. Every entry gets a
+  // bucket of its own, so none is written over an erased slot.
+  for (const bool covered : {true, false}) {
+    ScratchDir dir;
+    const auto path = dir.file("cp");
+    CheckpointIndex index(path);
+    index.open();
+    const auto ids = spread(770, 1024);
+    std::uint64_t seq = 0;
+    for (std::size_t i = 0; i < 700; ++i)
+      index.put(cp(ids[i], i), ++seq);
+    for (std::size_t i = 0; i < 600; ++i)
+      index.erase({7, ids[i]}, ++seq);
+    if (covered) {
+      index.sync();
+      index.set_covered(seq);
+    }
+    CHECK(fs::file_size(path) == index_bytes(1024));
+    for (std::size_t i = 700; i < 770; ++i)
+      index.put(cp(ids[i], i), ++seq);
+    CHECK(index.size() == 170);
+    CHECK(fs::file_size(path) == index_bytes(covered ? 1024 : 2048));
+    CHECK(!fs::exists(path + ".tmp"));
+    CHECK(!index.find({7, ids[0]}) && offset_of(index, ids[600]) == 600 &&
+          offset_of(index, ids[769]) == 769);
+    index.put(cp(ids[0], 0), 1);
+    CHECK(index.find({7, ids[0]}).has_value() == covered);
+  }
+}
+
+void test_index_torn_slot() {
+  // A slot that fails its CRC reads as free and is written over.
+  ScratchDir dir;
+  const auto path = dir.file("cp");
+  {
+    CheckpointIndex index(path);
+    index.open();
+    index.put(cp(1, 10), 1);
+    index.put(cp(2, 20), 2);
+    index.sync();
+  }
+  const auto slot = std::hash<FileIdentity>{}({7, 1}) & 1023;
+  flip_byte(path, static_cast<std::streamoff>(64 + slot * 64 + 40));
+  CheckpointIndex index(path);
+  index.open();
+  CHECK(!index.find({7, 1}));
+  CHECK(index.size() == 1 && offset_of(index, 2) == 20);
+  index.put(cp(1, 10), 1);
+  CHECK(offset_of(index, 1) == 10);
+  CHECK(index.size() == 2);
+}
+
+void test_index_old_version() {
+  // A version 1 index (no fingerprints) is discarded and started over.
+  ScratchDir dir;
+  const auto path = dir.file("cp");
+  {
+    struct {
+      std::uint64_t magic = 0x3158444950434c4cULL;
+      std::uint32_t version = 1;
+    } v1;
+    std::string file(index_bytes(1024), '\x11');
+    std::memcpy(file.data(), &v1, sizeof(v1));
+    append_bytes(path, file);
+  }
+  CheckpointIndex index(path);
+  index.open();
+  CHECK(index.size() == 0 && index.covered() == 0);
+  CHECK(fs::file_size(path) == index_bytes(1024));
+  index.put(cp(1, 10), 1);
+  CHECK(offset_of(index, 1) == 10);
+}
+
+bool open_throws(const std::string &path) {
+  try {
+    CheckpointIndex(path).open();
+  } catch (const std::runtime_error &) {
+    return true;
+  }
+  return false;
+}
+
+void test_index_invalid() {
+  ScratchDir dir;
+  const auto path = dir.file("cp");
+  append_bytes(path, "not an index");
+  CHECK(open_throws(path));
+  CHECK(fs::file_size(path) == 12); // left alone
+
+  // A current index with a damaged header, or cut short.
+  const auto good = dir.file("good");
+  CheckpointIndex(good).open();
+  fs::copy_file(good, dir.file("bad_header"));
+  flip_byte(dir.file("bad_header"), 20);
+  CHECK(open_throws(dir.file("bad_header")));
+  fs::copy_file(good, dir.file("short"));
+  fs::resize_file(dir.file("short"), index_bytes(1024) - 64);
+  CHECK(open_throws(dir.file("short")));
+  CHECK(!open_throws(good));
+}
+
+} // namespace
+
+int main() {
+  const std::pair<const char *, void (*)()> tests[] = {
+      {"in_order", test_in_order},
+      {"out_of_order", test_out_of_order},
+      {"gap", test_gap_stops_generation},
+      {"gap_other_file", test_gap_other_file},
+      {"generations", test_generations},
+      {"journal_replay", test_journal_replay},
+      {"journal_after", test_journal_after},
+      {"journal_torn_tail", test_journal_torn_tail},
+      {"journal_crc", test_journal_crc},
+      {"journal_rotate", test_journal_rotate},
+      {"index_basic", test_index_basic},
+      {"index_seq", test_index_seq},
+      {"index_probe_chain", test_index_probe_chain},
+      {"index_rehash", test_index_rehash},
+      {"index_rehash_erased", test_index_rehash_erased},
+      {"index_torn_slot", test_index_torn_slot},
+      {"index_old_version", test_index_old_version},
+      {"index_invalid", test_index_invalid},
+  };
+  return logiq::test::run(tests);
+}
@@ -0,0 +1,173 @@
+// CompressedWriter bodies decoded again with the codec libraries
+// themselves (each codec's cases only run when it is built in).
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "TestUtil.hpp"
+#include "sinks/Compression.hpp"
+
+#ifdef LOGIQ_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef LOGIQ_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+using logiq::sinks::Compression;
+using logiq::sinks::CompressedWriter;
+
+namespace {
+
+// NDJSON lines, varied enough not to compress to nothing; bytes long.
+std::string make_body(std::size_t bytes) {
+  std::string s;
+  for (unsigned i = 0; s.size() < bytes; ++i) {
+    s += "{\"seq\":" + std::to_string(i * 2654435761u) +
+         ",\"msg\":\"GET /api/v1/items/" + std::to_string(i % 977) +
+         " 200\"}\n";
+  }
+  s.resize(bytes);
+  return s;
+}
+
+// Compress body in writes of step bytes.
+std::string encode(Compression c, int level, const std::string &body,
+                   std::size_t step) {
+  std::string out = "prefix";
+  CompressedWriter w(c, level, out);
+  for (std::size_t at = 0; at < body.size(); at += step)
+    w.write(std::string_view(body).substr(at, step));
+  w.finish();
+  CHECK(out.compare(0, 6, "prefix") == 0); // appended, not overwritten
+  return out.substr(6);
+}
+
+bool throws(Compression c, int level) {
+  try {
+    std::string out;
+    CompressedWriter(c, level, out).finish();
+  } catch (const std::runtime_error &) {
+    return true;
+  }
+  return false;
+}
+
+#ifdef LOGIQ_HAVE_ZLIB
+std::string gunzip(const std::string &in, std::size_t size) {
+  z_stream zs{};
+  inflateInit2(&zs, 15 + 16);
+  std::string out(size + 1, '\0');
+  zs.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(in.data()));
+  zs.avail_in = static_cast<uInt>(in.size());
+  zs.next_out = reinterpret_cast<Bytef *>(out.data());
+  zs.avail_out = static_cast<uInt>(out.size());
+  const int rc = inflate(&zs, Z_FINISH);
+  out.resize(zs.total_out);
+  inflateEnd(&zs);
+  return rc == Z_STREAM_END ? out : std::string("<inflate failed>");
+}
+#endif
+
+#ifdef LOGIQ_HAVE_ZSTD
+std::string unzstd(const std::string &in, std::size_t size) {
+  std::string out(size + 1, '\0');
+  const std::size_t n =
+      ZSTD_decompress(out.data(), out.size(), in.data(), in.size());
+  if (ZSTD_isError(n))
+    return "<ZSTD_decompress failed>";
+  out.resize(n);
+  return out;
+}
+#endif
+
+void test_parse() {
+  using logiq::sinks::parse_compression;
+  CHECK(parse_compression("none") == Compression::None);
+  CHECK(parse_compression("gzip") == Compression::Gzip);
+  CHECK(parse_compression("zstd") == Compression::Zstd);
+  CHECK(!parse_compression("gz"));
+  CHECK(!parse_compression(""));
+}
+
+void test_none() {
+  const auto body = make_body(100 * 1024);
+  CHECK(encode(Compression::None, 0, body, 4096) == body);
+  CHECK(logiq::sinks::compression_available(Compression::None));
+  CHECK(logiq::sinks::content_encoding(Compression::None).empty());
+}
+
+void test_gzip() {
+#ifdef LOGIQ_HAVE_ZLIB
+  CHECK(logiq::sinks::compression_available(Compression::Gzip));
+  // Larger than the output step, in uneven writes.
+  const auto body = make_body(300 * 1024 + 17);
+  for (int level : {0, 1, 6, 9}) {
+    const auto z = encode(Compression::Gzip, level, body, 7000);
+    CHECK(z.size() < body.size() / 2);
+    CHECK(gunzip(z, body.size()) == body);
+  }
+  CHECK(gunzip(encode(Compression::Gzip, 1, "", 1), 0).empty());
+  CHECK(throws(Compression::Gzip, 10));
+  CHECK(throws(Compression::Gzip, -2));
+#else
+  CHECK(!logiq::sinks::compression_available(Compression::Gzip));
+  CHECK(throws(Compression::Gzip, 0));
+#endif
+}
+
+void test_zstd() {
+#ifdef LOGIQ_HAVE_ZSTD
+  CHECK(logiq::sinks::compression_available(Compression::Zstd));
+  const auto body = make_body(300 * 1024 + 17);
+  // Negative levels are zstd's fast modes.
+  for (int level : {-5, -1, 0, 1, 3, 19}) {
+    const auto z = encode(Compression::Zstd, level, body, 7000);
+    CHECK(z.size() < body.size() / 2);
+    CHECK(unzstd(z, body.size()) == body);
+  }
+  CHECK(unzstd(encode(Compression::Zstd, 1, "", 1), 0).empty());
+#else
+  CHECK(!logiq::sinks::compression_available(Compression::Zstd));
+  CHECK(throws(Compression::Zstd, 0));
+#endif
+}
+
+// The thread's contexts are reset between bodies, across codecs and
+// level changes, so each body decodes on its own.
+void test_context_reuse() {
+  const auto a = make_body(50 * 1024);
+  const auto b = make_body(20 * 1024);
+#ifdef LOGIQ_HAVE_ZLIB
+  const auto ga = encode(Compression::Gzip, 1, a, a.size());
+  const auto gb = encode(Compression::Gzip, 9, b, 100);
+  const auto gc = encode(Compression::Gzip, 9, a, 100);
+  CHECK(gunzip(ga, a.size()) == a);
+  CHECK(gunzip(gb, b.size()) == b);
+  CHECK(gunzip(gc, a.size()) == a);
+#endif
+#ifdef LOGIQ_HAVE_ZSTD
+  const auto za = encode(Compression::Zstd, 3, a, a.size());
+  const auto zb = encode(Compression::Zstd, -3, b, 100);
+  const auto zc = encode(Compression::Zstd, -3, a, 100);
+  CHECK(unzstd(za, a.size()) == a);
+  CHECK(unzstd(zb, b.size()) == b);
+  CHECK(unzstd(zc, a.size()) == a);
+#endif
+  (void)a;
+  (void)b;
+}
+
+} // namespace
+
+int main() {
+  const std::pair<const char *, void (*)()> tests[] = {
+      {"parse", test_parse},
+      {"none", test_none},
+      {"gzip", test_gzip},
+      {"zstd", test_zstd},
+      {"context_reuse", test_context_reuse},
+  };
+  return logiq::test::run(tests);
+}
@@ -0,0 +1,339 @@
+// Where an Agent starts reading files it has checkpoints for: the files,
+// checkpoint and a recording HTTP sink on the loopback interface are set
+// up as a previous run would have left them, then the agent runs until
+// the records it should ship arrive.
+
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <initializer_list>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "TestUtil.hpp"
+#include "checkpoint/CheckpointJournal.hpp"
+#include "config/Config.hpp"
+#include "core/Agent.hpp"
+#include "utils/Logger.hpp"
+
+using logiq::checkpoint::Checkpoint;
+using logiq::file::FileFingerprint;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Answers every request with 200 and keeps the request bodies.
+class RecordingServer {
+public:
+  RecordingServer() {
+    listen_fd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    if (::bind(listen_fd_, reinterpret_cast<sockaddr *>(&addr), len) != 0 ||
+        ::listen(listen_fd_, 16) != 0 ||
+        ::getsockname(listen_fd_, reinterpret_cast<sockaddr *>(&addr),
+                      &len) != 0) {
+      std::perror("recording server");
+      std::exit(2);
+    }
+    port_ = ntohs(addr.sin_port);
+    accept_thread_ = std::thread([this] { accept_loop(); });
+  }
+
+  ~RecordingServer() {
+    stop_ = true;
+    ::shutdown(listen_fd_, SHUT_RDWR);
+    accept_thread_.join();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (int fd : fds_)
+        ::shutdown(fd, SHUT_RDWR);
+    }
+    for (auto &t : handlers_)
+      t.join();
+    for (int fd : fds_)
+      ::close(fd);
+    ::close(listen_fd_);
+  }
+
+  std::string url() const {
+    return "http://127.0.0.1:" + std::to_string(port_) + "/ingest";
+  }
+
+  // Every body received so far, in arrival order.
+  std::string bodies() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return bodies_;
+  }
+
+private:
+  void accept_loop() {
+    while (!stop_) {
+      const int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+      if (fd < 0)
+        continue;
+      std::lock_guard<std::mutex> lock(mutex_);
+      fds_.push_back(fd);
+      handlers_.emplace_back([this, fd] { serve(fd); });
+    }
+  }
+
+  void serve(int fd) {
+    std::string buf;
+    for (;;) {
+      std::size_t head_end;
+      while ((head_end = buf.find("\r\n\r\n")) == std::string::npos) {
+        if (!fill(fd, buf))
+          return;
+      }
+      std::size_t length = 0;
+      const auto cl = buf.find("Content-Length: ");
+      if (cl != std::string::npos && cl < head_end)
+        length = std::stoul(buf.substr(cl + 16));
+      while (buf.size() < head_end + 4 + length) {
+        if (!fill(fd, buf))
+          return;
+      }
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        bodies_.append(buf, head_end + 4, length);
+      }
+      buf.erase(0, head_end + 4 + length);
+      const std::string ok = "HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n";
+      if (::send(fd, ok.data(), ok.size(), MSG_NOSIGNAL) !=
+          static_cast<ssize_t>(ok.size()))
+        return;
+    }
+  }
+
+  static bool fill(int fd, std::string &buf) {
+    char tmp[16 * 1024];
+    const ssize_t n = ::recv(fd, tmp, sizeof(tmp), 0);
+    if (n <= 0)
+      return false;
+    buf.append(tmp, static_cast<std::size_t>(n));
+    return true;
+  }
+
+  int listen_fd_{-1};
+  std::uint16_t port_{0};
+  std::atomic<bool> stop_{false};
+  std::thread accept_thread_;
+  mutable std::mutex mutex_;
+  std::string bodies_;
+  std::vector<int> fds_;
+  std::vector<std::thread> handlers_;
+};
+
+// A fresh directory, removed with everything in it.
+struct ScratchDir {
+  fs::path path;
+  ScratchDir() {
+    std::string t = fs::temp_directory_path() / "file_follower_test.XXXXXX";
+    if (!::mkdtemp(t.data()))
+      throw std::runtime_error("mkdtemp failed");
+    path = t;
+  }
+  ~ScratchDir() { fs::remove_all(path); }
+  std::string file(const char *name) const { return path / name; }
+};
+
+void write_file(const std::string &path, const std::string &data) {
+  std::ofstream(path, std::ios::binary | std::ios::trunc) << data;
+}
+
+// Fingerprint of path's first bytes, as the agent takes it.
+FileFingerprint fingerprint(const std::string &path) {
+  const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  const auto fp = FileFingerprint::of(fd);
+  ::close(fd);
+  return fp;
+}
+
+// Leave a checkpoint for path's current (dev, ino) at offset, as a
+// previous run shipping it up to there would have.
+void save_checkpoint(const std::string &base, const std::string &path,
+                     std::uint64_t offset, const FileFingerprint &fp) {
+  struct stat st{};
+  CHECK(::stat(path.c_str(), &st) == 0);
+  Checkpoint cp;
+  cp.file_id = {static_cast<std::uint64_t>(st.st_dev),
+                static_cast<std::uint64_t>(st.st_ino)};
+  cp.committed_offset = offset;
+  cp.fingerprint = fp;
+  logiq::checkpoint::CheckpointJournal journal(base);
+  journal.open(0, [](const Checkpoint &, std::uint64_t, bool) {});
+  journal.append({cp}, {});
+}
+
+// Run an agent following dir/app.log until every record in want was
+// shipped (or 10 s passed); returns all that was shipped.
+std::string run_agent(const ScratchDir &dir,
+                      std::initializer_list<const char *> want) {
+  RecordingServer server;
+  logiq::config::Config config;
+  config.input.paths = {dir.file("app.log")};
+  config.input.watch_mode = "poll";
+  config.input.poll_interval_ms = 10;
+  config.checkpoint.path = dir.file("checkpoint");
+  config.output.url = server.url();
+
+  const auto shipped_all = [&] {
+    const auto body = server.bodies();
+    for (const char *record : want) {
+      if (body.find(record) == std::string::npos)
+        return false;
+    }
+    return true;
+  };
+
+  logiq::core::Agent agent(config);
+  agent.initialize();
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (!shipped_all() && std::chrono::steady_clock::now() < deadline) {
+    agent.run_once();
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  // One more pass: whatever else it would ship is there too.
+  agent.run_once();
+  agent.shutdown();
+  CHECK(shipped_all());
+  return server.bodies();
+}
+
+bool has(const std::string &body, const char *record) {
+  return body.find(record) != std::string::npos;
+}
+
+void test_resume_same_inode() {
+  ScratchDir dir;
+  const auto log = dir.file("app.log");
+  write_file(log, "line-a1\nline-a2\nline-a3\n");
+  save_checkpoint(dir.file("checkpoint"), log, 16, fingerprint(log));
+
+  const auto body = run_agent(dir, {"line-a3"});
+  CHECK(!has(body, "line-a1"));
+  CHECK(!has(body, "line-a2"));
+}
+
+void test_resume_past_eof() {
+  // Truncated below the checkpoint while the agent was down: everything
+  // in it now is new.
+  ScratchDir dir;
+  const auto log = dir.file("app.log");
+  write_file(log, "line-a1\nline-a2\nline-a3\n");
+  save_checkpoint(dir.file("checkpoint"), log, 4096, fingerprint(log));
+
+  run_agent(dir, {"line-a1", "line-a2", "line-a3"});
+}
+
+void test_rotated_sibling() {
+  // app.log was rotated to app.log.1 before its tail was shipped: the
+  // tail is drained from the checkpoint on. Siblings shipped to the end,
+  // or never shipped from, are left alone.
+  ScratchDir dir;
+  const auto base = dir.file("checkpoint");
+  write_file(dir.file("app.log.1"), "line-r1\nline-r2\nline-r3\n");
+  save_checkpoint(base, dir.file("app.log.1"), 16,
+                  fingerprint(dir.file("app.log.1")));
+  write_file(dir.file("app.log-2"), "line-s1\n");
+  save_checkpoint(base, dir.file("app.log-2"), 8,
+                  fingerprint(dir.file("app.log-2")));
+  write_file(dir.file("app.log.3"), "line-t1\n");
+  write_file(dir.file("app.log"), "line-n1\n");
+
+  const auto body = run_agent(dir, {"line-r3", "line-n1"});
+  CHECK(!has(body, "line-r1"));
+  CHECK(!has(body, "line-r2"));
+  CHECK(!has(body, "line-s1"));
+  CHECK(!has(body, "line-t1"));
+}
+
+void test_inode_reused() {
+  // The checkpoint's inode now holds another file (deleted and reused
+  // while the agent was down), even one long enough for the offset.
+  ScratchDir dir;
+  const auto log = dir.file("app.log");
+  write_file(dir.file("old"), "line-o1\nline-o2\n");
+  write_file(log, "line-a1\nline-a2\nline-a3\n");
+  save_checkpoint(dir.file("checkpoint"), log, 16,
+                  fingerprint(dir.file("old")));
+
+  run_agent(dir, {"line-a1", "line-a2", "line-a3"});
+}
+
+void test_rewritten_in_place() {
+  // Same inode, truncated and written again past the old offset: the
+  // size alone cannot tell, the first bytes do.
+  ScratchDir dir;
+  const auto log = dir.file("app.log");
+  write_file(log, "line-a1\nline-a2\n");
+  save_checkpoint(dir.file("checkpoint"), log, 16, fingerprint(log));
+  struct stat before{};
+  ::stat(log.c_str(), &before);
+  write_file(log, "line-b1\nline-b2\nline-b3\n");
+  struct stat after{};
+  ::stat(log.c_str(), &after);
+  CHECK(before.st_ino == after.st_ino);
+
+  run_agent(dir, {"line-b1", "line-b2", "line-b3"});
+}
+
+void test_rewritten_prefix_kept() {
+  // Appending keeps the fingerprint's bytes: still the same file.
+  ScratchDir dir;
+  const auto log = dir.file("app.log");
+  write_file(log, "line-a1\nline-a2\n");
+  save_checkpoint(dir.file("checkpoint"), log, 16, fingerprint(log));
+  std::ofstream(log, std::ios::binary | std::ios::app) << "line-a3\n";
+
+  const auto body = run_agent(dir, {"line-a3"});
+  CHECK(!has(body, "line-a1"));
+}
+
+void test_rotated_sibling_mismatch() {
+  // A sibling whose checkpoint inode now holds other data is not one of
+  // ours: it is not drained.
+  ScratchDir dir;
+  write_file(dir.file("old"), "line-o1\nline-o2\n");
+  write_file(dir.file("app.log.1"), "line-r1\nline-r2\nline-r3\n");
+  save_checkpoint(dir.file("checkpoint"), dir.file("app.log.1"), 8,
+                  fingerprint(dir.file("old")));
+  write_file(dir.file("app.log"), "line-n1\n");
+
+  const auto body = run_agent(dir, {"line-n1"});
+  CHECK(!has(body, "line-r"));
+}
+
+} // namespace
+
+int main() {
+  logiq::utils::Logger::init(logiq::utils::LogLevel::Warn);
+  const std::pair<const char *, void (*)()> tests[] = {
+      {"same_inode", test_resume_same_inode},
+      {"past_eof", test_resume_past_eof},
+      {"rotated_sibling", test_rotated_sibling},
+      {"inode_reused", test_inode_reused},
+      {"rewritten", test_rewritten_in_place},
+      {"appended", test_rewritten_prefix_kept},
+      {"sibling_mismatch", test_rotated_sibling_mismatch},
+  };
+  return logiq::test::run(tests);
+}
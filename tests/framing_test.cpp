@@ -0,0 +1,625 @@
+// Framers: record boundaries, offsets and limits, fed in every way a
+// reader may cut the stream.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <regex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "TestUtil.hpp"
+#include "framing/CriFramer.hpp"
+#include "framing/LengthPrefixedFramer.hpp"
+#include "framing/LineFramer.hpp"
+#include "framing/LinePattern.hpp"
+#include "framing/ParallelFramer.hpp"
+#include "framing/StreamFramer.hpp"
+
+using namespace logiq::framing;
+
+namespace {
+
+// A record's payload and file range, copied out of the framer.
+struct Rec {
+  std::string payload;
+  std::uint64_t start;
+  std::uint64_t end;
+
+  bool operator==(const Rec &) const = default;
+};
+
+std::vector<Rec> copy(const std::vector<FramedRecord> &records) {
+  std::vector<Rec> out;
+  for (const auto &r : records)
+    out.push_back({std::string(r.payload), r.start_offset, r.end_offset});
+  return out;
+}
+
+// Feed data in pieces of step bytes, draining after each.
+template <typename F>
+std::vector<Rec> frame(F &f, std::string_view data, std::size_t step) {
+  std::vector<Rec> out;
+  for (std::size_t at = 0; at < data.size(); at += step) {
+    f.ingest(data.substr(at, step), at);
+    for (auto &r : copy(f.drain()))
+      out.push_back(std::move(r));
+  }
+  return out;
+}
+
+// The records of data per limit, framed line by line in the simplest way:
+// what a framer must produce however the data is cut (the unterminated
+// tail yields only the full Split pieces it has so far).
+std::vector<Rec> reference(std::string_view data, char delim, bool strip_cr,
+                           const LineLimit &limit) {
+  const std::size_t max = limit.max_bytes ? limit.max_bytes : SIZE_MAX;
+  const bool split = limit.overflow == LineOverflow::Split;
+  std::vector<Rec> out;
+  std::size_t begin = 0;
+  while (begin < data.size()) {
+    const std::size_t nl = data.find(delim, begin);
+    std::size_t end = nl == std::string_view::npos ? data.size() : nl;
+    if (nl != std::string_view::npos && strip_cr && end > begin &&
+        data[end - 1] == '\r')
+      --end;
+    std::size_t pos = begin;
+    while (split && end - pos > max) {
+      out.push_back({std::string(data.substr(pos, max)), pos, pos + max});
+      pos += max;
+    }
+    if (nl == std::string_view::npos)
+      break;
+    out.push_back({std::string(data.substr(pos, std::min(end - pos, max))),
+                   pos, nl + 1});
+    begin = nl + 1;
+  }
+  return out;
+}
+
+// Lines of 0 to 12 bytes from a few letters and '\r', each ended by delim,
+// then an unterminated tail.
+std::string make_lines(char delim, unsigned seed) {
+  std::string s;
+  std::uint32_t x = seed * 2654435761u + 1;
+  auto next = [&] {
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return x;
+  };
+  for (int line = 0; line < 12; ++line) {
+    const std::uint32_t len = next() % 13;
+    for (std::uint32_t i = 0; i < len; ++i)
+      s.push_back("abc\r"[next() % 4]);
+    s.push_back(delim);
+  }
+  s += "tail\rxyz";
+  return s;
+}
+
+// Records cover [0, covered) with no gap or overlap, and no payload is
+// longer than the limit.
+bool well_formed(const std::vector<Rec> &recs, const LineLimit &limit) {
+  std::uint64_t at = 0;
+  for (const auto &r : recs) {
+    if (r.start != at || r.end <= r.start)
+      return false;
+    if (limit.max_bytes && r.payload.size() > limit.max_bytes)
+      return false;
+    at = r.end;
+  }
+  return true;
+}
+
+// Frame make_lines() data for every limit and every piece size, with and
+// without a ParallelFramer, and compare with reference().
+template <typename F>
+void check_against_reference(char delim, bool strip_cr) {
+  ParallelFramer parallel(3, 8);
+  int mismatches = 0;
+  for (unsigned seed = 1; seed <= 4; ++seed) {
+    const std::string data = make_lines(delim, seed);
+    for (std::size_t max : {0, 1, 2, 3, 5, 8}) {
+      for (auto overflow : {LineOverflow::Split, LineOverflow::Truncate}) {
+        const LineLimit limit{max, overflow};
+        const auto want = reference(data, delim, strip_cr, limit);
+        // A Split CRLF line whose "\r\n" straddles pieces may end in an
+        // empty piece instead (see CrlfFormat), so only its shape is
+        // checked.
+        const bool exact = !(strip_cr && overflow == LineOverflow::Split &&
+                             max > 0);
+        for (std::size_t step = 1; step <= data.size(); ++step) {
+          for (bool par : {false, true}) {
+            F f;
+            f.set_limit(limit);
+            if (par)
+              f.set_parallel(&parallel);
+            const auto got = frame(f, data, step);
+            const bool ok = exact ? got == want : well_formed(got, limit);
+            if (!ok || (max && f.buffered_bytes() > max))
+              ++mismatches;
+          }
+        }
+      }
+    }
+  }
+  CHECK(mismatches == 0);
+}
+
+void test_repeated_ingest() {
+  // Two ingests, one drain: the earlier chunk's lines stay separate and
+  // within the limit.
+  LineFramer f;
+  f.set_limit({8, LineOverflow::Truncate});
+  const std::string a = "a\nb\n0123456789abcdef\n";
+  const std::string b = "c\n";
+  f.ingest(a, 0);
+  f.ingest(b, a.size());
+  const std::vector<Rec> want = {{"a", 0, 2},
+                                 {"b", 2, 4},
+                                 {"01234567", 4, 21},
+                                 {"c", 21, 23}};
+  CHECK(copy(f.drain()) == want);
+  CHECK(f.drain().empty());
+
+  // Lines completed from the carry buffer by each of several ingests.
+  LineFramer g;
+  const std::string c = "one\ntw", d = "o\nthr", e = "ee\nfo";
+  g.ingest(c, 0);
+  g.ingest(d, 6);
+  g.ingest(e, 11);
+  const std::vector<Rec> want2 = {
+      {"one", 0, 4}, {"two", 4, 8}, {"three", 8, 14}};
+  CHECK(copy(g.drain()) == want2);
+  CHECK(g.buffered_bytes() == 2);
+  g.ingest("ur\n", 16);
+  const std::vector<Rec> want3 = {{"four", 14, 19}};
+  CHECK(copy(g.drain()) == want3);
+}
+
+void test_lf_limits() { check_against_reference<LineFramer>('\n', false); }
+
+void test_crlf_limits() {
+  check_against_reference<CrlfFramer>('\n', true);
+}
+
+void test_nul_limits() { check_against_reference<NulFramer>('\0', false); }
+
+void test_split_pieces() {
+  // A 10-byte line at max 4 arrives as 4 + 4 + 2, ranges contiguous and
+  // the last one ending after the terminator.
+  LineFramer f;
+  f.set_limit({4, LineOverflow::Split});
+  const std::vector<Rec> want = {
+      {"0123", 0, 4}, {"4567", 4, 8}, {"89", 8, 11}, {"x", 11, 13}};
+  CHECK(frame(f, "0123456789\nx\n", 3) == want);
+}
+
+void test_truncate_carry_bounded() {
+  // A writer that never ends its line: the carry buffer stays at max.
+  LineFramer f;
+  f.set_limit({16, LineOverflow::Truncate});
+  const std::string junk(1000, 'j');
+  for (std::size_t at = 0; at < 100'000; at += junk.size()) {
+    f.ingest(junk, at);
+    CHECK(f.drain().empty());
+    CHECK(f.buffered_bytes() == 16);
+  }
+  f.ingest("\n", 100'000);
+  const std::vector<Rec> want = {{std::string(16, 'j'), 0, 100'001}};
+  CHECK(copy(f.drain()) == want);
+  CHECK(f.buffered_bytes() == 0);
+}
+
+void test_crlf_across_chunks() {
+  // The '\r' of a "\r\n" is dropped whether it ends a chunk or not, and
+  // stays inside the record's range.
+  CrlfFramer f;
+  const std::vector<Rec> want = {{"ab", 0, 4}, {"c\rd", 4, 9}, {"", 9, 11}};
+  for (std::size_t step = 1; step <= 11; ++step) {
+    f.reset();
+    CHECK(frame(f, "ab\r\nc\rd\r\n\r\n", step) == want);
+  }
+
+  // Truncated with the '\r' cut off (max 2) or kept (max 3).
+  for (std::size_t max : {2, 3}) {
+    for (std::size_t step = 1; step <= 6; ++step) {
+      CrlfFramer g;
+      g.set_limit({max, LineOverflow::Truncate});
+      const std::vector<Rec> want2 = {{"abc", 0, 5}, {"d", 5, 8}};
+      auto w = want2;
+      w[0].payload.resize(std::min<std::size_t>(max, 3));
+      CHECK(frame(g, "abc\r\nd\r\n", step) == w);
+    }
+  }
+}
+
+void test_nul_records() {
+  NulFramer f;
+  const std::string data("a\0\0b\nc\0", 7);
+  const std::vector<Rec> want = {{"a", 0, 2}, {"", 2, 3}, {"b\nc", 3, 7}};
+  CHECK(frame(f, data, 2) == want);
+}
+
+void test_reset() {
+  LineFramer f;
+  f.ingest("partial", 0);
+  CHECK(f.drain().empty());
+  CHECK(f.buffered_bytes() == 7);
+  f.reset();
+  CHECK(f.buffered_bytes() == 0);
+  f.ingest("new\n", 0);
+  const std::vector<Rec> want = {{"new", 0, 4}};
+  CHECK(copy(f.drain()) == want);
+}
+
+bool pattern_throws(std::string_view p) {
+  try {
+    LinePattern pat(p);
+  } catch (const std::invalid_argument &) {
+    return true;
+  }
+  return false;
+}
+
+void test_pattern_cases() {
+  const LinePattern date("^\\d{4}-\\d{2}-\\d{2} ");
+  CHECK(date.matches("2024-01-31 12:00:00 INFO up"));
+  CHECK(!date.matches("  at 2024-01-31 "));  // anchored at the start
+  CHECK(!date.matches("2024-1-31 "));
+  CHECK(!date.matches("2024-01-31"));
+
+  const LinePattern level("(ERROR|WARN|INFO) ");
+  CHECK(level.matches("WARN disk low"));
+  CHECK(level.matches("ERROR x"));
+  CHECK(!level.matches("DEBUG x"));
+  CHECK(!level.matches("WARNING x"));
+
+  const LinePattern cont("[^ \\t]");  // not an indented continuation
+  CHECK(cont.matches("Exception in thread"));
+  CHECK(!cont.matches("\tat Foo.bar(Foo.java:1)"));
+  CHECK(!cont.matches(" at x"));
+  CHECK(!cont.matches(""));
+
+  const LinePattern whole("a+b?$");  // '$' anchors the end
+  CHECK(whole.matches("aaab"));
+  CHECK(whole.matches("a"));
+  CHECK(!whole.matches("aaabb"));
+  CHECK(!whole.matches("b"));
+
+  const LinePattern esc("\\[\\x41\\]\\.\\*\\w\\W\\s\\S\\D");
+  CHECK(esc.matches("[A].*_- xx"));
+  CHECK(!esc.matches("[B].*_- xx"));
+
+  const LinePattern empty("");  // matches every line
+  CHECK(empty.matches(""));
+  CHECK(empty.matches("anything"));
+
+  // Backtracking engines blow up on this one; ours is linear.
+  const LinePattern nested("(a?){24}a{24}$");
+  CHECK(nested.matches(std::string(24, 'a')));
+  CHECK(!nested.matches(std::string(23, 'a') + "b"));
+
+  for (const char *bad : {"(ab", "a)", "[ab", "*a", "a|*", "a{", "a{3,1}",
+                          "\\", "a{2000}"})
+    CHECK(pattern_throws(bad));
+}
+
+void test_pattern_max_positions() {
+  // One position per literal plus the start state.
+  const std::size_t max = LinePattern::kMaxPositions;
+  CHECK(!pattern_throws(std::string(max - 1, 'a')));
+  CHECK(pattern_throws(std::string(max, 'a')));
+  CHECK(!pattern_throws("a{" + std::to_string(max - 1) + "}"));
+  CHECK(pattern_throws("a{" + std::to_string(max) + "}"));
+  CHECK(pattern_throws("(ab){" + std::to_string(max / 2) + "}"));
+  CHECK(pattern_throws("x{" + std::to_string(max + 1) + "}"));
+
+  // The largest pattern still matches across all of its state words.
+  const LinePattern big(std::string(max - 2, 'a') + "b");
+  CHECK(big.matches(std::string(max - 2, 'a') + "b!"));
+  CHECK(!big.matches(std::string(max - 2, 'a') + "a"));
+  CHECK(!big.matches(std::string(max - 3, 'a') + "b"));
+}
+
+void test_pattern_vs_std_regex() {
+  // Anchored at the start like LinePattern; no '\r' or '\n' in lines, where
+  // ECMAScript's '.' differs.
+  const char *patterns[] = {
+      "a*b",       "(ab|a)(c|bcd)$", "[^ ]+ at", "\\s+at ",   "x?y{2,3}z$",
+      "(a|b)*abb$", "[a-c]+$",       ".{3}",     "\\d+:\\d*", "(x|y|)z",
+      "[A-Z]\\w*:", "a{2,}b",        "((ab)?c)+$"};
+  const std::string alphabet = "abcxyzA09 :";
+  std::uint32_t x = 12345;
+  auto next = [&] {
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return x;
+  };
+  int mismatches = 0;
+  for (const char *p : patterns) {
+    const LinePattern pat(p);
+    const std::regex re(std::string("(?:") + p + ")");
+    for (int i = 0; i < 3000; ++i) {
+      std::string line;
+      for (std::uint32_t n = next() % 10; n > 0; --n)
+        line.push_back(alphabet[next() % alphabet.size()]);
+      const bool want = std::regex_search(
+          line, re, std::regex_constants::match_continuous);
+      if (pat.matches(line) != want) {
+        std::fprintf(stderr, "'%s' on '%s': want %d\n", p, line.c_str(),
+                     want);
+        ++mismatches;
+      }
+    }
+  }
+  CHECK(mismatches == 0);
+}
+
+// Everything a StreamFramer emits for data fed in pieces of step bytes,
+// including the open record flushed at the end.
+std::vector<Rec> group(std::string_view data, const LinePattern *start,
+                       std::size_t step, const LineLimit &limit = {}) {
+  StreamFramer f;
+  f.set_multiline(start, std::chrono::milliseconds(1000));
+  f.set_limit(limit);
+  auto out = frame(f, data, step);
+  for (auto &r : copy(f.flush_expired(StreamFramer::Clock::now(), true)))
+    out.push_back(std::move(r));
+  CHECK(!f.pending());
+  return out;
+}
+
+void test_multiline_grouping() {
+  const LinePattern start("\\S");
+  const std::string data = "Exception: boom\n"
+                           "\tat A.a(A.java:1)\n"
+                           "\tat B.b(B.java:2)\n"
+                           "INFO next\n"
+                           "ERROR last\n"
+                           "  cause\n";
+  const std::vector<Rec> want = {
+      {"Exception: boom\n\tat A.a(A.java:1)\n\tat B.b(B.java:2)", 0, 52},
+      {"INFO next", 52, 62},
+      {"ERROR last\n  cause", 62, 81}};
+  // Whole, and cut at every possible place.
+  for (std::size_t step = 1; step <= data.size(); ++step)
+    CHECK(group(data, &start, step) == want);
+
+  // A group held across a drain is copied; within one chunk it is a view
+  // into the data.
+  StreamFramer f;
+  f.set_multiline(&start, std::chrono::milliseconds(1000));
+  f.ingest(data, 0);
+  const auto &recs = f.drain();
+  CHECK(recs.size() == 2);
+  CHECK(recs[0].payload.data() == data.data());
+  CHECK(f.pending());
+  CHECK(f.buffered_bytes() == 18);
+
+  // Without a pattern every line is a record.
+  CHECK(group(data, nullptr, 7).size() == 6);
+}
+
+void test_multiline_limit() {
+  // A group that would grow past max_bytes is shipped before the line that
+  // does not fit, which opens the next one.
+  const LinePattern start("\\S");
+  const std::vector<Rec> want = {
+      {"head\n 1\n 2", 0, 11}, {" 3\n 4", 11, 17}, {"x", 17, 19}};
+  for (std::size_t step = 1; step <= 19; ++step)
+    CHECK(group("head\n 1\n 2\n 3\n 4\nx\n", &start, step,
+                {10, LineOverflow::Split}) == want);
+}
+
+void test_multiline_flush_timeout() {
+  // The writer stops mid-group: nothing is shipped until flush_timeout
+  // passes without a line, then the open group goes out whole.
+  using Clock = StreamFramer::Clock;
+  const LinePattern start("\\S");
+  StreamFramer f;
+  f.set_multiline(&start, std::chrono::milliseconds(500));
+  f.ingest("first\n  more\n", 0);
+  CHECK(f.drain().empty());
+  CHECK(f.pending());
+  CHECK(f.flush_expired(Clock::now()).empty());
+  CHECK(f.pending());
+
+  f.ingest("  and more\n", 13);
+  CHECK(f.drain().empty());
+  const auto later = Clock::now() + std::chrono::milliseconds(600);
+  const std::vector<Rec> want = {{"first\n  more\n  and more", 0, 24}};
+  CHECK(copy(f.flush_expired(later)) == want);
+  CHECK(!f.pending());
+  CHECK(f.flush_expired(later).empty());
+
+  // After a flush the next line starts afresh, even a continuation.
+  f.ingest("  orphan\nnext\n", 24);
+  const std::vector<Rec> want2 = {{"  orphan", 24, 33}};
+  CHECK(copy(f.drain()) == want2);
+}
+
+// payload with its 4-byte big-endian length header.
+std::string prefixed(std::string_view payload) {
+  const auto n = static_cast<std::uint32_t>(payload.size());
+  std::string out;
+  out.push_back(static_cast<char>(n >> 24));
+  out.push_back(static_cast<char>(n >> 16));
+  out.push_back(static_cast<char>(n >> 8));
+  out.push_back(static_cast<char>(n));
+  out.append(payload);
+  return out;
+}
+
+void test_length_prefixed() {
+  const std::string data = prefixed("hello") + prefixed("") +
+                           prefixed(std::string(300, 'x')) + prefixed("z");
+  const std::vector<Rec> want = {{"hello", 0, 9},
+                                 {"", 9, 13},
+                                 {std::string(300, 'x'), 13, 317},
+                                 {"z", 317, 322}};
+  for (std::size_t step = 1; step <= data.size(); ++step) {
+    LengthPrefixedFramer f;
+    CHECK(frame(f, data, step) == want);
+  }
+
+  // Split pieces: the first one's range includes the header.
+  const std::vector<Rec> split = {
+      {"0123", 0, 8}, {"4567", 8, 12}, {"89", 12, 14}, {"z", 14, 19}};
+  // Truncate keeps the head; the range still covers the whole record.
+  const std::vector<Rec> cut = {{"0123", 0, 14}, {"z", 14, 19}};
+  const std::string long_one = prefixed("0123456789") + prefixed("z");
+  for (std::size_t step = 1; step <= long_one.size(); ++step) {
+    LengthPrefixedFramer f;
+    f.set_limit({4, LineOverflow::Split});
+    CHECK(frame(f, long_one, step) == split);
+    LengthPrefixedFramer g;
+    g.set_limit({4, LineOverflow::Truncate});
+    CHECK(frame(g, long_one, step) == cut);
+  }
+}
+
+void test_length_prefixed_bounded() {
+  // A corrupt length (4 GiB) cannot make the framer buffer more than the
+  // limit.
+  LengthPrefixedFramer f;
+  f.set_limit({64, LineOverflow::Truncate});
+  const std::string junk(1000, 'j');
+  f.ingest("\xff\xff\xff\xff", 0);
+  for (std::uint64_t at = 4; at < 100'004; at += junk.size()) {
+    f.ingest(junk, at);
+    CHECK(f.drain().empty());
+    CHECK(f.buffered_bytes() <= 64);
+  }
+}
+
+void test_length_prefixed_many_owned() {
+  // Hundreds of records reassembled across chunks before one drain(): the
+  // copies they view must all stay put (short ones live inside their
+  // std::string and would move with a reallocating container).
+  std::string data;
+  std::vector<Rec> want;
+  for (int i = 0; i < 500; ++i) {
+    const std::string payload = std::string("r").append(std::to_string(i));
+    want.push_back({payload, data.size(), data.size() + 4 + payload.size()});
+    data += prefixed(payload);
+  }
+  LengthPrefixedFramer f;
+  for (std::size_t at = 0; at < data.size(); at += 3)
+    f.ingest(std::string_view(data).substr(at, 3), at);
+  CHECK(copy(f.drain()) == want);
+  CHECK(f.drain().empty());
+}
+
+void test_cri() {
+  const std::string t = "2024-05-01T10:00:00.000000001Z";
+  const std::string l1 = t + " stdout F single\n", l2 = t + " stdout P par\n",
+                    l3 = t + " stderr P ti\n", l4 = t + " stdout F:x al\n",
+                    l5 = "not a cri line\n", l6 = t + " stdout F \n";
+  const std::string data = l1 + l2 + l3 + l4 + l5 + l6;
+  // P lines join up to their F line; time and stream are dropped, a line
+  // that does not parse passes through whole.
+  const std::uint64_t e1 = l1.size();
+  const std::uint64_t e4 = e1 + l2.size() + l3.size() + l4.size();
+  const std::uint64_t e5 = e4 + l5.size();
+  const std::vector<Rec> want = {{"single", 0, e1},
+                                 {"partial", e1, e4},
+                                 {"not a cri line", e4, e5},
+                                 {"", e5, data.size()}};
+  for (std::size_t step = 1; step <= data.size(); ++step) {
+    CriFramer f;
+    CHECK(frame(f, data, step) == want);
+  }
+}
+
+void test_cri_open_record() {
+  // A partial record stays open across drains, and a line that does not
+  // parse ships it before passing through itself.
+  CriFramer f;
+  const std::string a = "t stdout P ab\n", b = "t stdout P cd\n",
+                    c = "garbage\n";
+  f.ingest(a, 0);
+  CHECK(f.drain().empty());
+  CHECK(f.buffered_bytes() == 2);
+  f.ingest(b, a.size());
+  CHECK(f.drain().empty());
+  f.ingest(c, a.size() + b.size());
+  const std::vector<Rec> want = {{"abcd", 0, 28}, {"garbage", 28, 36}};
+  CHECK(copy(f.drain()) == want);
+
+  // reset() drops a record still waiting for its F line.
+  f.ingest(a, 0);
+  CHECK(f.drain().empty());
+  f.reset();
+  CHECK(f.buffered_bytes() == 0);
+  f.ingest("t stdout F x\n", 0);
+  const std::vector<Rec> want2 = {{"x", 0, 13}};
+  CHECK(copy(f.drain()) == want2);
+}
+
+void test_cri_limits() {
+  // Lines fit the limit (it applies to them too); their join does not.
+  const std::string data = "t s P abcd\n"
+                           "t s P efgh\n"
+                           "t s F ijk\n";
+  // Split cuts joined records at line boundaries.
+  const std::vector<Rec> split = {{"abcdefgh", 0, 22}, {"ijk", 22, 32}};
+  // Truncate drops the tail; the range still covers every line.
+  const std::vector<Rec> cut = {{"abcdefghij", 0, 32}};
+  for (std::size_t step = 1; step <= data.size(); ++step) {
+    CriFramer f;
+    f.set_limit({10, LineOverflow::Split});
+    CHECK(frame(f, data, step) == split);
+    CriFramer g;
+    g.set_limit({10, LineOverflow::Truncate});
+    CHECK(frame(g, data, step) == cut);
+  }
+
+  // Many joined records in one drain keep their own bytes.
+  std::string many;
+  std::vector<Rec> want;
+  for (int i = 0; i < 300; ++i) {
+    const std::string p = "t stdout P " + std::to_string(i) + "\n";
+    const std::string e = "t stdout F .\n";
+    want.push_back({std::to_string(i) + ".", many.size(),
+                    many.size() + p.size() + e.size()});
+    many += p + e;
+  }
+  CriFramer h;
+  h.ingest(many, 0);
+  CHECK(copy(h.drain()) == want);
+}
+
+} // namespace
+
+int main() {
+  const std::pair<const char *, void (*)()> tests[] = {
+      {"lf_limits", test_lf_limits},
+      {"crlf_limits", test_crlf_limits},
+      {"nul_limits", test_nul_limits},
+      {"split_pieces", test_split_pieces},
+      {"truncate_carry", test_truncate_carry_bounded},
+      {"crlf_chunks", test_crlf_across_chunks},
+      {"nul_records", test_nul_records},
+      {"reset", test_reset},
+      {"repeated_ingest", test_repeated_ingest},
+      {"length_prefixed", test_length_prefixed},
+      {"length_bounded", test_length_prefixed_bounded},
+      {"length_many_owned", test_length_prefixed_many_owned},
+      {"cri", test_cri},
+      {"cri_open_record", test_cri_open_record},
+      {"cri_limits", test_cri_limits},
+      {"pattern_cases", test_pattern_cases},
+      {"pattern_max_pos", test_pattern_max_positions},
+      {"pattern_vs_regex", test_pattern_vs_std_regex},
+      {"multiline_group", test_multiline_grouping},
+      {"multiline_limit", test_multiline_limit},
+      {"multiline_flush", test_multiline_flush_timeout},
+  };
+  return logiq::test::run(tests);
+}
@@ -0,0 +1,80 @@
+// Scheduler: every index of every job runs exactly once, across many
+// back-to-back jobs of uneven tasks (threads still stealing at the end of
+// one job must not disturb the next).
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "TestUtil.hpp"
+#include "core/Scheduler.hpp"
+
+using logiq::core::Scheduler;
+
+namespace {
+
+// Runs jobs of sizes cycling through sizes on threads threads; checks
+// that each index ran once per job.
+void stress(std::size_t threads, int jobs,
+            std::initializer_list<std::size_t> sizes) {
+  Scheduler s(threads);
+  std::vector<std::atomic<int>> runs(1024);
+  int bad_jobs = 0;
+  for (int j = 0; j < jobs; ++j) {
+    const std::size_t n = sizes.begin()[j % sizes.size()];
+    for (std::size_t i = 0; i < n; ++i)
+      runs[i].store(0, std::memory_order_relaxed);
+    s.run(n, [&](std::size_t i) {
+      runs[i].fetch_add(1);
+      // Uneven tasks keep thieves busy right up to the end of the job.
+      if (i % 7 == 0)
+        std::this_thread::yield();
+    });
+    for (std::size_t i = 0; i < n; ++i) {
+      if (runs[i].load() != 1) {
+        ++bad_jobs;
+        break;
+      }
+    }
+  }
+  CHECK(bad_jobs == 0);
+}
+
+void test_single_thread() {
+  Scheduler s(1);
+  CHECK(s.threads() == 1);
+  std::vector<int> runs(10);
+  s.run(10, [&](std::size_t i) { ++runs[i]; });
+  for (int r : runs)
+    CHECK(r == 1);
+  s.run(0, [&](std::size_t) { CHECK(false); });
+}
+
+void test_back_to_back_jobs() { stress(8, 20000, {16, 3, 100, 9, 1, 2}); }
+
+void test_more_threads_than_tasks() { stress(16, 5000, {2, 5, 15, 17}); }
+
+void test_large_jobs() { stress(4, 500, {1000, 999, 64}); }
+
+} // namespace
+
+int main() {
+  // A lost task leaves run() waiting forever; fail instead of hanging.
+  std::thread([] {
+    std::this_thread::sleep_for(std::chrono::seconds(120));
+    std::fprintf(stderr, "scheduler_test: timed out (a job never ended)\n");
+    std::_Exit(1);
+  }).detach();
+
+  const std::pair<const char *, void (*)()> tests[] = {
+      {"single_thread", test_single_thread},
+      {"back_to_back_jobs", test_back_to_back_jobs},
+      {"more_threads", test_more_threads_than_tasks},
+      {"large_jobs", test_large_jobs},
+  };
+  return logiq::test::run(tests);
+}
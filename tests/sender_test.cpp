@@ -0,0 +1,318 @@
+// HttpSender against a stand-in HTTP/1.1 server on the loopback interface.
+//
+// The server answers by request path:
+//   /ok       200 with Content-Length, keep-alive
+//   /chunked  100 Continue, then a chunked 200 with a trailer
+//   /500      500 with a body, keep-alive
+//   /once     answers the first request on a connection and closes the
+//             connection on the next one without a reply (an idle close
+//             racing the client's reuse)
+//   /drop     200, then closes the connection shortly after
+//   /slow     never answers
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "TestUtil.hpp"
+#include "sender/HttpSender.hpp"
+
+using logiq::sender::Endpoint;
+using logiq::sender::HttpSender;
+
+namespace {
+
+class StandInServer {
+public:
+  StandInServer() {
+    listen_fd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    if (::bind(listen_fd_, reinterpret_cast<sockaddr *>(&addr), len) != 0 ||
+        ::listen(listen_fd_, 16) != 0 ||
+        ::getsockname(listen_fd_, reinterpret_cast<sockaddr *>(&addr),
+                      &len) != 0) {
+      std::perror("stand-in server");
+      std::exit(2);
+    }
+    port_ = ntohs(addr.sin_port);
+    accept_thread_ = std::thread([this] { accept_loop(); });
+  }
+
+  ~StandInServer() {
+    stop_ = true;
+    ::shutdown(listen_fd_, SHUT_RDWR);
+    accept_thread_.join();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (int fd : fds_)
+        ::shutdown(fd, SHUT_RDWR);
+    }
+    for (auto &t : handlers_)
+      t.join();
+    for (int fd : fds_)
+      ::close(fd);
+    ::close(listen_fd_);
+  }
+
+  std::string url(const std::string &path) const {
+    return "http://127.0.0.1:" + std::to_string(port_) + path;
+  }
+
+  int connections() const { return connections_.load(); }
+  int requests() const { return requests_.load(); }
+
+private:
+  void accept_loop() {
+    while (!stop_) {
+      const int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+      if (fd < 0)
+        continue;
+      ++connections_;
+      std::lock_guard<std::mutex> lock(mutex_);
+      fds_.push_back(fd);
+      handlers_.emplace_back([this, fd] { serve(fd); });
+    }
+  }
+
+  // One connection: read requests and answer them until either side
+  // closes it.
+  void serve(int fd) {
+    std::string buf;
+    int served = 0;
+    for (;;) {
+      std::string path;
+      if (!read_request(fd, buf, path))
+        break;
+      ++requests_;
+      if (!answer(fd, path, served++))
+        break;
+    }
+    ::shutdown(fd, SHUT_RDWR);
+  }
+
+  static bool read_request(int fd, std::string &buf, std::string &path) {
+    std::size_t head_end;
+    while ((head_end = buf.find("\r\n\r\n")) == std::string::npos) {
+      if (!fill(fd, buf))
+        return false;
+    }
+    const auto sp = buf.find(' ');
+    path = buf.substr(sp + 1, buf.find(' ', sp + 1) - sp - 1);
+    std::size_t length = 0;
+    const auto cl = buf.find("Content-Length: ");
+    if (cl != std::string::npos && cl < head_end)
+      length = std::stoul(buf.substr(cl + 16));
+    while (buf.size() < head_end + 4 + length) {
+      if (!fill(fd, buf))
+        return false;
+    }
+    buf.erase(0, head_end + 4 + length);
+    return true;
+  }
+
+  static bool fill(int fd, std::string &buf) {
+    char tmp[16 * 1024];
+    const ssize_t n = ::recv(fd, tmp, sizeof(tmp), 0);
+    if (n <= 0)
+      return false;
+    buf.append(tmp, static_cast<std::size_t>(n));
+    return true;
+  }
+
+  static bool reply(int fd, const std::string &s) {
+    return ::send(fd, s.data(), s.size(), MSG_NOSIGNAL) ==
+           static_cast<ssize_t>(s.size());
+  }
+
+  // False to close the connection.
+  static bool answer(int fd, const std::string &path, int served) {
+    if (path == "/ok")
+      return reply(fd, "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok");
+    if (path == "/chunked")
+      return reply(fd, "HTTP/1.1 100 Continue\r\n\r\n"
+                       "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n"
+                       "3;x=y\r\nabc\r\n2\r\nde\r\n0\r\nX-T: 1\r\n\r\n");
+    if (path == "/500")
+      return reply(fd, "HTTP/1.1 500 Internal\r\nContent-Length: 4\r\n\r\n"
+                       "boom");
+    if (path == "/once")
+      return served == 0 &&
+             reply(fd, "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok");
+    if (path == "/drop") {
+      reply(fd, "HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n");
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      return false;
+    }
+    if (path == "/slow") {
+      // Hold the connection until the client gives up on it.
+      char c;
+      while (::recv(fd, &c, 1, 0) > 0) {
+      }
+      return false;
+    }
+    return reply(fd, "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n");
+  }
+
+  int listen_fd_{-1};
+  std::uint16_t port_{0};
+  std::atomic<bool> stop_{false};
+  std::atomic<int> connections_{0};
+  std::atomic<int> requests_{0};
+  std::thread accept_thread_;
+  std::mutex mutex_;
+  std::vector<int> fds_;
+  std::vector<std::thread> handlers_;
+};
+
+logiq::sender::Response post(HttpSender &s) {
+  return s.post("application/x-ndjson", "", "{\"msg\":\"hello\"}\n");
+}
+
+void test_endpoint_parse() {
+  const auto a = Endpoint::parse("http://logs.example:8080/v1/ingest?x=1");
+  CHECK(a.host == "logs.example");
+  CHECK(a.port == 8080);
+  CHECK(a.path == "/v1/ingest?x=1");
+  CHECK(a.authority() == "logs.example:8080");
+
+  const auto b = Endpoint::parse("http://[::1]?q");
+  CHECK(b.host == "::1");
+  CHECK(b.port == 80);
+  CHECK(b.path == "/?q");
+  CHECK(b.authority() == "[::1]");
+
+  bool threw = false;
+  try {
+    Endpoint::parse("https://logs.example/");
+  } catch (const std::runtime_error &) {
+    threw = true;
+  }
+  CHECK(threw);
+}
+
+void test_keep_alive_reuse() {
+  StandInServer srv;
+  HttpSender s(Endpoint::parse(srv.url("/ok")), {});
+  for (int i = 0; i < 5; ++i) {
+    const auto r = post(s);
+    CHECK(r.ok);
+    CHECK(r.status == 200);
+    CHECK(r.message == "ok");
+  }
+  CHECK(srv.connections() == 1);
+  CHECK(srv.requests() == 5);
+  CHECK(s.idle() == 1);
+  CHECK(s.in_flight() == 0);
+}
+
+void test_chunked_response() {
+  StandInServer srv;
+  HttpSender s(Endpoint::parse(srv.url("/chunked")), {});
+  for (int i = 0; i < 2; ++i) {
+    const auto r = post(s);
+    CHECK(r.ok);
+    CHECK(r.status == 200);
+    CHECK(r.message == "abcde");
+  }
+  CHECK(srv.connections() == 1);
+}
+
+void test_idle_close_retry() {
+  StandInServer srv;
+  HttpSender s(Endpoint::parse(srv.url("/once")), {});
+  CHECK(post(s).ok);
+  // The pooled connection looks alive, but the server closes it on the
+  // next request: that request is retried once on a new connection.
+  const auto r = post(s);
+  CHECK(r.ok);
+  CHECK(r.status == 200);
+  CHECK(srv.connections() == 2);
+  CHECK(srv.requests() == 3);
+}
+
+void test_closed_while_idle() {
+  StandInServer srv;
+  HttpSender s(Endpoint::parse(srv.url("/drop")), {});
+  CHECK(post(s).ok);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  // Seen closed before use: a new connection, no wasted request.
+  CHECK(post(s).ok);
+  CHECK(srv.connections() == 2);
+  CHECK(srv.requests() == 2);
+}
+
+void test_non_2xx() {
+  StandInServer srv;
+  HttpSender s(Endpoint::parse(srv.url("/500")), {});
+  for (int i = 0; i < 2; ++i) {
+    const auto r = post(s);
+    CHECK(r.ok); // a complete response, whatever its status
+    CHECK(r.status == 500);
+    CHECK(r.message == "boom");
+  }
+  CHECK(srv.connections() == 1);
+}
+
+void test_timeout() {
+  StandInServer srv;
+  HttpSender::Options opt;
+  opt.timeout_ms = 200;
+  HttpSender s(Endpoint::parse(srv.url("/slow")), opt);
+  const auto start = std::chrono::steady_clock::now();
+  const auto r = post(s);
+  const auto took = std::chrono::steady_clock::now() - start;
+  CHECK(!r.ok);
+  CHECK(r.message.find("timed out") != std::string::npos);
+  CHECK(took >= std::chrono::milliseconds(150));
+  CHECK(took < std::chrono::seconds(2));
+  CHECK(s.idle() == 0); // a connection in an unknown state is not reused
+}
+
+void test_connect_refused() {
+  // A bound port nobody listens on.
+  const int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t len = sizeof(addr);
+  ::bind(fd, reinterpret_cast<sockaddr *>(&addr), len);
+  ::getsockname(fd, reinterpret_cast<sockaddr *>(&addr), &len);
+
+  HttpSender s(Endpoint::parse("http://127.0.0.1:" +
+                               std::to_string(ntohs(addr.sin_port)) + "/"),
+               {});
+  const auto r = post(s);
+  CHECK(!r.ok);
+  CHECK(r.message.find("connect failed") != std::string::npos);
+  ::close(fd);
+}
+
+} // namespace
+
+int main() {
+  const std::pair<const char *, void (*)()> tests[] = {
+      {"endpoint_parse", test_endpoint_parse},
+      {"keep_alive_reuse", test_keep_alive_reuse},
+      {"chunked_response", test_chunked_response},
+      {"idle_close_retry", test_idle_close_retry},
+      {"closed_while_idle", test_closed_while_idle},
+      {"non_2xx", test_non_2xx},
+      {"timeout", test_timeout},
+      {"connect_refused", test_connect_refused},
+  };
+  return logiq::test::run(tests);
+}